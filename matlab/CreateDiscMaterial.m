@@ -51,7 +51,15 @@ if (exist(filename,'file'))
     error(['file "' filename '" already exist. Delete/rename first!']);
 end
 
-h5create(filename, '/DiscData',data_size, 'Datatype', 'uint8', 'ChunkSize',data_size, 'Deflate',9);
+% a material database of more than 256 entries needs a 16 bit index
+index_type = 'uint8';
+if (numel(mat_db.epsR)>256)
+    index_type = 'uint16';
+end
+
+% bounded chunks, a region of interest only reads and decompresses the chunks it touches
+chunk_size = min(data_size, 64);
+h5create(filename, '/DiscData',data_size, 'Datatype', index_type, 'ChunkSize',chunk_size, 'Deflate',9);
 h5write(filename, '/DiscData', data);
 
 clear data;
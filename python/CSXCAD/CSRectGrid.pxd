@@ -17,6 +17,7 @@
 #
 
 from libcpp.string cimport string
+from libcpp.vector cimport vector
 from libcpp cimport bool
 from CSXCAD.CSObject cimport _CSObject
 
@@ -26,6 +27,22 @@ cdef extern from "CSXCAD/CSXCAD_Global.h":
         CYLINDRICAL  "CYLINDRICAL"
         UNDEFINED_CS "UNDEFINED_CS"
 
+cdef extern from "CSXCAD/CSRectGrid.h":
+        cdef cppclass _MeshQuality "CSRectGrid::MeshQuality":
+            size_t numLines
+            double min_res
+            size_t min_res_idx
+            double max_res
+            size_t max_res_idx
+            double max_ratio
+            size_t max_ratio_idx
+            bool homogeneous
+            int symmetric
+            vector[double] res_bins
+            vector[unsigned int] res_hist
+            vector[double] ratio_bins
+            vector[unsigned int] ratio_hist
+
 cdef extern from "CSXCAD/CSRectGrid.h":
         cdef cppclass _CSRectGrid "CSRectGrid"(_CSObject):
             _CSRectGrid() except +
@@ -52,6 +69,17 @@ cdef extern from "CSXCAD/CSRectGrid.h":
             double* GetSimArea()
             bool isValid()
 
+            bool SmoothMeshLines(int direct, double max_res, double ratio, bool check_symmetry)
+
+            bool AnalyseMesh(int direct, _MeshQuality &quality, unsigned int numBins)
+            double GetCFLTimestep()
+
+cdef extern from "CSXCAD/CSRectGrid.h":
+        vector[double] _SmoothMeshLines "CSRectGrid::SmoothMeshLines"(const vector[double]& lines, double max_res, double ratio, bool check_symmetry)
+        vector[double] _SmoothRange "CSRectGrid::SmoothRange"(double start, double stop, double start_res, double stop_res, double max_res, double ratio)
+        int _CheckSymmetry "CSRectGrid::CheckSymmetry"(const vector[double]& lines)
+        bool _AnalyseMesh "CSRectGrid::AnalyseMesh"(const vector[double]& lines, _MeshQuality &quality, unsigned int numBins)
+
 cdef class CSRectGrid:
     cdef _CSRectGrid *thisptr
     cdef object __weakref__
@@ -24,7 +24,6 @@ Rectilinear Grid Class for CSXCAD
 import numpy as np
 cimport CSXCAD.CSRectGrid
 from CSXCAD.Utilities import CheckNyDir
-from CSXCAD.SmoothMeshLines import SmoothMeshLines
 from libc.stdint cimport uintptr_t
 import weakref
 from CSXCAD.CSObject cimport CSDestructionCallback, wrapper_destroyed
@@ -207,14 +206,39 @@ cdef class CSRectGrid:
         :param ratio:   float -- max. allowed ration of mesh smoothing de/increase
         :param check_symmetry: bool -- detect a symmetric mesh and smooth only one
             half (default True); set False to disable and smooth the full line set
+        :returns: bool -- False if a cell is still larger than max_res
         """
         if ny=='all':
+            ok = True
             for n in range(3):
-                self.SmoothMeshLines(n, max_res, ratio, check_symmetry)
-        else:
-            lines = self.GetLines(ny)
-            lines = SmoothMeshLines(lines, max_res, ratio, check_symmetry=check_symmetry)
-            self.SetLines(ny, lines)
+                ok = self.SmoothMeshLines(n, max_res, ratio, check_symmetry) and ok
+            return ok
+        ny = CheckNyDir(ny)
+        assert max_res>0 and ratio>1, 'SmoothMeshLines: "max_res" must be positive and "ratio" larger than one'
+        return self._ptr().SmoothMeshLines(ny, max_res, ratio, check_symmetry)
+
+    def AnalyseMesh(self, ny, numBins=10):
+        """ AnalyseMesh(ny, numBins=10)
+
+        Analyse the mesh lines in the given direction, see CSXCAD.CSRectGrid.AnalyseMesh
+
+        :param ny: int or str -- direction definition
+        :param numBins: int -- number of histogram bins
+        :returns: dict or None -- mesh quality figures, None for less than two lines
+        """
+        ny = CheckNyDir(ny)
+        cdef _MeshQuality q
+        if not self._ptr().AnalyseMesh(ny, q, numBins):
+            return None
+        return _MeshQuality2Dict(q)
+
+    def GetCFLTimestep(self):
+        """
+        Estimate the max. stable FDTD time step (CFL criterion) in seconds, using the drawing unit.
+
+        :returns: float -- time step, 0 if no direction has any cell
+        """
+        return self._ptr().GetCFLTimestep()
 
     def Clear(self):
         """
@@ -277,3 +301,56 @@ cdef class CSRectGrid:
         return self._ptr().isValid()
 
 RegisterWrapperFactory(GRID, CSRectGrid._from_address)
+
+def SmoothMeshLines(lines, max_res, ratio=1.5, check_symmetry=True):
+    """ SmoothMeshLines(lines, max_res, ratio=1.5, check_symmetry=True)
+
+    Smooth the given mesh lines, see CSXCAD.SmoothMeshLines.SmoothMeshLines
+    """
+    assert max_res>0 and ratio>1, 'SmoothMeshLines: "max_res" must be positive and "ratio" larger than one'
+    return np.array(_SmoothMeshLines(np.asarray(lines, dtype=float).ravel(), max_res, ratio, check_symmetry))
+
+def SmoothRange(start, stop, start_res, stop_res, max_res, ratio):
+    """ SmoothRange(start, stop, start_res, stop_res, max_res, ratio)
+
+    Internal function, do not use.
+    """
+    assert ratio>1 and start_res>0 and stop_res>0 and max_res>0
+    return np.array(_SmoothRange(start, stop, start_res, stop_res, max_res, ratio))
+
+def CheckSymmetry(lines):
+    """ CheckSymmetry(lines)
+
+    Check the sorted lines for symmetry, 0 if not symmetric, 1 for an odd and
+    2 for an even number of symmetric lines.
+    """
+    return _CheckSymmetry(np.asarray(lines, dtype=float).ravel())
+
+cdef _MeshQuality2Dict(_MeshQuality &q):
+    return {'numLines': q.numLines,
+            'min_res': q.min_res, 'min_res_idx': q.min_res_idx,
+            'max_res': q.max_res, 'max_res_idx': q.max_res_idx,
+            'max_ratio': q.max_ratio, 'max_ratio_idx': q.max_ratio_idx,
+            'homogeneous': q.homogeneous, 'symmetric': q.symmetric,
+            'res_bins': np.array(q.res_bins), 'res_hist': np.array(q.res_hist),
+            'ratio_bins': np.array(q.ratio_bins), 'ratio_hist': np.array(q.ratio_hist)}
+
+def AnalyseMesh(lines, numBins=10):
+    """ AnalyseMesh(lines, numBins=10)
+
+    Analyse the given mesh lines in a single pass over the sorted lines.
+
+    The smallest (min_res) and largest (max_res) cell is found between the
+    sorted lines with the index min_res_idx/max_res_idx and the next one, the
+    largest ratio of two neighboring cells (max_ratio) at the line max_ratio_idx
+    between them. The histograms of the cell sizes and ratios are given by
+    numBins+1 bin edges each.
+
+    :param lines: array -- mesh lines, need not be sorted
+    :param numBins: int -- number of histogram bins
+    :returns: dict or None -- mesh quality figures, None for less than two lines
+    """
+    cdef _MeshQuality q
+    if not _AnalyseMesh(np.asarray(lines, dtype=float).ravel(), q, numBins):
+        return None
+    return _MeshQuality2Dict(q)
@@ -69,7 +69,7 @@ cdef extern from "CSXCAD/ContinuousStructure.h":
             vector[_CSProperties*] GetPropertyByType(PropertyType prop_type)
 
             void clear()
-            string Update()
+            string Update(bool full)
 
 cdef class CSBackgroundMaterial:
     cdef _CSBackgroundMaterial *thisptr
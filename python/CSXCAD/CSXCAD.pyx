@@ -248,8 +248,15 @@ cdef class ContinuousStructure:
             raise RuntimeError('wrapped C++ object of type {} has been deleted'.format(type(self).__name__))
         return self.thisptr
 
-    def Update(self):
-        return self._ptr().Update().decode('UTF-8')
+    def Update(self, full=False):
+        """ Update(full=False)
+
+        Update the primitives depending on changed parameters and all properties.
+
+        :param full: bool -- update all primitives, regardless of the recorded dependencies
+        :returns: str -- error messages, empty on success
+        """
+        return self._ptr().Update(full).decode('UTF-8')
 
     def Clear(self):
         return self._ptr().clear()
@@ -0,0 +1,238 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <math.h>
+
+#include "CSBoundingVolumeHierarchy.h"
+#include "CSPrimitives.h"
+
+// max number of primitives in a leaf
+#define BVH_LEAF_SIZE 4
+
+// relative padding of all boxes, to be robust against round-off of the coordinate transformations
+#define BVH_REL_PADDING 1e-12
+
+namespace
+{
+struct SearchOrder
+{
+	// priority descending, then by property and primitive index, as the brute force search does
+	bool operator()(const std::pair<std::pair<int,size_t>,size_t> &a, const std::pair<std::pair<int,size_t>,size_t> &b) const
+	{
+		if (a.first.first!=b.first.first)
+			return a.first.first>b.first.first;
+		if (a.first.second!=b.first.second)
+			return a.first.second<b.first.second;
+		return a.second<b.second;
+	}
+};
+
+struct CenterLess
+{
+	CenterLess(const std::vector<double> &center, int dir) : m_center(center), m_dir(dir) {}
+	bool operator()(unsigned int a, unsigned int b) const {return m_center[3*a+m_dir]<m_center[3*b+m_dir];}
+	const std::vector<double> &m_center;
+	int m_dir;
+};
+
+// does the box overlap the box [p_min,p_max]
+inline bool Overlap(const double* box, const double* p_min, const double* p_max)
+{
+	return (p_max[0]>=box[0]) && (p_min[0]<=box[1]) && (p_max[1]>=box[2]) && (p_min[1]<=box[3]) && (p_max[2]>=box[4]) && (p_min[2]<=box[5]);
+}
+}
+
+CSBoundingVolumeHierarchy::CSBoundingVolumeHierarchy()
+{
+	m_MeshType = CARTESIAN;
+}
+
+CSBoundingVolumeHierarchy::~CSBoundingVolumeHierarchy()
+{
+	Clear();
+}
+
+void CSBoundingVolumeHierarchy::Clear()
+{
+	m_Entries.clear();
+	m_Index.clear();
+	m_Unbounded.clear();
+	m_Nodes.clear();
+	m_Center.clear();
+}
+
+void CSBoundingVolumeHierarchy::Build(const std::vector<CSProperties*> &props, CoordinateSystem cs)
+{
+	Clear();
+	m_MeshType = cs;
+
+	// sort all primitives into the search order, the entry index is then the rank of a primitive
+	std::vector<std::pair<std::pair<int,size_t>,size_t> > order;
+	for (size_t i=0;i<props.size();++i)
+		for (size_t j=0;j<props.at(i)->GetQtyPrimitives();++j)
+			order.push_back(std::make_pair(std::make_pair(props.at(i)->GetPrimitive(j)->GetPriority(),i),j));
+	std::sort(order.begin(),order.end(),SearchOrder());
+
+	m_Entries.resize(order.size());
+	m_Center.resize(3*order.size());
+	for (size_t n=0;n<order.size();++n)
+	{
+		Entry &entry = m_Entries.at(n);
+		entry.propIdx = order.at(n).first.second;
+		entry.prop = props.at(entry.propIdx);
+		entry.prim = entry.prop->GetPrimitive(order.at(n).second);
+		// the box is only valid for queries converted to cartesian coordinates the same way as the primitive does
+		if ((entry.prim->GetCoordInputType()!=m_MeshType) || (entry.prim->GetConservativeBoundBox(entry.box)==false))
+		{
+			m_Unbounded.push_back(n);
+			continue;
+		}
+		for (int d=0;d<3;++d)
+		{
+			double pad = BVH_REL_PADDING*(fabs(entry.box[2*d])+fabs(entry.box[2*d+1]));
+			entry.box[2*d]-=pad;
+			entry.box[2*d+1]+=pad;
+			m_Center[3*n+d] = 0.5*(entry.box[2*d]+entry.box[2*d+1]);
+		}
+		m_Index.push_back(n);
+	}
+
+	if (m_Index.size()>0)
+	{
+		m_Nodes.reserve(2*m_Index.size()/BVH_LEAF_SIZE+1);
+		BuildNode(0, m_Index.size());
+	}
+	m_Center.clear();
+}
+
+unsigned int CSBoundingVolumeHierarchy::BuildNode(unsigned int first, unsigned int count)
+{
+	unsigned int idx = m_Nodes.size();
+	m_Nodes.push_back(Node());
+
+	double box[6];
+	double cmin[3],cmax[3];
+	for (unsigned int n=first;n<first+count;++n)
+	{
+		const Entry &entry = m_Entries.at(m_Index.at(n));
+		for (int d=0;d<3;++d)
+		{
+			double c = m_Center[3*m_Index.at(n)+d];
+			if ((n==first) || (entry.box[2*d]<box[2*d]))
+				box[2*d] = entry.box[2*d];
+			if ((n==first) || (entry.box[2*d+1]>box[2*d+1]))
+				box[2*d+1] = entry.box[2*d+1];
+			if ((n==first) || (c<cmin[d]))
+				cmin[d] = c;
+			if ((n==first) || (c>cmax[d]))
+				cmax[d] = c;
+		}
+	}
+	for (int n=0;n<6;++n)
+		m_Nodes.at(idx).box[n] = box[n];
+
+	// split at the median center of the longest extent
+	int dir = 0;
+	for (int d=1;d<3;++d)
+		if (cmax[d]-cmin[d]>cmax[dir]-cmin[dir])
+			dir = d;
+
+	if ((count<=BVH_LEAF_SIZE) || (cmax[dir]<=cmin[dir]))
+	{
+		m_Nodes.at(idx).first = first;
+		m_Nodes.at(idx).count = count;
+		return idx;
+	}
+
+	unsigned int half = count/2;
+	std::nth_element(m_Index.begin()+first, m_Index.begin()+first+half, m_Index.begin()+first+count, CenterLess(m_Center,dir));
+
+	BuildNode(first, half);
+	unsigned int right = BuildNode(first+half, count-half);
+	m_Nodes.at(idx).first = right;
+	m_Nodes.at(idx).count = 0;
+	return idx;
+}
+
+CSPrimitives* CSBoundingVolumeHierarchy::FindPrimitive(const double* coord, CSProperties::PropertyType type, double tol) const
+{
+	int entry = FindEntry(coord, type, tol);
+	if (entry<0)
+		return NULL;
+	return m_Entries[entry].prim;
+}
+
+int CSBoundingVolumeHierarchy::FindEntry(const double* coord, CSProperties::PropertyType type, double tol) const
+{
+	if (m_Entries.size()==0)
+		return -1;
+
+	double p[3];
+	TransformCoordSystem(coord,p,m_MeshType,CARTESIAN);
+	double p_min[3], p_max[3];
+	for (int d=0;d<3;++d)
+	{
+		p_min[d] = p[d]-tol;
+		p_max[d] = p[d]+tol;
+	}
+
+	// the bounded hits of the tree, reused by all queries of a thread to avoid an allocation per query
+	static thread_local std::vector<unsigned int> hits;
+	hits.clear();
+	if (m_Nodes.size()>0)
+	{
+		unsigned int stack[64];
+		int top = 0;
+		stack[top++] = 0;
+		while (top>0)
+		{
+			unsigned int idx = stack[--top];
+			const Node &node = m_Nodes[idx];
+			if (Overlap(node.box,p_min,p_max)==false)
+				continue;
+			if (node.count==0)
+			{
+				stack[top++] = node.first;
+				stack[top++] = idx+1;
+				continue;
+			}
+			for (unsigned int n=node.first;n<node.first+node.count;++n)
+				if (Overlap(m_Entries[m_Index[n]].box,p_min,p_max))
+					hits.push_back(m_Index[n]);
+		}
+	}
+
+	// the entries are sorted by search order, the first hit wins
+	// merge the sorted hits with the unbounded entries, which are sorted since Build()
+	std::sort(hits.begin(),hits.end());
+	size_t h = 0, u = 0;
+	while ((h<hits.size()) || (u<m_Unbounded.size()))
+	{
+		unsigned int candidate;
+		if ((u==m_Unbounded.size()) || ((h<hits.size()) && (hits[h]<m_Unbounded[u])))
+			candidate = hits[h++];
+		else
+			candidate = m_Unbounded[u++];
+		const Entry &entry = m_Entries[candidate];
+		if ((type!=CSProperties::ANY) && ((entry.prop->GetType() & type)==0))
+			continue;
+		if (entry.prim->IsInside(coord,tol))
+			return (int)candidate;
+	}
+	return -1;
+}
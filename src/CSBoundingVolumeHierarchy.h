@@ -0,0 +1,113 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CSBOUNDINGVOLUMEHIERARCHY_H
+#define CSBOUNDINGVOLUMEHIERARCHY_H
+
+#include <vector>
+#include "CSXCAD_Global.h"
+#include "CSProperties.h"
+
+class CSPrimitives;
+
+//! Bounding volume hierarchy over all primitives of a ContinuousStructure.
+/*!
+  Used by ContinuousStructure::GetPropertyByCoordPriority to find the highest
+  priority primitive at a coordinate without calling IsInside on every primitive.
+
+  The tree is built from CSPrimitives::GetConservativeBoundBox, i.e. from
+  cartesian boxes in world coordinates, transformations included. Primitives
+  without such a box are kept in a separate list and are tested for every query.
+
+  All candidates of a query are tested in the order the brute force search would
+  prefer them: highest priority first, ties resolved by the property index and
+  then by the primitive index inside the property. The first primitive reporting
+  IsInside is therefore the same winner the brute force search would return.
+
+  The hierarchy holds plain pointers and is not updated automatically, the owner
+  has to rebuild it after any change of the structure. A query does not modify
+  the hierarchy and may be called from multiple threads, as long as the queried
+  primitives allow that.
+*/
+class CSXCAD_EXPORT CSBoundingVolumeHierarchy
+{
+public:
+	CSBoundingVolumeHierarchy();
+	virtual ~CSBoundingVolumeHierarchy();
+
+	//! Remove all primitives
+	void Clear();
+
+	//! Build the hierarchy for the given properties and all their primitives. \sa CSPrimitives::GetConservativeBoundBox
+	/*!
+	\param props All properties of the structure, in the order of the brute force search
+	\param cs The mesh coordinate system of the queries. Primitives expecting a different one are treated as unbounded.
+	 */
+	void Build(const std::vector<CSProperties*> &props, CoordinateSystem cs);
+
+	//! Find the winning primitive at a coordinate.
+	/*!
+	\param coord The coordinate in the mesh coordinate system
+	\param type Only consider properties of this type
+	\param tol Tolerance handed to CSPrimitives::IsInside
+	\return The primitive found with the highest priority, NULL if none was found
+	 */
+	CSPrimitives* FindPrimitive(const double* coord, CSProperties::PropertyType type=CSProperties::ANY, double tol=0) const;
+	//! Find the winning primitive at a coordinate, like FindPrimitive(), but return its entry index or -1 if none was found. \sa GetEntryPrimitive
+	int FindEntry(const double* coord, CSProperties::PropertyType type=CSProperties::ANY, double tol=0) const;
+
+	//! Get the primitive of an entry, the entries are sorted by the search order
+	CSPrimitives* GetEntryPrimitive(size_t entry) const {return m_Entries.at(entry).prim;}
+	//! Get the index of the property of an entry, in the property list given to Build()
+	size_t GetEntryPropertyIndex(size_t entry) const {return m_Entries.at(entry).propIdx;}
+
+	//! Get the number of primitives in this hierarchy, including the unbounded ones
+	size_t GetQtyPrimitives() const {return m_Entries.size();}
+	//! Get the number of primitives without a bounding box, these are tested for every query
+	size_t GetQtyUnboundedPrimitives() const {return m_Unbounded.size();}
+
+protected:
+	//! A primitive with its world box, m_Entries is sorted by the search order
+	struct Entry
+	{
+		CSPrimitives* prim;
+		CSProperties* prop;
+		size_t propIdx;
+		double box[6];
+	};
+
+	struct Node
+	{
+		double box[6];
+		//! for a leaf the range [first,first+count) in m_Index, otherwise (count==0) the index of the right child, the left child directly follows its parent
+		unsigned int first;
+		unsigned int count;
+	};
+
+	std::vector<Entry> m_Entries;
+	//! bounded entries, reordered during the build, referenced by the leafs
+	std::vector<unsigned int> m_Index;
+	std::vector<unsigned int> m_Unbounded;
+	std::vector<Node> m_Nodes;
+	//! centers of the entry boxes, only used during Build()
+	std::vector<double> m_Center;
+	CoordinateSystem m_MeshType;
+
+	unsigned int BuildNode(unsigned int first, unsigned int count);
+};
+
+#endif // CSBOUNDINGVOLUMEHIERARCHY_H
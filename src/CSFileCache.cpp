@@ -0,0 +1,64 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#if !defined(_WIN32)
+#include <limits.h>
+#endif
+
+#include "CSFileCache.h"
+
+bool CSFileCache::GetFileKey(const std::string& filename, std::string& key)
+{
+	if (filename.empty())
+		return false;
+#if defined(_WIN32)
+	struct _stat64 info;
+	if (_stat64(filename.c_str(), &info)!=0)
+		return false;
+	char path[_MAX_PATH];
+	if (_fullpath(path, filename.c_str(), _MAX_PATH)==NULL)
+		return false;
+	long long mtime_nsec = 0;
+#else
+	struct stat info;
+	if (stat(filename.c_str(), &info)!=0)
+		return false;
+	char path[PATH_MAX];
+	if (realpath(filename.c_str(), path)==NULL)
+		return false;
+	// a file rewritten within a second keeps its size quite often, use the full resolution of the modification time
+#if defined(__APPLE__)
+	long long mtime_nsec = info.st_mtimespec.tv_nsec;
+#else
+	long long mtime_nsec = info.st_mtim.tv_nsec;
+#endif
+#endif
+	std::stringstream stream;
+	stream << path << "|" << (long long)info.st_mtime << "." << mtime_nsec << "|" << (long long)info.st_size;
+	key = stream.str();
+	return true;
+}
+
+std::mutex& CSFileCache::GetMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
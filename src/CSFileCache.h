@@ -0,0 +1,153 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CSFILECACHE_H
+#define CSFILECACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <string>
+#include "CSXCAD_Global.h"
+
+//! Process-wide cache of read-only data loaded from files.
+/*!
+  Data loaded through the cache is shared by all its users, e.g. by copies of a property or by an
+  excitation and a probe using the same mode file. A file is identified by its canonical path, its
+  modification time, with nanoseconds where the platform provides them, and its size, a modified file
+  is therefore loaded again.
+
+  The cache keeps no reference of its own, the data of a file is freed as soon as its last user
+  releases it. Different files are loaded concurrently, a second user of a file being loaded waits for it.
+*/
+class CSXCAD_EXPORT CSFileCache
+{
+public:
+	//! Get the identification of a file, false if the file does not exist
+	static bool GetFileKey(const std::string& filename, std::string& key);
+
+	//! Get the shared data of a file.
+	/*!
+	  \param filename The file to load
+	  \param load Called as load(filename, data) to fill a new data object if the file is not in the cache, returns false on an error.
+	  It is called without holding the cache mutex, possibly concurrently with the loader of another file.
+	  \param variant Distinguishes different data loaded from the same file, e.g. different parts of it
+	  \return The shared data, NULL if loading failed
+	 */
+	template <class T, class Loader> static std::shared_ptr<const T> Load(const std::string& filename, Loader load, const std::string& variant=std::string());
+
+protected:
+	//! A cached file, either in use or being loaded
+	template <class T> struct Entry
+	{
+		std::weak_ptr<const T> data;
+		//! valid while the file is loaded, without holding the mutex
+		std::shared_future<std::shared_ptr<const T> > loading;
+	};
+
+	//! Guards the entries, it is not held while a file is loaded
+	static std::mutex& GetMutex();
+	template <class T> static std::map<std::string, Entry<T> >& GetEntries();
+};
+
+template <class T> std::map<std::string, CSFileCache::Entry<T> >& CSFileCache::GetEntries()
+{
+	static std::map<std::string, Entry<T> > entries;
+	return entries;
+}
+
+template <class T, class Loader> std::shared_ptr<const T> CSFileCache::Load(const std::string& filename, Loader load, const std::string& variant)
+{
+	std::string key;
+	if (GetFileKey(filename, key)==false)
+	{
+		// not cached, the loader reports the missing file
+		std::shared_ptr<T> data(new T());
+		if (load(filename, *data)==false)
+			return std::shared_ptr<const T>();
+		return data;
+	}
+	key += "|" + variant;
+
+	std::promise<std::shared_ptr<const T> > promise;
+	std::shared_future<std::shared_ptr<const T> > loading;
+	{
+		std::lock_guard<std::mutex> lock(GetMutex());
+		std::map<std::string, Entry<T> >& entries = GetEntries<T>();
+		typename std::map<std::string, Entry<T> >::iterator it = entries.find(key);
+		if (it!=entries.end())
+		{
+			std::shared_ptr<const T> data = it->second.data.lock();
+			if (data)
+				return data;
+			loading = it->second.loading;
+		}
+
+		if (loading.valid()==false)
+		{
+			// forget all files without users
+			for (it=entries.begin();it!=entries.end();)
+			{
+				if ((it->second.loading.valid()==false) && it->second.data.expired())
+					entries.erase(it++);
+				else
+					++it;
+			}
+			entries[key].loading = promise.get_future().share();
+		}
+	}
+	// loaded by another user, wait for it without holding the mutex
+	if (loading.valid())
+		return loading.get();
+
+	// load without holding the mutex, only users of the same file wait for it
+	std::shared_ptr<T> data(new T());
+	bool ok = false;
+	try
+	{
+		ok = load(filename, *data);
+	}
+	catch (...)
+	{
+		// e.g. out of memory, the waiting users get the exception as well
+		{
+			std::lock_guard<std::mutex> lock(GetMutex());
+			GetEntries<T>().erase(key);
+		}
+		promise.set_exception(std::current_exception());
+		throw;
+	}
+	std::shared_ptr<const T> result;
+	if (ok)
+		result = data;
+	{
+		std::lock_guard<std::mutex> lock(GetMutex());
+		std::map<std::string, Entry<T> >& entries = GetEntries<T>();
+		if (ok)
+		{
+			entries[key].data = result;
+			entries[key].loading = std::shared_future<std::shared_ptr<const T> >();
+		}
+		else
+			entries.erase(key);
+	}
+	promise.set_value(result);
+	return result;
+}
+
+#endif // CSFILECACHE_H
@@ -17,12 +17,14 @@
 */
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include <hdf5.h>
 #include <hdf5_hl.h>
 
 #include "CSModeData.h"
+#include "CSFileCache.h"
 
 namespace {
 
@@ -73,12 +75,35 @@ bool ReadMat(hid_t fid, const char* name, std::vector<double>& out,
 	return H5LTread_dataset_double(fid, name, out.data()) >= 0;
 }
 
+// Check whether an axis is uniformly spaced and get its inverse spacing.
+// Small deviations are accepted, the interval search corrects an index that is off by one.
+bool IsUniform(const std::vector<double>& axis, double& invDelta)
+{
+	invDelta = 0.0;
+	const size_t n = axis.size();
+	if (n < 2)
+		return false;
+	const double delta = (axis.back() - axis.front()) / (n - 1);
+	if (delta <= 0.0)
+		return false;
+	for (size_t k = 1; k < n; ++k)
+		if (std::fabs(axis[k] - (axis.front() + k * delta)) > 1e-3 * delta)
+			return false;
+	invDelta = 1.0 / delta;
+	return true;
+}
+
 } // namespace
 
 bool CSModeData::ReadFromHDF5(const std::string& filename)
 {
 	Clear();
+	m_Data = CSFileCache::Load<Samples>(filename, &CSModeData::ReadSamples);
+	return IsLoaded();
+}
 
+bool CSModeData::ReadSamples(const std::string& filename, Samples& data)
+{
 	hid_t fid = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
 	if (fid < 0)
 	{
@@ -95,69 +120,162 @@ bool CSModeData::ReadFromHDF5(const std::string& filename)
 		return false;
 	}
 
-	if (!ReadVec(fid, "x", m_X) || !ReadVec(fid, "y", m_Y))
+	if (!ReadVec(fid, "x", data.X) || !ReadVec(fid, "y", data.Y))
 	{
 		std::cerr << "CSModeData: missing or invalid 'x' or 'y' dataset in '" << filename << "'\n";
 		H5Fclose(fid);
 		return false;
 	}
-	m_nx = m_X.size();
-	m_ny = m_Y.size();
+	data.nx = data.X.size();
+	data.ny = data.Y.size();
 
-	if (!ReadMat(fid, "Vx", m_Vx, m_nx, m_ny) || !ReadMat(fid, "Vy", m_Vy, m_nx, m_ny))
+	if (!ReadMat(fid, "Vx", data.Vx, data.nx, data.ny) || !ReadMat(fid, "Vy", data.Vy, data.nx, data.ny))
 	{
 		std::cerr << "CSModeData: missing or invalid 'Vx' or 'Vy' dataset in '" << filename << "'\n";
 		H5Fclose(fid);
-		Clear();
 		return false;
 	}
 
 	H5Fclose(fid);
+
+	data.uniformX = IsUniform(data.X, data.invDX);
+	data.uniformY = IsUniform(data.Y, data.invDY);
 	return true;
 }
 
 void CSModeData::Clear()
 {
-	m_X.clear();
-	m_Y.clear();
-	m_Vx.clear();
-	m_Vy.clear();
-	m_nx = 0;
-	m_ny = 0;
+	m_Data.reset();
+}
+
+size_t CSModeData::FindInterval(const std::vector<double>& axis, bool uniform, double invDelta, double v, size_t guess)
+{
+	// The interval [axis[i], axis[i+1]] with the largest i for which axis[i] < v,
+	// limited to [0, n-2], i.e. the same interval a std::lower_bound search finds.
+	const size_t last = axis.size() - 2;
+	size_t i = guess;
+	if (uniform)
+		i = (size_t)std::max(0.0, std::min((double)last, std::floor((v - axis.front()) * invDelta)));
+	else if (i > last)
+		i = 0;
+
+	// step to the right interval, at most a few steps for a uniform axis or a neighbouring guess
+	for (int steps = 0; steps < 4; ++steps)
+	{
+		if (i > 0 && axis[i] >= v)
+			--i;
+		else if (i < last && axis[i + 1] < v)
+			++i;
+		else
+			return i;
+	}
+
+	auto it = std::lower_bound(axis.begin(), axis.end(), v);
+	if (it != axis.begin()) --it;
+	return std::min((size_t)(it - axis.begin()), last);
 }
 
 std::array<double, 2> CSModeData::LinInterp2(double x, double y) const
 {
+	const Samples& d = *m_Data;
 	// Clamp to grid extent
-	x = std::max(m_X.front(), std::min(m_X.back(), x));
-	y = std::max(m_Y.front(), std::min(m_Y.back(), y));
+	x = std::max(d.X.front(), std::min(d.X.back(), x));
+	y = std::max(d.Y.front(), std::min(d.Y.back(), y));
 
-	// Left-edge x index (first dimension)
-	auto it = std::lower_bound(m_X.begin(), m_X.end(), x);
-	if (it != m_X.begin()) --it;
-	size_t i = std::min((size_t)(it - m_X.begin()), m_nx - 2);
+	const size_t i = FindInterval(d.X, d.uniformX, d.invDX, x, 0);
+	const size_t j = FindInterval(d.Y, d.uniformY, d.invDY, y, 0);
+	return Interp(x, y, i, j);
+}
 
-	// Left-edge y index (second dimension)
-	auto jt = std::lower_bound(m_Y.begin(), m_Y.end(), y);
-	if (jt != m_Y.begin()) --jt;
-	size_t j = std::min((size_t)(jt - m_Y.begin()), m_ny - 2);
+void CSModeData::LinInterp2(size_t num, const double* x, const double* y, double* vx, double* vy) const
+{
+	const Samples& d = *m_Data;
+	size_t i = 0, j = 0;
+	for (size_t n = 0; n < num; ++n)
+	{
+		const double xc = std::max(d.X.front(), std::min(d.X.back(), x[n]));
+		const double yc = std::max(d.Y.front(), std::min(d.Y.back(), y[n]));
+		i = FindInterval(d.X, d.uniformX, d.invDX, xc, i);
+		j = FindInterval(d.Y, d.uniformY, d.invDY, yc, j);
+		const std::array<double, 2> v = Interp(xc, yc, i, j);
+		vx[n] = v[0];
+		vy[n] = v[1];
+	}
+}
 
-	const double x1 = m_X[i],     x2 = m_X[i + 1];
-	const double y1 = m_Y[j],     y2 = m_Y[j + 1];
+std::array<double, 2> CSModeData::Interp(double x, double y, size_t i, size_t j) const
+{
+	const Samples& d = *m_Data;
+	const double x1 = d.X[i],     x2 = d.X[i + 1];
+	const double y1 = d.Y[j],     y2 = d.Y[j + 1];
 	const double D  = 1.0 / ((x2 - x1) * (y2 - y1));
 
 	auto interp = [&](const std::vector<double>& A) -> double
 	{
-		// A[i, j] = A[i * m_ny + j]  where i=x-index, j=y-index
-		const double f11 = A[ i      * m_ny + j    ];  // (x[i],   y[j]  )
-		const double f21 = A[(i + 1) * m_ny + j    ];  // (x[i+1], y[j]  )
-		const double f12 = A[ i      * m_ny + j + 1];  // (x[i],   y[j+1])
-		const double f22 = A[(i + 1) * m_ny + j + 1];  // (x[i+1], y[j+1])
+		// A[i, j] = A[i * d.ny + j]  where i=x-index, j=y-index
+		const double f11 = A[ i      * d.ny + j    ];  // (x[i],   y[j]  )
+		const double f21 = A[(i + 1) * d.ny + j    ];  // (x[i+1], y[j]  )
+		const double f12 = A[ i      * d.ny + j + 1];  // (x[i],   y[j+1])
+		const double f22 = A[(i + 1) * d.ny + j + 1];  // (x[i+1], y[j+1])
 		return D * (  f11 * (x2 - x) * (y2 - y)
 		            + f21 * (x - x1) * (y2 - y)
 		            + f12 * (x2 - x) * (y - y1)
 		            + f22 * (x - x1) * (y - y1));
 	};
 
-	return { interp(m_Vx), interp(m_Vy) };
+	return { interp(d.Vx), interp(d.Vy) };
+}
+
+void CSModeData::AxisWeights(const std::vector<double>& axis, bool uniform, double invDelta,
+                             const std::vector<double>& pos, std::vector<size_t>& index, std::vector<double>& weight)
+{
+	index.resize(pos.size());
+	weight.resize(pos.size());
+	size_t i = 0;
+	for (size_t n = 0; n < pos.size(); ++n)
+	{
+		const double v = std::max(axis.front(), std::min(axis.back(), pos[n]));
+		i = FindInterval(axis, uniform, invDelta, v, i);
+		index[n]  = i;
+		weight[n] = (v - axis[i]) / (axis[i + 1] - axis[i]);
+	}
+}
+
+void CSModeData::Resample(const std::vector<double>& x, const std::vector<double>& y,
+                          std::vector<double>& vx, std::vector<double>& vy) const
+{
+	vx.assign(x.size() * y.size(), 0.0);
+	vy.assign(x.size() * y.size(), 0.0);
+	if (!IsLoaded() || y.empty())
+		return;
+	const Samples& d = *m_Data;
+
+	std::vector<size_t> xi, yj;
+	std::vector<double> xw, yw;
+	AxisWeights(d.X, d.uniformX, d.invDX, x, xi, xw);
+	AxisWeights(d.Y, d.uniformY, d.invDY, y, yj, yw);
+
+	// only the mode samples between the first and last y-line are needed
+	const size_t j0 = *std::min_element(yj.begin(), yj.end());
+	const size_t j1 = *std::max_element(yj.begin(), yj.end()) + 1;
+	std::vector<double> rowX(d.ny), rowY(d.ny);
+	for (size_t i = 0; i < x.size(); ++i)
+	{
+		// the mode interpolated along x at x[i], for all samples in y
+		const double* ax = &d.Vx[xi[i] * d.ny];
+		const double* ay = &d.Vy[xi[i] * d.ny];
+		for (size_t k = j0; k <= j1; ++k)
+		{
+			rowX[k] = ax[k] + xw[i] * (ax[d.ny + k] - ax[k]);
+			rowY[k] = ay[k] + xw[i] * (ay[d.ny + k] - ay[k]);
+		}
+		// and along y for all y-lines
+		double* outX = &vx[i * y.size()];
+		double* outY = &vy[i * y.size()];
+		for (size_t j = 0; j < y.size(); ++j)
+		{
+			outX[j] = rowX[yj[j]] + yw[j] * (rowX[yj[j] + 1] - rowX[yj[j]]);
+			outY[j] = rowY[yj[j]] + yw[j] * (rowY[yj[j] + 1] - rowY[yj[j]]);
+		}
+	}
 }
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -41,19 +42,56 @@ class CSXCAD_EXPORT CSModeData
 public:
 	CSModeData() = default;
 
+	//! Load a mode file. The samples are shared with all other CSModeData (and copies) of the same file. \sa CSFileCache
 	bool ReadFromHDF5(const std::string& filename);
 	void Clear();
-	bool IsLoaded() const { return !m_Vx.empty(); }
+	bool IsLoaded() const { return m_Data != nullptr; }
 
 	//! Bilinear interpolation at (x, y).
 	//! Returns {Vx, Vy}. Coordinates outside the grid are clamped to the boundary.
 	std::array<double, 2> LinInterp2(double x, double y) const;
 
+	//! Bilinear interpolation at num points (x[n], y[n]), e.g. along a grid line.
+	//! Same results as LinInterp2(x[n], y[n]). The interval of the previous point is
+	//! tried first, neighbouring points therefore need no search on non-uniform axes.
+	void LinInterp2(size_t num, const double* x, const double* y, double* vx, double* vy) const;
+
+	//! Bilinear interpolation onto all points (x[i], y[j]) of a plane of grid lines.
+	//! The interpolation weights are computed once per line, the mode is first interpolated
+	//! along x and then along y. vx and vy are resized to x.size()*y.size() and filled
+	//! row-major, v[i*y.size()+j] at (x[i], y[j]). Same results as LinInterp2 up to round-off.
+	void Resample(const std::vector<double>& x, const std::vector<double>& y,
+	              std::vector<double>& vx, std::vector<double>& vy) const;
+
+	//! True if the x- or y-axis is uniformly spaced and intervals are found without a search
+	bool IsUniformX() const { return m_Data && m_Data->uniformX; }
+	bool IsUniformY() const { return m_Data && m_Data->uniformY; }
+
 private:
-	std::vector<double> m_X;   // x-axis, length m_nx
-	std::vector<double> m_Y;   // y-axis, length m_ny
-	std::vector<double> m_Vx;  // row-major (m_nx x m_ny)
-	std::vector<double> m_Vy;
-	size_t m_nx = 0;
-	size_t m_ny = 0;
+	//! The samples of a mode file, read-only once loaded
+	struct Samples
+	{
+		std::vector<double> X;   // x-axis, length nx
+		std::vector<double> Y;   // y-axis, length ny
+		std::vector<double> Vx;  // row-major (nx x ny)
+		std::vector<double> Vy;
+		size_t nx = 0;
+		size_t ny = 0;
+
+		// uniform axes: the interval index follows from the inverse spacing
+		bool   uniformX = false;
+		bool   uniformY = false;
+		double invDX = 0.0;
+		double invDY = 0.0;
+	};
+	std::shared_ptr<const Samples> m_Data;
+
+	static bool ReadSamples(const std::string& filename, Samples& data);
+
+	// Left-edge index of the interval containing v (v already clamped), starting at guess
+	static size_t FindInterval(const std::vector<double>& axis, bool uniform, double invDelta, double v, size_t guess);
+	std::array<double, 2> Interp(double x, double y, size_t i, size_t j) const;
+	// Interval index and weight of the upper sample for all positions on one axis
+	static void AxisWeights(const std::vector<double>& axis, bool uniform, double invDelta,
+	                        const std::vector<double>& pos, std::vector<size_t>& index, std::vector<double>& weight);
 };
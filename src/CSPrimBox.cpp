@@ -18,6 +18,7 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -129,6 +130,30 @@ bool CSPrimBox::IsInside(const double* Coord, double /*tol*/)
 		return CoordInRange(pos, start, stop, m_MeshType);
 }
 
+void CSPrimBox::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	// a transformed box, a box in another coordinate system or a line in alpha direction (periodic) is not aligned with the line
+	bool aligned = (HasTransform()==false) && ((m_PrimCoordSystem==UNDEFINED_CS) || (m_PrimCoordSystem==m_MeshType));
+	if ((m_MeshType==CYLINDRICAL) && (ny==1))
+		aligned = false;
+	if ((aligned==false) || (ny<0) || (ny>2))
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+
+	intervals.clear();
+	const double* start = m_Coords[0].GetCoords(m_PrimCoordSystem);
+	const double* stop  = m_Coords[1].GetCoords(m_PrimCoordSystem);
+	// the box is the product of its ranges, check the other two directions at the box center along the line
+	double p[3] = {coord[0],coord[1],coord[2]};
+	p[ny] = 0.5*(start[ny]+stop[ny]);
+	if (IsInside(p,tol)==false)
+		return;
+	intervals.push_back(std::min(start[ny],stop[ny]));
+	intervals.push_back(std::max(start[ny],stop[ny]));
+}
+
 
 bool CSPrimBox::Update(std::string *ErrStr)
 {
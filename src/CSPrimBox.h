@@ -45,6 +45,7 @@ public:
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
@@ -53,6 +54,7 @@ public:
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return m_Coords[0].GetRevision()+m_Coords[1].GetRevision();}
 	//start and stop coords defining the box
 	ParameterCoord m_Coords[2];
 };
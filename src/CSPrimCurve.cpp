@@ -104,6 +104,14 @@ void CSPrimCurve::ClearPoints()
 	points.clear();
 }
 
+unsigned int CSPrimCurve::GetParameterRevision() const
+{
+	unsigned int revision=0;
+	for (size_t i=0;i<points.size();++i)
+		revision+=points.at(i)->GetRevision();
+	return revision;
+}
+
 bool CSPrimCurve::GetBoundBox(double dBoundBox[6], bool /*PreserveOrientation*/)
 {
 //	cerr << "CSPrimCurve::GetBoundBox: Warning: The bounding box for this object is not calculated properly... " << std::endl;
@@ -135,6 +143,14 @@ bool CSPrimCurve::GetBoundBox(double dBoundBox[6], bool /*PreserveOrientation*/)
 	return accurate;
 }
 
+bool CSPrimCurve::GetConservativeBoundBox(double dBoundBox[6])
+{
+	// the bounding box is not considered accurate, but derived classes like the wire reject any coordinate outside of it
+	if (m_Dimension<0)
+		return false;
+	return BoundBox2Cartesian(m_BoundBox, dBoundBox);
+}
+
 bool CSPrimCurve::IsInside(const double* /*Coord*/, double /*tol*/)
 {
 	//this is a 1D-object, you can never be inside...
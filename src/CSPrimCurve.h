@@ -45,6 +45,7 @@ public:
 	virtual void ClearPoints();
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
+	virtual bool GetConservativeBoundBox(double dBoundBox[6]);
 	virtual bool IsInside(const double* Coord, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
@@ -52,5 +53,6 @@ public:
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const;
 	std::vector<ParameterCoord*> points;
 };
@@ -18,6 +18,7 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -239,6 +240,25 @@ bool CSPrimCylinder::IsInside(const double* Coord, double /*tol*/)
 	return true;
 }
 
+void CSPrimCylinder::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	double origin[3],dir[3];
+	if (GetCartesianLine(ny,coord,origin,dir)==false)
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	double t0,t1,b0,b1;
+	if (Line_Cylinder_Intersection(origin,dir,m_AxisCoords[0].GetCartesianCoords(),m_AxisCoords[1].GetCartesianCoords(),psRadius.GetValue(),t0,t1)
+			&& Line_Box_Intersection(origin,dir,m_BoundBox,b0,b1) && (std::max(t0,b0)<=std::min(t1,b1)))
+	{
+		intervals.push_back(std::max(t0,b0));
+		intervals.push_back(std::min(t1,b1));
+	}
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 bool CSPrimCylinder::Update(std::string *ErrStr)
 {
 	int EC=0;
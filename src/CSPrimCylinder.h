@@ -55,6 +55,7 @@ public:
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
@@ -63,6 +64,7 @@ public:
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return m_AxisCoords[0].GetRevision()+m_AxisCoords[1].GetRevision()+psRadius.GetRevision();}
 	ParameterCoord m_AxisCoords[2];
 	ParameterScalar psRadius;
 	virtual double GetBBRadius() {return psRadius.GetValue();} // Get the radius for the bounding box calculation
@@ -18,6 +18,7 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -76,6 +77,47 @@ bool CSPrimCylindricalShell::IsInside(const double* Coord, double /*tol*/)
 	return true;
 }
 
+void CSPrimCylindricalShell::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	double origin[3],dir[3];
+	if (GetCartesianLine(ny,coord,origin,dir)==false)
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	const double* start=m_AxisCoords[0].GetCartesianCoords();
+	const double* stop =m_AxisCoords[1].GetCartesianCoords();
+	double rad = psRadius.GetValue();
+	double width = psShellWidth.GetValue();
+	double t0,t1,b0,b1;
+	if ((Line_Cylinder_Intersection(origin,dir,start,stop,rad+width/2.0,t0,t1)==false) || (Line_Box_Intersection(origin,dir,m_BoundBox,b0,b1)==false))
+		return;
+	t0 = std::max(t0,b0);
+	t1 = std::min(t1,b1);
+	double t2,t3;
+	// cut out the inner cylinder
+	if ((rad>width/2.0) && Line_Cylinder_Intersection(origin,dir,start,stop,rad-width/2.0,t2,t3))
+	{
+		if (t0<=std::min(t1,t2))
+		{
+			intervals.push_back(t0);
+			intervals.push_back(std::min(t1,t2));
+		}
+		if (std::max(t0,t3)<=t1)
+		{
+			intervals.push_back(std::max(t0,t3));
+			intervals.push_back(t1);
+		}
+	}
+	else if (t0<=t1)
+	{
+		intervals.push_back(t0);
+		intervals.push_back(t1);
+	}
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 bool CSPrimCylindricalShell::Update(std::string *ErrStr)
 {
 	int EC=0;
@@ -91,6 +91,11 @@ bool CSPrimLinPoly::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
 	return accurate;
 }
 
+bool CSPrimLinPoly::AddMeshEdges(std::vector<MeshEdge> &edges)
+{
+	return AddPolygonMeshEdges(edges, Elevation.GetValue(), extrudeLength.GetValue());
+}
+
 bool CSPrimLinPoly::IsInside(const double* Coord, double tol)
 {
 	if (Coord==NULL) return false;
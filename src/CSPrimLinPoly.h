@@ -49,5 +49,8 @@ public:
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return CSPrimPolygon::GetParameterRevision()+extrudeLength.GetRevision();}
+	virtual bool AddMeshEdges(std::vector<MeshEdge> &edges);
+
 	ParameterScalar extrudeLength;
 };
@@ -18,6 +18,7 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -133,6 +134,7 @@ void CSPrimMultiBox::ClearOverlap()
 {
 	if (vCoords.size()%6==0) return;  //no work to be done
 
+	Invalidate();
 	size_t new_size = vCoords.size() - vCoords.size()%6;
 	for (size_t i=new_size; i<vCoords.size(); ++i)
 		delete vCoords.at(i);
@@ -187,6 +189,14 @@ bool CSPrimMultiBox::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
 	return false;
 }
 
+bool CSPrimMultiBox::GetConservativeBoundBox(double dBoundBox[6])
+{
+	// the bounding box is not considered accurate, but contains all boxes
+	if (m_Dimension<0)
+		return false;
+	return BoundBox2Cartesian(m_BoundBox, dBoundBox);
+}
+
 bool CSPrimMultiBox::IsInside(const double* Coord, double /*tol*/)
 {
 	if (Coord==NULL) return false;
@@ -219,8 +229,46 @@ bool CSPrimMultiBox::IsInside(const double* Coord, double /*tol*/)
 	return false;
 }
 
+void CSPrimMultiBox::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	// the boxes are checked in mesh coordinates without any periodicity, only a transformation breaks the alignment with the line
+	if (HasTransform() || (ny<0) || (ny>2))
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	for (unsigned int i=0;i<vCoords.size()/6;++i)
+	{
+		bool in=true;
+		for (int n=0;n<3;++n)
+		{
+			if (n==ny)
+				continue;
+			double DownVal=std::min(vCoords.at(6*i+2*n)->GetValue(),vCoords.at(6*i+2*n+1)->GetValue());
+			double UpVal=std::max(vCoords.at(6*i+2*n)->GetValue(),vCoords.at(6*i+2*n+1)->GetValue());
+			if ((DownVal>coord[n]) || (UpVal<coord[n]))
+				in=false;
+		}
+		if (in==false)
+			continue;
+		intervals.push_back(vCoords.at(6*i+2*ny)->GetValue());
+		intervals.push_back(vCoords.at(6*i+2*ny+1)->GetValue());
+	}
+	// sort and merge the overlapping boxes
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 unsigned int CSPrimMultiBox::GetQtyBoxes() {return (unsigned int) vCoords.size()/6;}
 
+unsigned int CSPrimMultiBox::GetParameterRevision() const
+{
+	unsigned int revision=0;
+	for (size_t i=0;i<vCoords.size();++i)
+		revision+=vCoords.at(i)->GetRevision();
+	return revision;
+}
+
 bool CSPrimMultiBox::Update(std::string *ErrStr)
 {
 	int EC=0;
@@ -50,7 +50,9 @@ public:
 	void ClearOverlap();
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
+	virtual bool GetConservativeBoundBox(double dBoundBox[6]);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	unsigned int GetQtyBoxes();
 
@@ -59,6 +61,7 @@ public:
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const;
 	std::vector<ParameterScalar*> vCoords;
 };
 
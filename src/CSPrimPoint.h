@@ -53,6 +53,7 @@ public:
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return m_Coords.GetRevision();}
 	//! Vector describing the point: x,y,z
 	ParameterCoord m_Coords;
 };
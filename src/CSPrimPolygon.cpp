@@ -18,6 +18,7 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -100,6 +101,14 @@ ParameterScalar* CSPrimPolygon::GetCoordPS(int index)
 
 size_t CSPrimPolygon::GetQtyCoords() {return vCoords.size()/2;}
 
+unsigned int CSPrimPolygon::GetParameterRevision() const
+{
+	unsigned int revision=Elevation.GetRevision();
+	for (size_t i=0;i<vCoords.size();++i)
+		revision+=vCoords.at(i).GetRevision();
+	return revision;
+}
+
 double* CSPrimPolygon::GetAllCoords(size_t &Qty, double* array)
 {
 	Qty=vCoords.size();
@@ -153,6 +162,70 @@ bool CSPrimPolygon::GetBoundBox(double dBoundBox[6], bool PreserveOrientation)
 	return accurate;
 }
 
+bool CSPrimPolygon::GetConservativeBoundBox(double dBoundBox[6])
+{
+	// the bounding box is not considered accurate, but IsInside() rejects any coordinate outside of it
+	if (m_Dimension<0)
+		return false;
+	return BoundBox2Cartesian(m_BoundBox, dBoundBox);
+}
+
+bool CSPrimPolygon::AddMeshEdges(std::vector<MeshEdge> &edges)
+{
+	return AddPolygonMeshEdges(edges, Elevation.GetValue(), 0);
+}
+
+bool CSPrimPolygon::AddPolygonMeshEdges(std::vector<MeshEdge> &edges, double elevation, double length)
+{
+	// the vertices are cartesian
+	if ((m_MeshType!=CARTESIAN) || (vCoords.size()<2))
+		return false;
+	int nP = (m_NormDir+1)%3;
+	int nPP = (m_NormDir+2)%3;
+	size_t numVertex = vCoords.size()/2;
+	MeshEdge edge;
+	for (size_t i=0;i<numVertex;++i)
+	{
+		double x = vCoords.at(2*i).GetValue();
+		double y = vCoords.at(2*i+1).GetValue();
+		edge.pos[m_NormDir] = elevation + 0.5*length;
+		edge.pos[nP] = x;
+		edge.pos[nPP] = y;
+		edge.ny = nP;
+		edges.push_back(edge);
+		edge.ny = nPP;
+		edges.push_back(edge);
+
+		// an axis parallel edge is best located by its center
+		double xn = vCoords.at(2*((i+1)%numVertex)).GetValue();
+		double yn = vCoords.at(2*((i+1)%numVertex)+1).GetValue();
+		edge.pos[nP] = 0.5*(x+xn);
+		edge.pos[nPP] = 0.5*(y+yn);
+		if ((x==xn) && (y!=yn))
+		{
+			edge.ny = nP;
+			edges.push_back(edge);
+		}
+		if ((y==yn) && (x!=xn))
+		{
+			edge.ny = nPP;
+			edges.push_back(edge);
+		}
+	}
+	// the polygon plane(s)
+	edge.ny = m_NormDir;
+	edge.pos[nP] = vCoords.at(0).GetValue();
+	edge.pos[nPP] = vCoords.at(1).GetValue();
+	edge.pos[m_NormDir] = elevation;
+	edges.push_back(edge);
+	if (length!=0)
+	{
+		edge.pos[m_NormDir] = elevation + length;
+		edges.push_back(edge);
+	}
+	return true;
+}
+
 bool CSPrimPolygon::IsInside(const double* inCoord, double /*tol*/)
 {
 	if (inCoord==NULL) return false;
@@ -217,6 +290,73 @@ bool CSPrimPolygon::IsInside(const double* inCoord, double /*tol*/)
 	return false;
 }
 
+void CSPrimPolygon::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	// only an untransformed polygon (or extruded polygon) in a cartesian mesh is aligned with the line
+	if ((m_MeshType!=CARTESIAN) || HasTransform() || (m_Dimension<0) || (vCoords.size()<2) || (ny<0) || (ny>2))
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	if (ny==m_NormDir)
+	{
+		// the line crosses the polygon plane (or the extrusion) at a single point of the polygon
+		double p[3] = {coord[0],coord[1],coord[2]};
+		p[ny] = 0.5*(m_BoundBox[2*ny]+m_BoundBox[2*ny+1]);
+		if (IsInside(p,tol))
+		{
+			intervals.push_back(m_BoundBox[2*ny]);
+			intervals.push_back(m_BoundBox[2*ny+1]);
+		}
+		return;
+	}
+	if ((coord[m_NormDir]<m_BoundBox[2*m_NormDir]) || (coord[m_NormDir]>m_BoundBox[2*m_NormDir+1]))
+		return;
+	int nP = (m_NormDir+1)%3;
+	int nPP = (m_NormDir+2)%3;
+	if (ny==nP)
+		GetPolygonLineIntervals(0, coord[nPP], intervals);
+	else
+		GetPolygonLineIntervals(1, coord[nP], intervals);
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
+void CSPrimPolygon::GetPolygonLineIntervals(int dir, double val, std::vector<double> &intervals)
+{
+	intervals.clear();
+	size_t np = vCoords.size()/2;
+	if (np<2)
+		return;
+	int u = dir;   // coordinate along the line
+	int v = 1-dir; // fixed coordinate
+
+	// all edge crossings with the direction of the edge, the same half-open rule as in IsInside()
+	std::vector<std::pair<double,int> > crossings;
+	double u1 = vCoords[2*np-2+u].GetValue();
+	double v1 = vCoords[2*np-2+v].GetValue();
+	for (size_t i=0;i<np;++i)
+	{
+		double u2 = vCoords[2*i+u].GetValue();
+		double v2 = vCoords[2*i+v].GetValue();
+		if ((v1>=val) != (v2>=val))
+			crossings.push_back(std::make_pair(u1+(val-v1)*(u2-u1)/(v2-v1), (v2>=val) ? 1 : -1));
+		u1 = u2;
+		v1 = v2;
+	}
+	std::sort(crossings.begin(),crossings.end());
+
+	// the winding number changes at every crossing, the line is inside while it is not zero
+	int wn = 0;
+	for (size_t n=0;n<crossings.size();++n)
+	{
+		int last = wn;
+		wn += crossings[n].second;
+		if ((last==0) != (wn==0))
+			intervals.push_back(crossings[n].first);
+	}
+}
+
 
 bool CSPrimPolygon::Update(std::string *ErrStr)
 {
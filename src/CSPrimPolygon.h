@@ -41,7 +41,7 @@ public:
 	void AddCoord(const std::string val);
 
 	void RemoveCoords(int index);
-	void ClearCoords() {vCoords.clear();}
+	void ClearCoords() {Invalidate(); vCoords.clear();}
 
 	double GetCoord(int index);
 	ParameterScalar* GetCoordPS(int index);
@@ -53,20 +53,35 @@ public:
 
 	int GetNormDir() {return m_NormDir;}
 
-	void SetElevation(double val) {Elevation.SetValue(val);}
-	void SetElevation(const char* val) {Elevation.SetValue(val);}
+	void SetElevation(double val) {Invalidate(); Elevation.SetValue(val);}
+	void SetElevation(const char* val) {Invalidate(); Elevation.SetValue(val);}
 
 	double GetElevation() {return Elevation.GetValue();}
 	ParameterScalar* GetElevationPS() {return &Elevation;}
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
+	virtual bool GetConservativeBoundBox(double dBoundBox[6]);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const;
+	//! Get the intervals of a line in the polygon plane inside the polygon (nonzero winding rule)
+	/*!
+	 \param dir The polygon coordinate along the line, 0 for the first and 1 for the second coordinate of the vertices
+	 \param val The fixed value of the other polygon coordinate
+	 \param intervals Filled with sorted start/stop pairs
+	 */
+	void GetPolygonLineIntervals(int dir, double val, std::vector<double> &intervals);
+
+	virtual bool AddMeshEdges(std::vector<MeshEdge> &edges);
+	//! Append the vertices and axis parallel edges of the polygon, extruded from elevation by length. \sa GetMeshEdges
+	bool AddPolygonMeshEdges(std::vector<MeshEdge> &edges, double elevation, double length);
+
 	///Vector describing the polygon, x1,y1,x2,y2 ... xn,yn
 	std::vector<ParameterScalar> vCoords;
 	///The polygon plane normal direction
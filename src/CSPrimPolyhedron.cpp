@@ -18,6 +18,8 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <algorithm>
+#include <iterator>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -182,9 +184,11 @@ void CSPrimPolyhedron::AddFace(std::vector<int> vertices)
 
 void CSPrimPolyhedron::Invalidate()
 {
-	if (m_Dimension<0)
-		return;
+	bool valid = (m_Dimension>=0);
+	// always mark the primitive as modified, see UpdateDependent
 	CSPrimitives::Invalidate();
+	if (valid==false)
+		return;
 	d_ptr->m_Polyhedron.clear();
 	if (d_ptr->m_PolyhedronTree == NULL)
 		return;
@@ -267,6 +271,58 @@ bool CSPrimPolyhedron::GetBoundBox(double dBoundBox[6], bool PreserveOrientation
 	return true;
 }
 
+bool CSPrimPolyhedron::AddMeshEdges(std::vector<MeshEdge> &edges)
+{
+	// the vertices are cartesian
+	if ((m_MeshType!=CARTESIAN) || (m_Vertices.size()==0))
+		return false;
+	MeshEdge edge;
+	for (size_t f=0;f<m_Faces.size();++f)
+	{
+		const face &fc = m_Faces.at(f);
+		if ((fc.valid==false) || (fc.numVertex<2))
+			continue;
+		const float* first = m_Vertices.at(fc.vertices[0]).coord;
+		bool inPlane[3] = {true,true,true};
+		double center[3] = {0,0,0};
+		for (unsigned int i=0;i<fc.numVertex;++i)
+		{
+			const float* a = m_Vertices.at(fc.vertices[i]).coord;
+			const float* b = m_Vertices.at(fc.vertices[(i+1)%fc.numVertex]).coord;
+			for (int n=0;n<3;++n)
+			{
+				inPlane[n] = inPlane[n] && (a[n]==first[n]);
+				center[n] += a[n];
+			}
+			// an edge parallel to axis n is a line in both other directions
+			for (int n=0;n<3;++n)
+			{
+				int nP = (n+1)%3;
+				int nPP = (n+2)%3;
+				if ((a[n]==b[n]) || (a[nP]!=b[nP]) || (a[nPP]!=b[nPP]))
+					continue;
+				for (int m=0;m<3;++m)
+					edge.pos[m] = 0.5*((double)a[m]+(double)b[m]);
+				edge.ny = nP;
+				edges.push_back(edge);
+				edge.ny = nPP;
+				edges.push_back(edge);
+			}
+		}
+		for (int n=0;n<3;++n)
+		{
+			if (inPlane[n]==false)
+				continue;
+			for (int m=0;m<3;++m)
+				edge.pos[m] = center[m]/fc.numVertex;
+			edge.pos[n] = first[n];
+			edge.ny = n;
+			edges.push_back(edge);
+		}
+	}
+	return true;
+}
+
 bool CSPrimPolyhedron::IsInside(const double* Coord, double /*tol*/)
 {
 	if (m_Dimension<0)
@@ -296,6 +352,72 @@ bool CSPrimPolyhedron::IsInside(const double* Coord, double /*tol*/)
 	return false;
 }
 
+void CSPrimPolyhedron::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	double origin[3],dir[3];
+	if ((m_Dimension<0) || (GetCartesianLine(ny,coord,origin,dir)==false))
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	if ((m_Dimension<3) || (d_ptr->m_PolyhedronTree == NULL))
+		return;
+
+	double t0,t1;
+	if (Line_Box_Intersection(origin,dir,m_BoundBox,t0,t1)==false)
+		return;
+	if (t0>=t1)
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	// a segment through the whole bounding box
+	double pad = 0.01*(t1-t0);
+	t0-=pad;
+	t1+=pad;
+	Segment segment_query(Point(origin[0]+t0*dir[0], origin[1]+t0*dir[1], origin[2]+t0*dir[2]),
+						  Point(origin[0]+t1*dir[0], origin[1]+t1*dir[1], origin[2]+t1*dir[2]));
+	std::vector<Primitive::Id> faces;
+	d_ptr->m_PolyhedronTree->all_intersected_primitives(segment_query, std::back_inserter(faces));
+
+	// line parameter of all face intersections, with the side the face is crossed from
+	std::vector<std::pair<double,int> > hits;
+	for (size_t n=0;n<faces.size();++n)
+	{
+		Polyhedron::Halfedge_const_handle h = faces.at(n)->halfedge();
+		const Point &p0 = h->vertex()->point();
+		const Point &p1 = h->next()->vertex()->point();
+		const Point &p2 = h->next()->next()->vertex()->point();
+		double e1[] = {p1.x()-p0.x(), p1.y()-p0.y(), p1.z()-p0.z()};
+		double e2[] = {p2.x()-p0.x(), p2.y()-p0.y(), p2.z()-p0.z()};
+		double normal[] = {e1[1]*e2[2]-e1[2]*e2[1], e1[2]*e2[0]-e1[0]*e2[2], e1[0]*e2[1]-e1[1]*e2[0]};
+		double denom = normal[0]*dir[0]+normal[1]*dir[1]+normal[2]*dir[2];
+		if (denom==0) // the line is in the plane of the face
+			continue;
+		double t = (normal[0]*(p0.x()-origin[0])+normal[1]*(p0.y()-origin[1])+normal[2]*(p0.z()-origin[2]))/denom;
+		hits.push_back(std::make_pair(t, denom>0 ? 1 : -1));
+	}
+	std::sort(hits.begin(),hits.end());
+
+	// a line through an edge or vertex hits all adjacent faces at once, count such a crossing once,
+	// but keep the two hits of a line touching the surface from outside (crossed from both sides)
+	double eps = 1e-9*(t1-t0);
+	size_t num = 0;
+	for (size_t n=0;n<hits.size();++n)
+		if ((num==0) || (hits.at(n).first-hits.at(num-1).first>eps) || (hits.at(n).second!=hits.at(num-1).second))
+			hits.at(num++) = hits.at(n);
+	hits.resize(num);
+
+	// the line is inside between every odd and even intersection
+	for (size_t n=0;n+1<hits.size();n+=2)
+	{
+		intervals.push_back(hits.at(n).first);
+		intervals.push_back(hits.at(n+1).first);
+	}
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 
 bool CSPrimPolyhedron::Update(std::string *ErrStr)
 {
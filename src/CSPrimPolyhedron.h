@@ -68,6 +68,7 @@ public:
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
@@ -78,6 +79,8 @@ public:
 protected:
 	unsigned int m_InvalidFaces;
 	virtual void Invalidate();
+	//! Append the faces in a mesh plane and the axis parallel edges of all valid faces.
+	virtual bool AddMeshEdges(std::vector<MeshEdge> &edges);
 	std::vector<vertex> m_Vertices;
 	std::vector<face> m_Faces;
 	CSPrimPolyhedronPrivate *d_ptr; //!< pointer to private data structure, to hide the CGAL dependency from applications
@@ -37,10 +37,10 @@ public:
 
 	virtual CSPrimPolyhedronReader* GetCopy(CSProperties *prop=NULL) {return new CSPrimPolyhedronReader(this,prop);}
 
-	virtual void SetFilename(std::string name) {m_filename=name;}
+	virtual void SetFilename(std::string name) {Invalidate(); m_filename=name;}
 	virtual std::string GetFilename() const {return m_filename;}
 
-	virtual void SetFileType(FileType ft) {m_filetype=ft;}
+	virtual void SetFileType(FileType ft) {Invalidate(); m_filetype=ft;}
 	virtual FileType GetFileType() const {return m_filetype;}
 
 	virtual bool Update(std::string *ErrStr=NULL);
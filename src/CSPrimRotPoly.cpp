@@ -60,6 +60,13 @@ CSPrimRotPoly::~CSPrimRotPoly()
 {
 }
 
+bool CSPrimRotPoly::GetConservativeBoundBox(double dBoundBox[6])
+{
+	// the internal bounding box is the one of the polygon, not of the rotated body
+	UNUSED(dBoundBox);
+	return false;
+}
+
 bool CSPrimRotPoly::IsInside(const double* inCoord, double /*tol*/)
 {
 	if (inCoord==NULL) return false;
@@ -112,6 +119,50 @@ bool CSPrimRotPoly::IsInside(const double* inCoord, double /*tol*/)
 	return CSPrimPolygon::IsInside(origin);
 }
 
+void CSPrimRotPoly::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	// only a line parallel to the rotation axis sees a constant angle and distance, i.e. a straight line in the polygon plane
+	if ((m_MeshType!=CARTESIAN) || HasTransform() || (m_Dimension<0) || (vCoords.size()<2) || (ny!=m_RotAxisDir))
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	// the polygon is rotated in its own plane, i.e. at zero elevation
+	if ((m_BoundBox[2*m_NormDir]>0) || (m_BoundBox[2*m_NormDir+1]<0))
+		return;
+
+	int raP = (m_RotAxisDir+1)%3;
+	int raPP = (m_RotAxisDir+2)%3;
+	double dist = sqrt(coord[raP]*coord[raP]+coord[raPP]*coord[raPP]);
+	// polygon coordinate along the rotation axis
+	int dir = (m_RotAxisDir==(m_NormDir+1)%3) ? 0 : 1;
+
+	// the same angle checks as in IsInside(), for the polygon at +dist and the mirrored polygon at -dist
+	double alpha = atan2(coord[raPP],coord[raP]);
+	if (raP == m_NormDir)
+		alpha=alpha-M_PI/2;
+	if (alpha<0)
+		alpha+=2*M_PI;
+	if (alpha<m_StartStopAng[0])
+		alpha+=2*M_PI;
+	if (alpha<m_StartStopAng[1])
+		GetPolygonLineIntervals(dir, dist, intervals);
+
+	alpha=alpha+M_PI;
+	if (alpha>2*M_PI)
+		alpha-=2*M_PI;
+	if (alpha<m_StartStopAng[0])
+		alpha+=2*M_PI;
+	if (alpha<=m_StartStopAng[1])
+	{
+		std::vector<double> mirrored;
+		GetPolygonLineIntervals(dir, -dist, mirrored);
+		intervals.insert(intervals.end(),mirrored.begin(),mirrored.end());
+	}
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 
 bool CSPrimRotPoly::Update(std::string *ErrStr)
 {
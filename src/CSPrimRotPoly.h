@@ -35,23 +35,30 @@ public:
 
 	virtual CSPrimRotPoly* GetCopy(CSProperties *prop=NULL) {return new CSPrimRotPoly(this,prop);}
 
-	void SetRotAxisDir(int dir) {if ((dir>=0) && (dir<3)) m_RotAxisDir=dir;}
+	void SetRotAxisDir(int dir) {Invalidate(); if ((dir>=0) && (dir<3)) m_RotAxisDir=dir;}
 
 	int GetRotAxisDir() const {return m_RotAxisDir;}
 
-	void SetAngle(int index, double val) {if ((index>=0) && (index<2)) StartStopAngle[index].SetValue(val);}
-	void SetAngle(int index, const std::string val) {if ((index>=0) && (index<2)) StartStopAngle[index].SetValue(val);}
+	void SetAngle(int index, double val) {Invalidate(); if ((index>=0) && (index<2)) StartStopAngle[index].SetValue(val);}
+	void SetAngle(int index, const std::string val) {Invalidate(); if ((index>=0) && (index<2)) StartStopAngle[index].SetValue(val);}
 
 	double GetAngle(int index) const {if ((index>=0) && (index<2)) return StartStopAngle[index].GetValue(); else return 0;}
 	ParameterScalar* GetAnglePS(int index) {if ((index>=0) && (index<2)) return &StartStopAngle[index]; else return NULL;}
 
+	//! The bounding box of the rotated polygon is not known, always returns false
+	virtual bool GetConservativeBoundBox(double dBoundBox[6]);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return CSPrimPolygon::GetParameterRevision()+StartStopAngle[0].GetRevision()+StartStopAngle[1].GetRevision();}
+	//! The polygon edges are rotated out of the mesh planes, no edges are known
+	virtual bool AddMeshEdges(std::vector<MeshEdge> &edges) {UNUSED(edges);return false;}
+
 	//start-stop angle
 	ParameterScalar StartStopAngle[2];
 	//sorted and pre evaluated angles
@@ -113,6 +113,24 @@ bool CSPrimSphere::IsInside(const double* Coord, double /*tol*/)
 	return false;
 }
 
+void CSPrimSphere::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	double origin[3],dir[3];
+	if (GetCartesianLine(ny,coord,origin,dir)==false)
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	double t0,t1;
+	if (Line_Sphere_Intersection(origin,dir,m_Center.GetCartesianCoords(),psRadius.GetValue(),t0,t1))
+	{
+		intervals.push_back(t0);
+		intervals.push_back(t1);
+	}
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 bool CSPrimSphere::Update(std::string *ErrStr)
 {
 	int EC=0;
@@ -34,11 +34,11 @@ public:
 	virtual CSPrimitives* GetCopy(CSProperties *prop=NULL) {return new CSPrimSphere(this,prop);}
 
 	//! Set the center point coordinate
-	void SetCoord(int index, double val) {m_Center.SetValue(index,val);}
+	void SetCoord(int index, double val) {Invalidate(); m_Center.SetValue(index,val);}
 	//! Set the center point coordinate as paramater string
-	void SetCoord(int index, const char* val) {m_Center.SetValue(index,val);}
+	void SetCoord(int index, const char* val) {Invalidate(); m_Center.SetValue(index,val);}
 	//! Set the center point coordinate as paramater string
-	void SetCoord(int index, std::string val) {m_Center.SetValue(index,val);}
+	void SetCoord(int index, std::string val) {Invalidate(); m_Center.SetValue(index,val);}
 
 	void SetCenter(double x1, double x2, double x3);
 	void SetCenter(double x[3]);
@@ -50,14 +50,15 @@ public:
 	ParameterScalar* GetCoordPS(int index) {return m_Center.GetCoordPS(index);}
 	ParameterCoord* GetCenter() {return &m_Center;}
 
-	void SetRadius(double val) {psRadius.SetValue(val);}
-	void SetRadius(const char* val) {psRadius.SetValue(val);}
+	void SetRadius(double val) {Invalidate(); psRadius.SetValue(val);}
+	void SetRadius(const char* val) {Invalidate(); psRadius.SetValue(val);}
 
 	double GetRadius() {return psRadius.GetValue();}
 	ParameterScalar* GetRadiusPS() {return &psRadius;}
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
@@ -66,6 +67,7 @@ public:
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return m_Center.GetRevision()+psRadius.GetRevision();}
 	ParameterCoord m_Center;
 	ParameterScalar psRadius;
 };
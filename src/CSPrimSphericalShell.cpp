@@ -86,6 +86,36 @@ bool CSPrimSphericalShell::IsInside(const double* Coord, double /*tol*/)
 	return false;
 }
 
+void CSPrimSphericalShell::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	double origin[3],dir[3];
+	if (GetCartesianLine(ny,coord,origin,dir)==false)
+	{
+		CSPrimitives::GetLineIntervals(ny, coord, pos, numPos, intervals, tol);
+		return;
+	}
+	intervals.clear();
+	const double* center = m_Center.GetCartesianCoords();
+	double t0,t1,t2,t3;
+	if (Line_Sphere_Intersection(origin,dir,center,psRadius.GetValue()+psShellWidth.GetValue()/2.0,t0,t1))
+	{
+		// cut out the inner sphere
+		if ((psRadius.GetValue()>psShellWidth.GetValue()/2.0) && Line_Sphere_Intersection(origin,dir,center,psRadius.GetValue()-psShellWidth.GetValue()/2.0,t2,t3))
+		{
+			intervals.push_back(t0);
+			intervals.push_back(t2);
+			intervals.push_back(t3);
+			intervals.push_back(t1);
+		}
+		else
+		{
+			intervals.push_back(t0);
+			intervals.push_back(t1);
+		}
+	}
+	FitLineIntervals(ny, coord, pos, numPos, intervals, tol);
+}
+
 bool CSPrimSphericalShell::Update(std::string *ErrStr)
 {
 	int EC=0;
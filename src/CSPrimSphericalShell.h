@@ -35,14 +35,15 @@ public:
 
 	virtual CSPrimitives* GetCopy(CSProperties *prop=NULL) {return new CSPrimSphericalShell(this,prop);}
 
-	void SetShellWidth(double val) {psShellWidth.SetValue(val);}
-	void SetShellWidth(const char* val) {psShellWidth.SetValue(val);}
+	void SetShellWidth(double val) {Invalidate(); psShellWidth.SetValue(val);}
+	void SetShellWidth(const char* val) {Invalidate(); psShellWidth.SetValue(val);}
 
 	double GetShellWidth() {return psShellWidth.GetValue();}
 	ParameterScalar* GetShellWidthPS() {return &psShellWidth;}
 
 	virtual bool GetBoundBox(double dBoundBox[6], bool PreserveOrientation=false);
 	virtual bool IsInside(const double* Coord, double tol=0);
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
 
 	virtual bool Update(std::string *ErrStr=NULL);
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
@@ -51,6 +52,7 @@ public:
 	virtual void ShowPrimitiveStatus(std::ostream& stream);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return CSPrimSphere::GetParameterRevision()+psShellWidth.GetRevision();}
 	ParameterScalar psShellWidth;
 };
 
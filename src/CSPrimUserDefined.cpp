@@ -66,12 +66,14 @@ CSPrimUserDefined::~CSPrimUserDefined()
 
 void CSPrimUserDefined::SetCoordSystem(UserDefinedCoordSystem newSystem)
 {
+	Invalidate();
 	CoordSystem=newSystem;
 }
 
 void CSPrimUserDefined::SetFunction(const char* func)
 {
 	if (func==NULL) return;
+	Invalidate();
 	stFunction = std::string(func);
 }
 
@@ -134,7 +136,12 @@ bool CSPrimUserDefined::IsInside(const double* Coord, double /*tol*/)
 	}
 	double dValue=0;
 
-	if (fParse->GetParseErrorType()==FunctionParser::FP_NO_ERROR) dValue=fParse->Eval(vars);
+	if (fParse->GetParseErrorType()==FunctionParser::FP_NO_ERROR)
+	{
+		// the function parser evaluates on an internal stack, serialize concurrent queries
+		std::lock_guard<std::mutex> lock(m_ParserMutex);
+		dValue=fParse->Eval(vars);
+	}
 	else dValue=0;
 	delete[] vars;vars=NULL;
 
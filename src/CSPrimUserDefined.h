@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <mutex>
 #include "CSPrimitives.h"
 
 //! User defined Primitive given by an analytic formula
@@ -40,8 +41,8 @@ public:
 	void SetCoordSystem(UserDefinedCoordSystem newSystem);
 	UserDefinedCoordSystem GetCoordSystem() {return CoordSystem;}
 
-	void SetCoordShift(int index, double val) {if ((index>=0) && (index<3)) dPosShift[index].SetValue(val);}
-	void SetCoordShift(int index, const char* val) {if ((index>=0) && (index<3)) dPosShift[index].SetValue(val);}
+	void SetCoordShift(int index, double val) {Invalidate(); if ((index>=0) && (index<3)) dPosShift[index].SetValue(val);}
+	void SetCoordShift(int index, const char* val) {Invalidate(); if ((index>=0) && (index<3)) dPosShift[index].SetValue(val);}
 
 	double GetCoordShift(int index) {if ((index>=0) && (index<3)) return dPosShift[index].GetValue(); else return 0;}
 	ParameterScalar* GetCoordShiftPS(int index) {if ((index>=0) && (index<3)) return &dPosShift[index]; else return NULL;}
@@ -57,9 +58,11 @@ public:
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return dPosShift[0].GetRevision()+dPosShift[1].GetRevision()+dPosShift[2].GetRevision();}
 	std::string stFunction;
 	UserDefinedCoordSystem CoordSystem;
 	CSFunctionParser* fParse;
+	std::mutex m_ParserMutex;
 	std::string fParameter;
 	int iQtyParameter;
 	ParameterScalar dPosShift[3];
@@ -49,5 +49,6 @@ public:
 	virtual bool ReadFromXML(TiXmlNode &root);
 
 protected:
+	virtual unsigned int GetParameterRevision() const {return CSPrimCurve::GetParameterRevision()+wireRadius.GetRevision();}
 	ParameterScalar wireRadius;
 };
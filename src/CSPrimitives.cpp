@@ -18,6 +18,8 @@
 #include <sstream>
 #include <iostream>
 #include <limits>
+#include <cmath>
+#include <algorithm>
 #include "tinyxml.h"
 #include "stdint.h"
 
@@ -31,6 +33,9 @@
 
 #define PI acos(-1)
 
+// number of bisection steps to locate an interval end between two positions, see CSPrimitives::GetLineIntervals
+#define LINE_INTERVAL_BISECTION_STEPS 12
+
 int g_PrimUniqueIDCounter=0;
 
 void Point_Line_Distance(const double P[], const double start[], const double stop[], double &foot, double &dist, CoordinateSystem c_system)
@@ -75,6 +80,104 @@ bool CSXCAD_EXPORT CoordInRange(const double* coord, const double* start, const
 	return true;
 }
 
+bool Line_Sphere_Intersection(const double origin[], const double dir[], const double center[], double radius, double &t0, double &t1)
+{
+	double w[] = {origin[0]-center[0],origin[1]-center[1],origin[2]-center[2]};
+	double a = dir[0]*dir[0]+dir[1]*dir[1]+dir[2]*dir[2];
+	if (a==0)
+		return false;
+	double b = (w[0]*dir[0]+w[1]*dir[1]+w[2]*dir[2])/a;
+	double c = (w[0]*w[0]+w[1]*w[1]+w[2]*w[2]-radius*radius)/a;
+	double disc = b*b-c;
+	if (disc<0)
+		return false;
+	disc = sqrt(disc);
+	t0 = -b-disc;
+	t1 = -b+disc;
+	return true;
+}
+
+bool Line_Cylinder_Intersection(const double origin[], const double dir[], const double start[], const double stop[], double radius, double &t0, double &t1)
+{
+	double axis[] = {stop[0]-start[0],stop[1]-start[1],stop[2]-start[2]};
+	double w[] = {origin[0]-start[0],origin[1]-start[1],origin[2]-start[2]};
+	double LL = axis[0]*axis[0]+axis[1]*axis[1]+axis[2]*axis[2];
+	if (LL==0)
+		return false;
+
+	double t_min = -std::numeric_limits<double>::max();
+	double t_max = std::numeric_limits<double>::max();
+
+	// the normalized foot point s0+t*s1 has to be on the axis
+	double s0 = (w[0]*axis[0]+w[1]*axis[1]+w[2]*axis[2])/LL;
+	double s1 = (dir[0]*axis[0]+dir[1]*axis[1]+dir[2]*axis[2])/LL;
+	if (s1==0)
+	{
+		if ((s0<0) || (s0>1))
+			return false;
+	}
+	else
+	{
+		t_min = std::min(-s0/s1,(1-s0)/s1);
+		t_max = std::max(-s0/s1,(1-s0)/s1);
+	}
+
+	// the distance to the axis |w0+t*w1| has to be below the radius
+	double w0[3],w1[3];
+	for (int n=0;n<3;++n)
+	{
+		w0[n] = w[n]-s0*axis[n];
+		w1[n] = dir[n]-s1*axis[n];
+	}
+	double a = w1[0]*w1[0]+w1[1]*w1[1]+w1[2]*w1[2];
+	double b = w0[0]*w1[0]+w0[1]*w1[1]+w0[2]*w1[2];
+	double c = w0[0]*w0[0]+w0[1]*w0[1]+w0[2]*w0[2]-radius*radius;
+	if (a==0)
+	{
+		if (c>0)
+			return false;
+	}
+	else
+	{
+		double disc = b*b-a*c;
+		if (disc<0)
+			return false;
+		disc = sqrt(disc);
+		t_min = std::max(t_min,(-b-disc)/a);
+		t_max = std::min(t_max,(-b+disc)/a);
+	}
+
+	if (t_min>t_max)
+		return false;
+	t0 = t_min;
+	t1 = t_max;
+	return true;
+}
+
+bool Line_Box_Intersection(const double origin[], const double dir[], const double box[6], double &t0, double &t1)
+{
+	double t_min = -std::numeric_limits<double>::max();
+	double t_max = std::numeric_limits<double>::max();
+	for (int n=0;n<3;++n)
+	{
+		if (dir[n]==0)
+		{
+			if ((origin[n]<box[2*n]) || (origin[n]>box[2*n+1]))
+				return false;
+			continue;
+		}
+		double ta = (box[2*n]-origin[n])/dir[n];
+		double tb = (box[2*n+1]-origin[n])/dir[n];
+		t_min = std::max(t_min,std::min(ta,tb));
+		t_max = std::min(t_max,std::max(ta,tb));
+	}
+	if (t_min>t_max)
+		return false;
+	t0 = t_min;
+	t1 = t_max;
+	return true;
+}
+
 /*********************CSPrimitives********************************************************************/
 CSPrimitives::CSPrimitives(unsigned int ID, ParameterSet* paraSet, CSProperties* prop)
 {
@@ -123,6 +226,10 @@ void CSPrimitives::Init()
 	for (int n=0;n<6;++n)
 		m_BoundBox[n]=0;
 	m_BoundBoxValid = false;
+	m_UpdateRequired = true;
+	m_UpdateDependency = 0;
+	m_UpdateTransformRevision = 0;
+	m_UpdateParameterRevision = 0;
 }
 
 CSTransform* CSPrimitives::GetTransform()
@@ -168,6 +275,10 @@ int CSPrimitives::GetDimension()
 
 void CSPrimitives::Invalidate()
 {
+	// the property may have used the box of GetBoundBox() in the meantime
+	if (clProperty!=NULL)
+		clProperty->InvalidatePrimitivesBoundBox();
+	m_UpdateRequired = true;
 	if (m_Dimension<0)
 		return;
 	m_Dimension = -1;
@@ -176,6 +287,27 @@ void CSPrimitives::Invalidate()
 		m_BoundBox[n]=0;
 }
 
+bool CSPrimitives::UpdateDependent(unsigned int changedParameters, std::string *ErrStr)
+{
+	unsigned int transformRevision = m_Transform ? m_Transform->GetRevision() : 0;
+	if ((m_UpdateRequired==false) && (changedParameters!=~0u) && ((m_UpdateDependency & changedParameters)==0)
+			&& (transformRevision==m_UpdateTransformRevision) && (GetParameterRevision()==m_UpdateParameterRevision))
+		return true;
+
+	if (clParaSet!=NULL)
+		clParaSet->BeginDependencyRecord();
+	bool ok = Update(ErrStr);
+	m_UpdateDependency = 0;
+	if (clParaSet!=NULL)
+		m_UpdateDependency = clParaSet->EndDependencyRecord();
+	// Update() may invalidate itself, e.g. a polyhedron building its tree
+	m_UpdateRequired = !ok;
+	m_UpdateTransformRevision = transformRevision;
+	// after the update, as Update() sets e.g. the coordinate system of the coordinates
+	m_UpdateParameterRevision = GetParameterRevision();
+	return ok;
+}
+
 int CSPrimitives::IsInsideBox(const double *boundbox)
 {
 	if (m_BoundBoxValid==false)
@@ -198,6 +330,246 @@ int CSPrimitives::IsInsideBox(const double *boundbox)
 	return 1;
 }
 
+void CSPrimitives::GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	intervals.clear();
+	if ((ny<0) || (ny>2))
+		return;
+	double p[3] = {coord[0],coord[1],coord[2]};
+	bool inside = false;
+	for (size_t n=0;n<numPos;++n)
+	{
+		p[ny] = pos[n];
+		bool in = IsInside(p,tol);
+		if (in==inside)
+			continue;
+		if (n==0)
+		{
+			intervals.push_back(pos[0]);
+			inside = true;
+			continue;
+		}
+		// bisect between the last two positions, the inside bound of the bracket is the interval end
+		double a = pos[n-1];
+		double b = pos[n];
+		for (int i=0;i<LINE_INTERVAL_BISECTION_STEPS;++i)
+		{
+			p[ny] = 0.5*(a+b);
+			if (IsInside(p,tol)==inside)
+				a = p[ny];
+			else
+				b = p[ny];
+		}
+		intervals.push_back(in ? b : a);
+		inside = in;
+	}
+	if (inside)
+		intervals.push_back(pos[numPos-1]);
+}
+
+bool CSPrimitives::GetMeshEdges(std::vector<MeshEdge> &edges)
+{
+	size_t first = edges.size();
+	if (AddMeshEdges(edges)==false)
+	{
+		edges.resize(first);
+		return false;
+	}
+	if ((m_Transform==NULL) || (m_Transform->HasTransform()==false))
+		return true;
+	// only a cartesian mesh keeps its planes under a (linear) transformation
+	if (m_MeshType!=CARTESIAN)
+	{
+		edges.resize(first);
+		return false;
+	}
+	// the normal of the plane x[ny]=c is row ny of the inverse matrix
+	const double* inv = m_Transform->GetInverseMatrix();
+	size_t k = first;
+	for (size_t n=first;n<edges.size();++n)
+	{
+		const double* row = &inv[4*edges[n].ny];
+		int axis = 0;
+		for (int i=1;i<3;++i)
+			if (fabs(row[i])>fabs(row[axis]))
+				axis = i;
+		if ((fabs(row[(axis+1)%3])>1e-12*fabs(row[axis])) || (fabs(row[(axis+2)%3])>1e-12*fabs(row[axis])))
+			continue;
+		MeshEdge edge = edges[n];
+		edge.ny = axis;
+		m_Transform->Transform(edge.pos,edge.pos);
+		edges[k++] = edge;
+	}
+	edges.resize(k);
+	return true;
+}
+
+bool CSPrimitives::AddMeshEdges(std::vector<MeshEdge> &edges)
+{
+	double box[6];
+	if (GetBoundBox(box)==false)
+		return false;
+	if ((m_BoundBox_CoordSys!=m_MeshType) && (m_BoundBox_CoordSys!=UNDEFINED_CS))
+		return false;
+	// the face centers of the box
+	for (int n=0;n<3;++n)
+		for (int s=0;s<2;++s)
+		{
+			MeshEdge edge;
+			edge.ny = n;
+			for (int i=0;i<3;++i)
+				edge.pos[i] = 0.5*(box[2*i]+box[2*i+1]);
+			edge.pos[n] = box[2*n+s];
+			edges.push_back(edge);
+		}
+	return true;
+}
+
+bool CSPrimitives::GetCartesianLine(int ny, const double* coord, double origin[3], double dir[3]) const
+{
+	if ((ny<0) || (ny>2))
+		return false;
+	if ((m_MeshType!=CARTESIAN) && (m_MeshType!=CYLINDRICAL))
+		return false;
+	// the alpha-direction is a circle
+	if ((m_MeshType==CYLINDRICAL) && (ny==1))
+		return false;
+	double p0[3] = {coord[0],coord[1],coord[2]};
+	double p1[3] = {coord[0],coord[1],coord[2]};
+	p0[ny] = 0;
+	p1[ny] = 1;
+	TransformCoordSystem(p0,origin,m_MeshType,CARTESIAN);
+	TransformCoordSystem(p1,p1,m_MeshType,CARTESIAN);
+	if (m_Transform)
+	{
+		m_Transform->InvertTransform(origin,origin);
+		m_Transform->InvertTransform(p1,p1);
+	}
+	for (int n=0;n<3;++n)
+		dir[n] = p1[n]-origin[n];
+	return true;
+}
+
+bool CSPrimitives::IsInsideLine(double* coord, int ny, double pos, double tol)
+{
+	coord[ny] = pos;
+	return IsInside(coord,tol);
+}
+
+void CSPrimitives::FitLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol)
+{
+	std::vector<std::pair<double,double> > in;
+	for (size_t n=0;n+1<intervals.size();n+=2)
+		in.push_back(std::make_pair(std::min(intervals[n],intervals[n+1]),std::max(intervals[n],intervals[n+1])));
+	std::sort(in.begin(),in.end());
+	intervals.clear();
+
+	double p[3] = {coord[0],coord[1],coord[2]};
+	size_t covered = 0; // positions below this index belong to a previous interval
+	for (size_t i=0;i<in.size();++i)
+	{
+		double start = in[i].first;
+		double stop = in[i].second;
+		while ((i+1<in.size()) && (in[i+1].first<=stop))
+			stop = std::max(stop,in[++i].second);
+
+		// the positions [first,end) are inside of this interval
+		size_t first = std::lower_bound(pos,pos+numPos,start)-pos;
+		size_t end = std::upper_bound(pos,pos+numPos,stop)-pos;
+		size_t limit = numPos;
+		if (i+1<in.size())
+			limit = std::lower_bound(pos,pos+numPos,in[i+1].first)-pos;
+		if (first==end)
+		{
+			// no position to check, keep it as it is
+			intervals.push_back(start);
+			intervals.push_back(stop);
+			continue;
+		}
+
+		// grow the interval to neighbouring positions inside, or shrink it to the first and last position inside
+		size_t f = first;
+		size_t e = end;
+		while ((f>covered) && IsInsideLine(p,ny,pos[f-1],tol))
+			--f;
+		while ((e<limit) && IsInsideLine(p,ny,pos[e],tol))
+			++e;
+		if (f==first)
+			while ((f<e) && (IsInsideLine(p,ny,pos[f],tol)==false))
+				++f;
+		if (e==end)
+			while ((e>f) && (IsInsideLine(p,ny,pos[e-1],tol)==false))
+				--e;
+		if (f==e)
+			continue;
+		intervals.push_back(f==first ? start : pos[f]);
+		intervals.push_back(e==end ? stop : pos[e-1]);
+		covered = e;
+	}
+}
+
+bool CSPrimitives::GetConservativeBoundBox(double dBoundBox[6])
+{
+	if (m_BoundBoxValid==false)
+		return false;
+	return BoundBox2Cartesian(m_BoundBox, dBoundBox);
+}
+
+bool CSPrimitives::GetCachedBoundBox(double dBoundBox[6])
+{
+	if (m_BoundBoxValid==false)
+		return GetBoundBox(dBoundBox);
+	for (int n=0;n<6;++n)
+		dBoundBox[n] = m_BoundBox[n];
+	return true;
+}
+
+bool CSPrimitives::BoundBox2Cartesian(const double inBox[6], double outBox[6]) const
+{
+	CoordinateSystem cs = m_BoundBox_CoordSys;
+	if (cs==UNDEFINED_CS)
+		cs = m_MeshType;
+	for (int n=0;n<6;++n)
+		outBox[n] = inBox[n];
+	if (cs==CYLINDRICAL)
+	{
+		// any angle may be covered, use the enclosing square of the outer radius
+		double rad = std::max(fabs(inBox[0]),fabs(inBox[1]));
+		outBox[0] = outBox[2] = -rad;
+		outBox[1] = outBox[3] = rad;
+	}
+	for (int n=0;n<3;++n)
+		if (outBox[2*n]>outBox[2*n+1])
+			std::swap(outBox[2*n],outBox[2*n+1]);
+
+	if ((m_Transform!=NULL) && m_Transform->HasTransform())
+	{
+		// an affine transformation, the box of all transformed corners contains the transformed box
+		double corner[3];
+		double box[6];
+		for (int c=0;c<8;++c)
+		{
+			for (int n=0;n<3;++n)
+				corner[n] = outBox[2*n+((c>>n)&1)];
+			m_Transform->Transform(corner,corner);
+			for (int n=0;n<3;++n)
+			{
+				if ((c==0) || (corner[n]<box[2*n]))
+					box[2*n] = corner[n];
+				if ((c==0) || (corner[n]>box[2*n+1]))
+					box[2*n+1] = corner[n];
+			}
+		}
+		for (int n=0;n<6;++n)
+			outBox[n] = box[n];
+	}
+
+	for (int n=0;n<6;++n)
+		if (std::isfinite(outBox[n])==false)
+			return false;
+	return true;
+}
+
 bool CSPrimitives::Write2XML(TiXmlElement &elem, bool /*parameterised*/)
 {
 	elem.SetAttribute("Priority",iPriority);
@@ -245,7 +617,8 @@ void CSPrimitives::ShowPrimitiveStatus(std::ostream& stream)
 
 void CSPrimitives::TransformCoords(double* Coord, bool invers, CoordinateSystem cs_in) const
 {
-	if (m_Transform==NULL)
+	// an empty transformation is skipped, the conversion to Cartesian and back would change e.g. the angle range
+	if (HasTransform()==false)
 		return;
 	// transform to Cartesian for transformation
 	TransformCoordSystem(Coord,Coord,cs_in,CARTESIAN);
@@ -63,6 +63,25 @@ void CSXCAD_EXPORT Point_Line_Distance(const double P[], const double start[], c
 
 bool CSXCAD_EXPORT CoordInRange(const double* p, const double* start, const double* stop, CoordinateSystem cs_in);
 
+/*!
+	Calculate the intersection of the line origin+t*dir with a (solid) sphere.
+	Returns false if the line misses the sphere, otherwise t0<=t1 are the line parameter where the line enters and leaves the sphere.
+*/
+bool CSXCAD_EXPORT Line_Sphere_Intersection(const double origin[], const double dir[], const double center[], double radius, double &t0, double &t1);
+
+/*!
+	Calculate the intersection of the line origin+t*dir with a (solid) cylinder, defined by its axis start/stop coordinates and its radius.
+	Returns false if the line misses the cylinder, otherwise t0<=t1 are the line parameter where the line enters and leaves the cylinder.
+	A cylinder of zero length is never hit.
+*/
+bool CSXCAD_EXPORT Line_Cylinder_Intersection(const double origin[], const double dir[], const double start[], const double stop[], double radius, double &t0, double &t1);
+
+/*!
+	Calculate the intersection of the line origin+t*dir with an axis-aligned box (xmin,xmax,ymin,ymax,zmin,zmax).
+	Returns false if the line misses the box, otherwise t0<=t1 are the line parameter where the line enters and leaves the box.
+*/
+bool CSXCAD_EXPORT Line_Box_Intersection(const double origin[], const double dir[], const double box[6], double &t0, double &t1);
+
 //! Abstract base class for different geometrical primitives.
 /*!
  This is an abstract base class for different geometrical primitives like boxes, spheres, cylinders etc.
@@ -110,12 +129,55 @@ public:
 
 	virtual CoordinateSystem GetBoundBoxCoordSystem() const {return m_BoundBox_CoordSys;}
 
+	//! Get a cartesian bounding box, including the transformation, that contains every coordinate this primitive can be inside of.
+	/*!
+	 The box is based on the internal bounding box and thus only valid after Update(). It may be (much) larger than the primitive.
+	 \return false if no such box is known, the primitive has to be assumed to be unbounded in this case.
+	 \sa IsInside
+	 */
+	virtual bool GetConservativeBoundBox(double dBoundBox[6]);
+
+	//! Get the bounding box as found by the last Update(), GetBoundBox() is only called if the primitive was modified since. \sa GetBoundBox
+	bool GetCachedBoundBox(double dBoundBox[6]);
+	//! Check if the bounding box cached by the last Update() is accurate and still valid. \sa GetCachedBoundBox
+	bool IsBoundBoxCached() const {return m_BoundBoxValid;}
+
 	//! Get the dimension of this primitive
 	virtual int GetDimension();
 
 	//! Check if given Coordinate (in the given mesh type) is inside the Primitive.
 	virtual bool IsInside(const double* Coord, double tol=0) {UNUSED(Coord);UNUSED(tol);return false;}
 
+	//! Get the intervals in which an axis-aligned line is inside this primitive.
+	/*!
+	 The line runs in direction \a ny of the mesh coordinate system through \a coord. The result is exact at the given
+	 positions along the line: a position is inside one of the intervals if and only if IsInside() is true for it.
+	 The default implementation evaluates IsInside() at all positions and locates the interval ends between two positions by bisection.
+	 Most primitives calculate the intervals analytically and fall back to this implementation for lines they are not aligned with.
+	 \param ny Direction of the line
+	 \param coord A coordinate on the line (in the mesh coordinate system), component \a ny is ignored
+	 \param pos Sorted positions along the line
+	 \param numPos Number of positions
+	 \param intervals Filled with sorted, disjoint, closed intervals as start/stop pairs (start1,stop1,start2,stop2,...)
+	 \param tol Tolerance, see IsInside()
+	 */
+	virtual void GetLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol=0);
+
+	//! A plane of constant coordinate in direction ny a mesh should have a line at, through the point pos (in the mesh coordinate system) on an edge or face of the primitive. \sa GetMeshEdges
+	struct MeshEdge
+	{
+		int ny;
+		double pos[3];
+	};
+	//! Get the edges of this primitive a mesh should have lines at, e.g. the vertices of a polygon or the axis parallel edges of a polyhedron.
+	/*!
+	 The point of an edge allows to find the side of the edge the primitive is on, e.g. for the thirds rule at metal edges.
+	 The transformation is applied, edges not parallel to a mesh plane afterwards are dropped.
+	 \param edges The edges found are appended.
+	 \return false if no edges are known for this primitive.
+	 */
+	bool GetMeshEdges(std::vector<MeshEdge> &edges);
+
 	//! Check if the primitive is inside a given box (box must be specified in the bounding box coordinate system)
 	//! @return -1 if not, +1 if it is, 0 if unknown
 	virtual int IsInsideBox(const double*  boundbox);
@@ -132,6 +194,14 @@ public:
 
 	//! Update this primitive with respect to the parameters set.
 	virtual bool Update(std::string *ErrStr=NULL) {UNUSED(ErrStr);return true;}
+	//! Update this primitive only if it was modified or depends on one of the changed parameters. \sa Update
+	/*!
+	 The parameters used by an update are recorded with its parameter set, a failed update is repeated in any case.
+	 A primitive is modified by its setters, by a modified transformation and by a modified ParameterScalar, e.g. one of GetCoordPS(). \sa GetParameterRevision
+	 \param changedParameters Parameters changed since the last update, bit n is set for the n-th parameter of the parameter set, all bits set to update in any case. \sa ParameterScalar::GetDependency
+	 \return The result of Update() or true if the update was skipped
+	 */
+	bool UpdateDependent(unsigned int changedParameters, std::string *ErrStr=NULL);
 	//! Write this primitive to a XML-node.
 	virtual bool Write2XML(TiXmlElement &elem, bool parameterised=true);
 	//! Read this primitive from a XML-node.
@@ -174,12 +244,12 @@ public:
 	bool operator!=(CSPrimitives& vgl) { return iPriority!=vgl.GetPriority();}
 
 	//! Define the input type for the weighting coordinate system 0=cartesian, 1=cylindrical, 2=spherical
-	void SetCoordInputType(CoordinateSystem type, bool doUpdate=true) {m_MeshType=type; if (doUpdate) Update();}
+	void SetCoordInputType(CoordinateSystem type, bool doUpdate=true) {if (m_MeshType!=type) Invalidate(); m_MeshType=type; if (doUpdate) Update();}
 	//! Get the input type for the weighting coordinate system 0=cartesian, 1=cylindrical, 2=spherical
 	CoordinateSystem GetCoordInputType() const {return m_MeshType;}
 
 	//! Define the coordinate system this primitive is defined in (may be different to the input mesh type) \sa SetCoordInputType
-	void SetCoordinateSystem(CoordinateSystem cs) {m_PrimCoordSystem=cs;}
+	void SetCoordinateSystem(CoordinateSystem cs) {if (m_PrimCoordSystem!=cs) Invalidate(); m_PrimCoordSystem=cs;}
 	//! Read the coordinate system for this primitive (may be different to the input mesh type) \sa GetCoordInputType
 	CoordinateSystem GetCoordinateSystem() const {return m_PrimCoordSystem;}
 
@@ -200,9 +270,34 @@ protected:
 	//! Invalidate some cached data, e.g. object dimension and bounding box, should be called when data is modified
 	virtual void Invalidate();
 
+	//! Get the sum of the modification revisions of all ParameterScalar and ParameterCoord of this primitive, see UpdateDependent. \sa ParameterScalar::GetRevision
+	virtual unsigned int GetParameterRevision() const {return 0;}
+
+	//! Append the edges of this primitive without the transformation. The default implementation adds the six planes of an accurate bounding box. \sa GetMeshEdges
+	virtual bool AddMeshEdges(std::vector<MeshEdge> &edges);
+
 	//! Apply (invers) transformation to the given coordinate in the given coordinate system
 	void TransformCoords(double* Coord, bool invers, CoordinateSystem cs_in) const;
 
+	//! Convert a box in the bounding box coordinate system into a cartesian box and apply the transformation. \sa GetConservativeBoundBox
+	bool BoundBox2Cartesian(const double inBox[6], double outBox[6]) const;
+
+	//! Get the line of GetLineIntervals() as cartesian line origin+t*dir in the frame of the primitive, i.e. with the inverse transformation applied.
+	/*!
+	 The line parameter t is the mesh coordinate in direction \a ny. Returns false for a line that is not straight in cartesian coordinates (alpha-direction of a cylindrical mesh).
+	 */
+	bool GetCartesianLine(int ny, const double* coord, double origin[3], double dir[3]) const;
+
+	//! Make (analytically calculated) line intervals exact at the given positions. \sa GetLineIntervals
+	/*!
+	 Each interval end is moved to the neighbouring positions as long as IsInside() disagrees with the interval, intervals left without any position inside are kept as they are.
+	 This can only correct the ends of an interval, all positions well inside an interval are assumed to be inside the primitive.
+	 \param intervals Start/stop pairs, will be sorted and merged.
+	 */
+	void FitLineIntervals(int ny, const double* coord, const double* pos, size_t numPos, std::vector<double> &intervals, double tol);
+	//! Set component \a ny of \a coord to \a pos and check it with IsInside()
+	bool IsInsideLine(double* coord, int ny, double pos, double tol);
+
 	unsigned int uiID;
 	int iPriority;
 	CoordinateSystem m_PrimCoordSystem;
@@ -220,6 +315,15 @@ protected:
 	CoordinateSystem m_BoundBox_CoordSys;
 
 	int m_Dimension;
+
+	//! set by Invalidate() until the next successful update \sa UpdateDependent
+	bool m_UpdateRequired;
+	//! parameters used by the last update \sa UpdateDependent
+	unsigned int m_UpdateDependency;
+	//! revision of the transformation at the last update, 0 without a transformation \sa CSTransform::GetRevision
+	unsigned int m_UpdateTransformRevision;
+	//! revision of the scalar parameters at the last update \sa GetParameterRevision
+	unsigned int m_UpdateParameterRevision;
 };
 
 
@@ -153,6 +153,9 @@ bool CSPropDebyeMaterial::Update(std::string *ErrStr)
 				ErrStr->append(stream.str());
 				PSErrorCode2Msg(EC,ErrStr);
 			}
+
+			WeightEpsDelta[o][n].AnalyzeDependency();
+			WeightEpsRelaxTime[o][n].AnalyzeDependency();
 		}
 	}
 	return bOK & CSPropDispersiveMaterial::Update(ErrStr);
@@ -54,6 +54,8 @@ public:
 	const std::string GetEpsDeltaWeightFunction(int order, int ny) {return GetTerm3(WeightEpsDelta,order,ny);}
 	//! Get the epsilon plasma frequency weighting
 	double GetEpsDeltaWeighted(int order, int ny, const double* coords) {return GetWeight3(WeightEpsDelta,order,ny,coords)*GetEpsDelta(order,ny);}
+	//! Get the epsilon plasma frequency weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetEpsDeltaWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightEpsDelta,order,ny,numCoords,coords,values,GetEpsDelta(order,ny));}
 
 	//! Set the epsilon relaxation time
 	void SetEpsRelaxTime(int order, double val, int ny=0) {SetValue3(val,EpsRelaxTime,order,ny);}
@@ -70,6 +72,8 @@ public:
 	const std::string GetEpsRelaxTimeWeightFunction(int order, int ny) {return GetTerm3(WeightEpsRelaxTime,order,ny);}
 	//! Get the epsilon relaxation time weighting
 	double GetEpsRelaxTimeWeighted(int order, int ny, const double* coords) {return GetWeight3(WeightEpsRelaxTime,order,ny,coords)*GetEpsRelaxTime(order,ny);}
+	//! Get the epsilon relaxation time weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetEpsRelaxTimeWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightEpsRelaxTime,order,ny,numCoords,coords,values,GetEpsRelaxTime(order,ny));}
 
 	virtual bool Update(std::string *ErrStr=NULL);
 
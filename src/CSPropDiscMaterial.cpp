@@ -15,6 +15,12 @@
 *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
 #include "tinyxml.h"
 #include <hdf5.h>
 #include <hdf5_hl.h>
@@ -22,32 +28,26 @@
 #include "vtkPolyData.h"
 #include "vtkCellArray.h"
 #include "vtkPoints.h"
+#include "vtkCellData.h"
+#include "vtkUnsignedIntArray.h"
 
 #include "ParameterCoord.h"
 #include "CSPropDiscMaterial.h"
+#include "CSFileCache.h"
 
 namespace {
-void* ReadDataSet(std::string filename, std::string d_name, hid_t type_id, int &rank, unsigned int &size, bool debug=false)
+// Read a complete dataset of an open file, returns a new array of the given type or NULL on an error
+void* ReadDataSet(hid_t file_id, std::string d_name, hid_t type_id, int &rank, unsigned int &size, bool debug=false)
 {
 	herr_t status;
 	H5T_class_t class_id;
 	size_t type_size;
 	rank = -1;
 
-	hid_t file_id = H5Fopen( filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
-	if (file_id < 0)
-	{
-		if (debug)
-			std::cerr << __func__ << ": Failed to open file, skipping..." << std::endl;
-		H5Fclose(file_id);
-		return NULL;
-	}
-
 	if (H5Lexists(file_id, d_name.c_str(), H5P_DEFAULT)<=0)
 	{
 		if (debug)
 			std::cerr << __func__ << ": Warning, dataset: \"" << d_name << "\" not found... skipping" << std::endl;
-		H5Fclose(file_id);
 		return NULL;
 	}
 
@@ -56,7 +56,6 @@ void* ReadDataSet(std::string filename, std::string d_name, hid_t type_id, int &
 	{
 		if (debug)
 			std::cerr << __func__ << ": Warning, failed to read dimension for dataset: \"" << d_name << "\" skipping..." << std::endl;
-		H5Fclose(file_id);
 		return NULL;
 	}
 
@@ -67,7 +66,6 @@ void* ReadDataSet(std::string filename, std::string d_name, hid_t type_id, int &
 		if (debug)
 			std::cerr << __func__ << ": Warning, failed to read dataset info: \"" << d_name << "\" skipping..." << std::endl;
 		delete[] dims;
-		H5Fclose(file_id);
 		return NULL;
 	}
 
@@ -86,7 +84,6 @@ void* ReadDataSet(std::string filename, std::string d_name, hid_t type_id, int &
 	else
 	{
 		std::cerr << __func__ << ": Error, unknown data type" << std::endl;
-		H5Fclose(file_id);
 		return NULL;
 	}
 
@@ -101,13 +98,66 @@ void* ReadDataSet(std::string filename, std::string d_name, hid_t type_id, int &
 			delete[] (int*)data;
 		else if (type_id==H5T_NATIVE_UINT8)
 			delete[] (uint8*)data;
-		H5Fclose(file_id);
 		return NULL;
 	}
 
-	H5Fclose(file_id);
 	return data;
 }
+
+// Read the part [start, start+count) of the open index volume "/DiscData" of the given size.
+// Only the chunks of a chunked dataset intersecting this part are read and decompressed.
+// The index is stored with 1, 2 or 4 bytes per voxel, the smallest size holding the integer type of the dataset.
+bool ReadIndexVolume(hid_t dataset, const hsize_t size[3], const hsize_t start[3], const hsize_t count[3], std::vector<uint8>& index, unsigned int& bytes)
+{
+	hid_t type = H5Dget_type(dataset);
+	bool ok = (H5Tget_class(type)==H5T_INTEGER);
+	size_t type_size = H5Tget_size(type);
+	H5Tclose(type);
+	hid_t mem_type = H5T_NATIVE_UINT8;
+	bytes = 1;
+	if (type_size==2)
+	{
+		mem_type = H5T_NATIVE_UINT16;
+		bytes = 2;
+	}
+	else if (type_size>2)
+	{
+		mem_type = H5T_NATIVE_UINT32;
+		bytes = 4;
+	}
+
+	hid_t filespace = H5Dget_space(dataset);
+	hsize_t dims[3];
+	ok &= (H5Sget_simple_extent_ndims(filespace)==3);
+	if (ok)
+	{
+		H5Sget_simple_extent_dims(filespace, dims, NULL);
+		for (int n=0;n<3;++n)
+			ok &= (dims[n]==size[n]) && (start[n]+count[n]<=size[n]);
+	}
+	if (ok)
+	{
+		index.resize(count[0]*count[1]*count[2]*bytes);
+		hid_t memspace = H5Screate_simple(3, count, NULL);
+		ok = (H5Sselect_hyperslab(filespace, H5S_SELECT_SET, start, NULL, count, NULL)>=0);
+		ok = ok && (H5Dread(dataset, mem_type, memspace, filespace, H5P_DEFAULT, index.data())>=0);
+		H5Sclose(memspace);
+	}
+	H5Sclose(filespace);
+	return ok;
+}
+
+// Closes an HDF5 object on every return
+class H5Object
+{
+public:
+	H5Object(hid_t id, herr_t (*close)(hid_t)) : m_ID(id), m_Close(close) {}
+	~H5Object() {if (m_ID>=0) m_Close(m_ID);}
+	hid_t Get() const {return m_ID;}
+protected:
+	hid_t m_ID;
+	herr_t (*m_Close)(hid_t);
+};
 } // namespace
 
 CSPropDiscMaterial::CSPropDiscMaterial(ParameterSet* paraSet) : CSPropMaterial(paraSet)
@@ -124,12 +174,15 @@ CSPropDiscMaterial::CSPropDiscMaterial(CSPropDiscMaterial* prop, bool copyPrim)
 	m_FileType = prop->m_FileType;
 	m_DB_Background = prop->m_DB_Background;
 	m_Scale = prop->m_Scale;
+	m_UseROI = prop->m_UseROI;
+	for (int n=0;n<6;++n)
+		m_ROI[n] = prop->m_ROI[n];
 	if (prop->m_Transform)
 	{
 		m_Transform = CSTransform::New(prop->m_Transform);
 		if (m_Transform) m_Transform->SetOwner(this);
 	}
-	//Copy does not read the data!!
+	//Copy does not read the data!! Once read, the data of the same file is shared (see CSFileCache)
 }
 
 CSPropDiscMaterial::CSPropDiscMaterial(unsigned int ID, ParameterSet* paraSet) : CSPropMaterial(ID, paraSet)
@@ -140,24 +193,6 @@ CSPropDiscMaterial::CSPropDiscMaterial(unsigned int ID, ParameterSet* paraSet) :
 
 CSPropDiscMaterial::~CSPropDiscMaterial()
 {
-	for (int n=0;n<3;++n)
-	{
-		delete[] m_mesh[n];
-		m_mesh[n]=NULL;
-	}
-	delete[] m_Disc_Ind;
-	m_Disc_Ind=NULL;
-	delete[] m_Disc_epsR;
-	m_Disc_epsR=NULL;
-	delete[] m_Disc_kappa;
-	m_Disc_kappa=NULL;
-	delete[] m_Disc_mueR;
-	m_Disc_mueR=NULL;
-	delete[] m_Disc_sigma;
-	m_Disc_sigma=NULL;
-	delete[] m_Disc_Density;
-	m_Disc_Density=NULL;
-
 	delete m_Transform;
 	m_Transform=NULL;
 }
@@ -171,25 +206,41 @@ unsigned int CSPropDiscMaterial::GetWeightingPos(const double* inCoords)
 	for (int n=0;n<3;++n)
 		coords[n]/=m_Scale;
 	unsigned int pos[3];
-	if (!(m_mesh[0] && m_mesh[1] && m_mesh[2]))
+	const DiscData* data = m_Data.get();
+	if (data==NULL)
 		return -1;
 	for (int n=0;n<3;++n)
 	{
-		if (coords[n]<m_mesh[n][0])
-			return -1;
-		if (coords[n]>m_mesh[n][m_Size[n]-1])
+		pos[n] = FindCell(m_mesh[n], m_Size[n], data->uniform[n], data->invDelta[n], coords[n]);
+		if (pos[n]==(unsigned int)-1)
 			return -1;
-		pos[n]=0;
-		for (unsigned int i=1;i<m_Size[n];++i)
+	}
+	return pos[0] + pos[1]*(m_Size[0]-1) + pos[2]*(m_Size[0]-1)*(m_Size[1]-1);
+}
+
+unsigned int CSPropDiscMaterial::FindCell(const float* mesh, unsigned int size, bool uniform, double invDelta, double coord)
+{
+	if ((coord<mesh[0]) || (coord>mesh[size-1]))
+		return -1;
+	// the cell [mesh[i], mesh[i+1]) containing coord, the last cell includes the upper mesh line
+	const unsigned int last = size-2;
+	if (uniform)
+	{
+		unsigned int i = (unsigned int)std::min((double)last, std::floor((coord-mesh[0])*invDelta));
+		// correct for the rounding of the float mesh, at most a step or two
+		for (int steps=0;steps<4;++steps)
 		{
-			if (coords[n]<m_mesh[n][i])
-			{
-				pos[n]=i-1;
-				break;
-			}
+			if ((i>0) && (coord<mesh[i]))
+				--i;
+			else if ((i<last) && (coord>=mesh[i+1]))
+				++i;
+			else
+				return i;
 		}
 	}
-	return pos[0] + pos[1]*(m_Size[0]-1) + pos[2]*(m_Size[0]-1)*(m_Size[1]-1);
+	// compare in double, the same way as above
+	unsigned int i = std::upper_bound(mesh, mesh+size, coord, [](double c, float m) {return c<m;}) - mesh;
+	return std::min(i-1, last);
 }
 
 int CSPropDiscMaterial::GetDBPos(const double* coords)
@@ -199,11 +250,16 @@ int CSPropDiscMaterial::GetDBPos(const double* coords)
 	unsigned int pos = GetWeightingPos(coords);
 	if (pos==(unsigned int)-1)
 		return -1;
+	return GetDBPosOfCell(pos);
+}
+
+int CSPropDiscMaterial::GetDBPosOfCell(unsigned int pos)
+{
 	// material with index 0 is assumed to be background material
-	if ((m_DB_Background==false) && (m_Disc_Ind[pos]==0))
+	unsigned int db_pos = GetIndex(pos);
+	if ((m_DB_Background==false) && (db_pos==0))
 			return -1;
-	int db_pos = (int)m_Disc_Ind[pos];
-	if (db_pos>=(int)m_DB_size)
+	if (db_pos>=m_DB_size)
 	{
 		//sanity check, this should not happen!!!
 		std::cerr << __func__ << ": Error, false DB position!" << std::endl;
@@ -267,29 +323,170 @@ double CSPropDiscMaterial::GetDensityWeighted(const double* inCoords)
 	return m_Disc_Density[pos];
 }
 
+void CSPropDiscMaterial::GetEpsilonWeighted(int ny, size_t numCoords, const double* coords, double* values)
+{
+	for (size_t n=0;n<numCoords;++n)
+		values[n] = GetEpsilonWeighted(ny,&coords[3*n]);
+}
+
+void CSPropDiscMaterial::GetMueWeighted(int ny, size_t numCoords, const double* coords, double* values)
+{
+	for (size_t n=0;n<numCoords;++n)
+		values[n] = GetMueWeighted(ny,&coords[3*n]);
+}
+
+void CSPropDiscMaterial::GetKappaWeighted(int ny, size_t numCoords, const double* coords, double* values)
+{
+	for (size_t n=0;n<numCoords;++n)
+		values[n] = GetKappaWeighted(ny,&coords[3*n]);
+}
+
+void CSPropDiscMaterial::GetSigmaWeighted(int ny, size_t numCoords, const double* coords, double* values)
+{
+	for (size_t n=0;n<numCoords;++n)
+		values[n] = GetSigmaWeighted(ny,&coords[3*n]);
+}
+
+void CSPropDiscMaterial::GetDensityWeighted(size_t numCoords, const double* coords, double* values)
+{
+	for (size_t n=0;n<numCoords;++n)
+		values[n] = GetDensityWeighted(&coords[3*n]);
+}
+
+bool CSPropDiscMaterial::GetAxisMapping(double scale[3], double offset[3]) const
+{
+	if (coordInputType==CYLINDRICAL)
+		return false;
+	for (int n=0;n<3;++n)
+	{
+		scale[n] = 1;
+		offset[n] = 0;
+	}
+	if (m_Transform==NULL)
+		return true;
+	const double* inv = m_Transform->GetInverseMatrix();
+	for (int n=0;n<3;++n)
+	{
+		for (int m=0;m<3;++m)
+			if ((m!=n) && (inv[4*n+m]!=0))
+				return false;
+		scale[n] = inv[5*n];
+		offset[n] = inv[4*n+3];
+	}
+	return true;
+}
+
+void CSPropDiscMaterial::GetWeightedVolume(int ny, const std::vector<double> lines[3], std::vector<double>& epsilon, std::vector<double>& mue,
+										   std::vector<double>& kappa, std::vector<double>& sigma, std::vector<double>& density)
+{
+	EnsureFileLoaded();
+	const size_t num = lines[0].size()*lines[1].size()*lines[2].size();
+	std::vector<double>* values[5] = {&epsilon,&mue,&kappa,&sigma,&density};
+	for (int m=0;m<5;++m)
+		values[m]->resize(num);
+	if (num==0)
+		return;
+
+	std::vector<double> coords(3*num);
+	for (size_t i=0;i<lines[0].size();++i)
+		for (size_t j=0;j<lines[1].size();++j)
+			for (size_t k=0;k<lines[2].size();++k)
+			{
+				double* coord = &coords[3*((i*lines[1].size()+j)*lines[2].size()+k)];
+				coord[0] = lines[0][i];
+				coord[1] = lines[1][j];
+				coord[2] = lines[2][k];
+			}
+
+	// the database position of all points, -1 for the continuous material
+	std::vector<int> db_pos(num,-1);
+	double scale[3], offset[3];
+	const DiscData* data = m_Data.get();
+	if (data && m_Disc_Ind && GetAxisMapping(scale,offset))
+	{
+		// the voxel mesh is aligned with the lines, find the voxel of each line once
+		std::vector<unsigned int> cells[3];
+		for (int n=0;n<3;++n)
+		{
+			cells[n].resize(lines[n].size());
+			for (size_t l=0;l<lines[n].size();++l)
+				cells[n][l] = FindCell(m_mesh[n], m_Size[n], data->uniform[n], data->invDelta[n], (scale[n]*lines[n][l]+offset[n])/m_Scale);
+		}
+		const unsigned int stride[3] = {1, m_Size[0]-1, (m_Size[0]-1)*(m_Size[1]-1)};
+		size_t n = 0;
+		for (size_t i=0;i<lines[0].size();++i)
+			for (size_t j=0;j<lines[1].size();++j)
+				for (size_t k=0;k<lines[2].size();++k,++n)
+				{
+					if ((cells[0][i]==(unsigned int)-1) || (cells[1][j]==(unsigned int)-1) || (cells[2][k]==(unsigned int)-1))
+						continue;
+					db_pos[n] = GetDBPosOfCell(cells[0][i]*stride[0] + cells[1][j]*stride[1] + cells[2][k]*stride[2]);
+				}
+	}
+	else
+	{
+		for (size_t n=0;n<num;++n)
+			db_pos[n] = GetDBPos(&coords[3*n]);
+	}
+
+	// gather the database values, evaluate the continuous material for all other points at once
+	const float* db_values[5] = {m_Disc_epsR, m_Disc_mueR, m_Disc_kappa, m_Disc_sigma, m_Disc_Density};
+	for (int m=0;m<5;++m)
+	{
+		std::vector<double>& val = *values[m];
+		std::vector<size_t> rest;
+		for (size_t n=0;n<num;++n)
+		{
+			if (db_values[m] && (db_pos[n]>=0))
+				val[n] = db_values[m][db_pos[n]];
+			else
+				rest.push_back(n);
+		}
+		if (rest.empty())
+			continue;
+		std::vector<double> restCoords(3*rest.size()), restValues(rest.size());
+		for (size_t r=0;r<rest.size();++r)
+			for (int c=0;c<3;++c)
+				restCoords[3*r+c] = coords[3*rest[r]+c];
+		switch (m)
+		{
+		case 0:
+			CSPropMaterial::GetEpsilonWeighted(ny, rest.size(), &restCoords[0], &restValues[0]);
+			break;
+		case 1:
+			CSPropMaterial::GetMueWeighted(ny, rest.size(), &restCoords[0], &restValues[0]);
+			break;
+		case 2:
+			CSPropMaterial::GetKappaWeighted(ny, rest.size(), &restCoords[0], &restValues[0]);
+			break;
+		case 3:
+			CSPropMaterial::GetSigmaWeighted(ny, rest.size(), &restCoords[0], &restValues[0]);
+			break;
+		default:
+			CSPropMaterial::GetDensityWeighted(rest.size(), &restCoords[0], &restValues[0]);
+			break;
+		}
+		for (size_t r=0;r<rest.size();++r)
+			val[rest[r]] = restValues[r];
+	}
+}
+
 void CSPropDiscMaterial::Init()
 {
 	m_Filename.clear();
 	m_FileType=-1;
 
-	m_DB_size = 0;
 	m_DB_Background = true;
 
-	for (int n=0;n<3;++n)
-	{
-		m_mesh[n]=NULL;
-		m_Size[n]=0;
-	}
-	m_Disc_Ind=NULL;
-	m_Disc_epsR=NULL;
-	m_Disc_kappa=NULL;
-	m_Disc_mueR=NULL;
-	m_Disc_sigma=NULL;
-	m_Disc_Density=NULL;
+	m_Data.reset();
+	SetDataViews();
 
 	m_Scale=1;
 	m_FileRead=false;
 	m_Transform=NULL;
+	m_UseROI=false;
+	for (int n=0;n<6;++n)
+		m_ROI[n]=0;
 
 	CSPropMaterial::Init();
 }
@@ -303,6 +500,33 @@ void CSPropDiscMaterial::SetTransform(CSTransform* transform)
 	if (m_Transform) m_Transform->SetOwner(this);
 }
 
+void CSPropDiscMaterial::SetRegionOfInterest(const double bounds[6])
+{
+	for (int n=0;n<6;++n)
+		m_ROI[n] = bounds[n];
+	m_UseROI = true;
+	m_FileRead = false;
+}
+
+void CSPropDiscMaterial::GetVoxelRegion(double roi[6]) const
+{
+	// the bounds of all corners of the region in voxel mesh coordinates
+	for (int c=0;c<8;++c)
+	{
+		double coords[3] = {m_ROI[c&1], m_ROI[2+((c>>1)&1)], m_ROI[4+((c>>2)&1)]};
+		if (m_Transform)
+			m_Transform->InvertTransform(coords,coords);
+		for (int n=0;n<3;++n)
+		{
+			coords[n]/=m_Scale;
+			if ((c==0) || (coords[n]<roi[2*n]))
+				roi[2*n] = coords[n];
+			if ((c==0) || (coords[n]>roi[2*n+1]))
+				roi[2*n+1] = coords[n];
+		}
+	}
+}
+
 bool CSPropDiscMaterial::Write2XML(TiXmlNode& root, bool parameterised, bool sparse)
 {
 	if (CSPropMaterial::Write2XML(root,parameterised,sparse) == false) return false;
@@ -391,10 +615,34 @@ bool CSPropDiscMaterial::ReadFile()
 bool CSPropDiscMaterial::ReadHDF5( std::string filename )
 {
 	m_Filename = filename;
+	if (m_UseROI)
+	{
+		// each region of interest is a separate entry of the cache
+		double roi[6];
+		GetVoxelRegion(roi);
+		std::stringstream variant;
+		variant.precision(17);
+		for (int n=0;n<6;++n)
+			variant << roi[n] << ",";
+		m_Data = CSFileCache::Load<DiscData>(filename, [&roi](const std::string& fn, DiscData& data) {return ReadHDF5Data(fn,data,roi);}, variant.str());
+	}
+	else
+		m_Data = CSFileCache::Load<DiscData>(filename, [](const std::string& fn, DiscData& data) {return ReadHDF5Data(fn,data);});
+	SetDataViews();
+	return (m_Data.get()!=NULL);
+}
+
+bool CSPropDiscMaterial::ReadHDF5Data(const std::string& filename, DiscData& data, const double* roi)
+{
 	std::cout << __func__ << ": Reading \"" << filename << "\"" << std::endl;
 
-	// open hdf5 file
-	hid_t file_id = H5Fopen( filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+	// open hdf5 file, once for everything read from it
+	// a larger sieve buffer combines the reads of the rows of a region of interest, fewer requests on a network file system
+	hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+	H5Pset_sieve_buf_size(fapl, 4*1024*1024);
+	H5Object file(H5Fopen( filename.c_str(), H5F_ACC_RDONLY, fapl ), H5Fclose);
+	H5Pclose(fapl);
+	hid_t file_id = file.Get();
 	if (file_id < 0)
 	{
 		std::cerr << __func__ << ": Error, failed to open file, abort..." << std::endl;
@@ -409,135 +657,129 @@ bool CSPropDiscMaterial::ReadHDF5( std::string filename )
 	if (ver<2.0)
 	{
 		std::cerr << __func__ << ": Error, older file versions are no longer supported, abort..." << std::endl;
-		H5Fclose(file_id);
 		return false;
 	}
 
-	int db_size;
-	status = H5LTget_attribute_int(file_id, "/DiscData", "DB_Size", &db_size);
-	if (status<0)
-	{
-		std::cerr << __func__ << ": Error, can't read database size, abort..." << std::endl;
-		H5Fclose(file_id);
-		return false;
-	}
-
-	m_DB_size = db_size;
 	if (H5Lexists(file_id, "/DiscData", H5P_DEFAULT)<=0)
 	{
 		std::cerr << __func__ << ": Error, can't read database, abort..." << std::endl;
-		H5Fclose(file_id);
 		return false;
 	}
 
-	hid_t dataset = H5Dopen2(file_id, "/DiscData", H5P_DEFAULT);
-	if (dataset<0)
+	H5Object dataset(H5Dopen2(file_id, "/DiscData", H5P_DEFAULT), H5Dclose);
+	if (dataset.Get()<0)
 	{
 		std::cerr << __func__ << ": Error, can't open database" << std::endl;
-		H5Fclose(file_id);
-		return 0;
-	}
-
-	// read database
-	delete[] m_Disc_epsR;
-	if (H5LTfind_attribute(dataset, "epsR")==1)
-	{
-		m_Disc_epsR = new float[db_size];
-		status = H5LTget_attribute_float(file_id, "/DiscData", "epsR", m_Disc_epsR);
-	}
-	else
-	{
-		std::cerr << __func__ << ": No \"/DiscData/epsR\" found, skipping..." << std::endl;
-		m_Disc_epsR=NULL;
-	}
-
-	delete[] m_Disc_kappa;
-	if (H5LTfind_attribute(dataset, "kappa")==1)
-	{
-		m_Disc_kappa = new float[db_size];
-		status = H5LTget_attribute_float(file_id, "/DiscData", "kappa", m_Disc_kappa);
-	}
-	else
-	{
-		std::cerr << __func__ << ": No \"/DiscData/kappa\" found, skipping..." << std::endl;
-		m_Disc_kappa=NULL;
-	}
-
-	delete[] m_Disc_mueR;
-	if (H5LTfind_attribute(dataset, "mueR")==1)
-	{
-		m_Disc_mueR = new float[db_size];
-		status = H5LTget_attribute_float(file_id, "/DiscData", "mueR", m_Disc_mueR);
-	}
-	else
-	{
-		std::cerr << __func__ << ": No \"/DiscData/mueR\" found, skipping..." << std::endl;
-		m_Disc_mueR=NULL;
+		return false;
 	}
 
-	delete[] m_Disc_sigma;
-	if (H5LTfind_attribute(dataset, "sigma")==1)
-	{
-		m_Disc_sigma = new float[db_size];
-		status = H5LTget_attribute_float(file_id, "/DiscData", "sigma", m_Disc_sigma);
-	}
-	else
+	int db_size;
+	status = H5LTget_attribute_int(file_id, "/DiscData", "DB_Size", &db_size);
+	if (status<0)
 	{
-		std::cerr << __func__ << ": No \"/DiscData/sigma\" found, skipping..." << std::endl;
-		m_Disc_sigma=NULL;
+		std::cerr << __func__ << ": Error, can't read database size, abort..." << std::endl;
+		return false;
 	}
+	data.dbSize = db_size;
 
-	delete[] m_Disc_Density;
-	if (H5LTfind_attribute(dataset, "density")==1)
-	{
-		m_Disc_Density = new float[db_size];
-		status = H5LTget_attribute_float(file_id, "/DiscData", "density", m_Disc_Density);
-	}
-	else
+	// read database
+	const char* db_names[] = {"epsR","kappa","mueR","sigma","density"};
+	std::vector<float>* db_values[] = {&data.epsR,&data.kappa,&data.mueR,&data.sigma,&data.density};
+	for (int n=0;n<5;++n)
 	{
-		std::cerr << __func__ << ": no \"/DiscData/density\" found, skipping..." << std::endl;
-		m_Disc_Density=NULL;
+		if (H5LTfind_attribute(dataset.Get(), db_names[n])==1)
+		{
+			db_values[n]->resize(db_size);
+			status = H5LTget_attribute_float(file_id, "/DiscData", db_names[n], db_values[n]->data());
+		}
+		else
+			std::cerr << __func__ << ": No \"/DiscData/" << db_names[n] << "\" found, skipping..." << std::endl;
 	}
 
-	H5Dclose(dataset);
-	H5Fclose(file_id);
-
 	// read mesh
 	unsigned int size;
 	int rank;
-	unsigned int numCells = 1;
+	hsize_t numCells[3], start[3], count[3];
 	std::string names[] = {"/mesh/x","/mesh/y","/mesh/z"};
 	for (int n=0; n<3; ++n)
 	{
-		m_mesh[n] = (float*)ReadDataSet(filename, names[n], H5T_NATIVE_FLOAT, rank, size);
-		if ((m_mesh[n]==NULL) || (rank!=1) || (size<=1))
+		float* mesh = (float*)ReadDataSet(file_id, names[n], H5T_NATIVE_FLOAT, rank, size);
+		if ((mesh==NULL) || (rank!=1) || (size<=1))
 		{
 			std::cerr << __func__ << ": Error, failed to read or invalid mesh, abort..." << std::endl;
+			delete[] mesh;
 			return false;
 		}
-		m_Size[n]=size;
-		numCells*=(m_Size[n]-1);
+		// the voxels to read, all or those intersecting the region of interest
+		unsigned int first = 0, last = size-2;
+		if (roi)
+		{
+			if ((roi[2*n+1]<mesh[0]) || (roi[2*n]>mesh[size-1]))
+			{
+				std::cerr << __func__ << ": Error, the region of interest does not intersect the voxel data, abort..." << std::endl;
+				delete[] mesh;
+				return false;
+			}
+			if (roi[2*n]>mesh[0])
+				first = FindCell(mesh, size, false, 0, roi[2*n]);
+			if (roi[2*n+1]<mesh[size-1])
+				last = FindCell(mesh, size, false, 0, roi[2*n+1]);
+		}
+		data.mesh[n].assign(mesh+first, mesh+last+2);
+		delete[] mesh;
+		data.size[n]=last-first+2;
+		data.offset[n]=first;
+		// the index volume is stored with z as its first and x as its last dimension
+		numCells[2-n] = size-1;
+		start[2-n] = first;
+		count[2-n] = last-first+1;
 	}
 
-	delete[] m_Disc_Ind;
-	m_Disc_Ind = (uint8*)ReadDataSet(filename, "/DiscData", H5T_NATIVE_UINT8, rank, size, true);
-
-	if ((m_Disc_Ind==NULL) || (rank!=3) || (size!=numCells))
+	if (ReadIndexVolume(dataset.Get(), numCells, start, count, data.index, data.indexBytes)==false)
 	{
 		std::cerr << __func__ << ": Error, can't read database indizies or size/rank is invalid, abort..." << std::endl;
-		delete[] m_Disc_Ind;
-		m_Disc_Ind = NULL;
 		return false;
 	}
+
+	// uniform meshes are looked up without a search
+	for (int n=0; n<3; ++n)
+	{
+		const std::vector<float>& mesh = data.mesh[n];
+		const double delta = ((double)mesh.back()-mesh.front())/(mesh.size()-1);
+		data.uniform[n] = (delta>0);
+		for (size_t i=1; (i<mesh.size()) && data.uniform[n]; ++i)
+			data.uniform[n] = (fabs(mesh[i]-(mesh.front()+i*delta)) <= 1e-3*delta);
+		data.invDelta[n] = data.uniform[n] ? 1.0/delta : 0;
+	}
 	return true;
 }
 
+void CSPropDiscMaterial::SetDataViews()
+{
+	const DiscData* data = m_Data.get();
+	m_DB_size = data ? data->dbSize : 0;
+	for (int n=0;n<3;++n)
+	{
+		m_mesh[n] = data ? data->mesh[n].data() : NULL;
+		m_Size[n] = data ? data->size[n] : 0;
+	}
+	m_Disc_Ind = data ? data->index.data() : NULL;
+	m_IndexBytes = data ? data->indexBytes : 1;
+	m_Disc_epsR = (data && !data->epsR.empty()) ? data->epsR.data() : NULL;
+	m_Disc_kappa = (data && !data->kappa.empty()) ? data->kappa.data() : NULL;
+	m_Disc_mueR = (data && !data->mueR.empty()) ? data->mueR.data() : NULL;
+	m_Disc_sigma = (data && !data->sigma.empty()) ? data->sigma.data() : NULL;
+	m_Disc_Density = (data && !data->density.empty()) ? data->density.data() : NULL;
+}
+
 void CSPropDiscMaterial::ShowPropertyStatus(std::ostream& stream)
 {
 	CSProperties::ShowPropertyStatus(stream);
 	stream << " --- Discrete Material Properties --- " << std::endl;
 	stream << "  Data-Base Size:\t: " << m_DB_size << std::endl;
 	stream << "  Number of Voxels:\t: " << m_Size[0] << "x" << m_Size[1] << "x" << m_Size[2] << std::endl;
+	if (m_Data && m_UseROI)
+		stream << "  First Voxel Read:\t: " << m_Data->offset[0] << "," << m_Data->offset[1] << "," << m_Data->offset[2] << std::endl;
 	stream << " Background Material Properties: " << std::endl;
 	stream << "  Isotropy\t: " << bIsotropy << std::endl;
 	stream << "  Epsilon_R\t: " << Epsilon[0].GetValueString() << ", "  << Epsilon[1].GetValueString() << ", "  << Epsilon[2].GetValueString()  << std::endl;
@@ -547,7 +789,7 @@ void CSPropDiscMaterial::ShowPropertyStatus(std::ostream& stream)
 	stream << "  Density\t: " << Density.GetValueString() << std::endl;
 }
 
-vtkPolyData* CSPropDiscMaterial::CreatePolyDataModel()
+vtkPolyData* CSPropDiscMaterial::CreatePolyDataModel(bool separateMaterials, unsigned int numThreads)
 {
 	// the voxel data is loaded lazily, make sure it is available before using it
 	EnsureFileLoaded();
@@ -561,145 +803,143 @@ vtkPolyData* CSPropDiscMaterial::CreatePolyDataModel()
 		return NULL;
 	}
 
-	vtkPolyData* polydata = vtkPolyData::New();
-	vtkCellArray *poly = vtkCellArray::New();
-	vtkPoints *points = vtkPoints::New();
-
-
-	int* pointIdx[2];
-	pointIdx[0] = new int[m_Size[0]*m_Size[1]];
-	pointIdx[1] = new int[m_Size[0]*m_Size[1]];
-	// init point idx
-	for (unsigned int n=0;n<m_Size[0]*m_Size[1];++n)
+	// a rectangle of merged faces, given by its four mesh nodes and the material index
+	struct Quad
 	{
-		pointIdx[0][n]=-1;
-		pointIdx[1][n]=-1;
-	}
+		size_t node[4];
+		unsigned int mat;
+	};
 
-	unsigned int mat_idx, mat_idx_down;
-	unsigned int mat_up_val, mat_down_val;
-	unsigned int mesh_idx=0;
-	bool bd, bu;
-	int nP, nPP;
-	unsigned int pos[3],rpos[3];
-	// sweep over mesh nodes (not cells): a surface may also sit on the very last
-	// node of the data set, i.e. when the material reaches the boundary
-	for (pos[2]=0;pos[2]<m_Size[2];++pos[2])
-	{ // each xy-plane
-		for (unsigned int n=0;n<m_Size[0]*m_Size[1];++n)
+	// every node plane in every direction is a task, a surface may also sit on the very
+	// first or last node of the data set, i.e. when the material reaches the boundary
+	std::vector<std::pair<int,unsigned int> > tasks;
+	for (int n=0;n<3;++n)
+		for (unsigned int p=0;p<m_Size[n];++p)
+			tasks.push_back(std::make_pair(n,p));
+	std::vector<std::vector<Quad> > quads(tasks.size());
+
+	const size_t cellStride[3] = {1, m_Size[0]-1, (size_t)(m_Size[0]-1)*(m_Size[1]-1)};
+	const size_t nodeStride[3] = {1, m_Size[0], (size_t)m_Size[0]*m_Size[1]};
+
+	if (numThreads==0)
+		numThreads = std::thread::hardware_concurrency();
+	if (numThreads<1)
+		numThreads = 1;
+	if (numThreads>tasks.size())
+		numThreads = (unsigned int)tasks.size();
+
+	// every thread handles every numThreads-th plane
+	auto extract = [&](unsigned int thread)
+	{
+		// the material index of all faces of a plane facing up and down in the plane direction, 0 for no face
+		std::vector<unsigned int> faces[2];
+		for (size_t t=thread;t<tasks.size();t+=numThreads)
 		{
-			pointIdx[0][n]=pointIdx[1][n];
-			pointIdx[1][n]=-1;
-		}
-		for (pos[0]=0;pos[0]<m_Size[0];++pos[0])
-			for (pos[1]=0;pos[1]<m_Size[1];++pos[1])
-			{
-				for (int n=0;n<3;++n)
+			const int n = tasks[t].first;
+			const int nP = (n+1)%3;
+			const int nPP = (n+2)%3;
+			const unsigned int p = tasks[t].second;
+			const unsigned int numA = m_Size[nP]-1;
+			const unsigned int numB = m_Size[nPP]-1;
+			for (int o=0;o<2;++o)
+				faces[o].assign((size_t)numA*numB, 0);
+
+			// material of the cells above/below the faces at node p,
+			// everything outside the data set is background
+			for (unsigned int b=0;b<numB;++b)
+				for (unsigned int a=0;a<numA;++a)
 				{
-					// the quad spans one cell in both perpendicular directions
-					if ((pos[(n+1)%3]>=m_Size[(n+1)%3]-1) || (pos[(n+2)%3]>=m_Size[(n+2)%3]-1))
+					size_t cell = a*cellStride[nP] + b*cellStride[nPP];
+					unsigned int mat_up = (p<m_Size[n]-1) ? GetIndex(cell + p*cellStride[n]) : 0;
+					unsigned int mat_down = (p>0) ? GetIndex(cell + (p-1)*cellStride[n]) : 0;
+					if (mat_up==mat_down)
+						continue;
+					if ((separateMaterials==false) && (mat_up>0) && (mat_down>0))
 						continue;
+					faces[0][a+b*numA] = mat_down; // surface up of the material below
+					faces[1][a+b*numA] = mat_up;   // surface down of the material above
+				}
 
-					// reset relative pos
-					rpos[0]=pos[0];
-					rpos[1]=pos[1];
-					rpos[2]=pos[2];
-					bd = false;
-					bu = false;
-
-					// material of the cells above/below the face at node pos[n];
-					// everything outside the data set is background
-					mat_up_val = 0;
-					mat_down_val = 0;
-					if (pos[n]<m_Size[n]-1)
+			// merge the faces of the same material into rectangles, as wide as possible first
+			for (int o=0;o<2;++o)
+				for (unsigned int b=0;b<numB;++b)
+					for (unsigned int a=0;a<numA;++a)
 					{
-						mat_idx = pos[0] + pos[1]*(m_Size[0]-1) + pos[2]*(m_Size[0]-1)*(m_Size[1]-1);
-						mat_up_val = m_Disc_Ind[mat_idx];
-					}
-					if (pos[n]>0)
-					{
-						rpos[n] = pos[n]-1; // set relative pos
-						mat_idx_down  = rpos[0] + rpos[1]*(m_Size[0]-1) + rpos[2]*(m_Size[0]-1)*(m_Size[1]-1);
-						rpos[n] = pos[n]; // reset relative pos
-						mat_down_val = m_Disc_Ind[mat_idx_down];
+						const unsigned int mat = faces[o][a+b*numA];
+						if (mat==0)
+							continue;
+						unsigned int w = 1, h = 1;
+						while ((a+w<numA) && (faces[o][a+w+b*numA]==mat))
+							++w;
+						for (bool full=true;full && (b+h<numB);)
+						{
+							for (unsigned int i=a;full && (i<a+w);++i)
+								full = (faces[o][i+(b+h)*numA]==mat);
+							if (full)
+								++h;
+						}
+						for (unsigned int j=b;j<b+h;++j)
+							for (unsigned int i=a;i<a+w;++i)
+								faces[o][i+j*numA] = 0;
+
+						// the corners in the order of the surface orientation
+						size_t node = p*nodeStride[n] + a*nodeStride[nP] + b*nodeStride[nPP];
+						Quad q;
+						q.mat = mat;
+						q.node[0] = node;
+						q.node[2] = node + w*nodeStride[nP] + h*nodeStride[nPP];
+						q.node[1] = node + ((o==0) ? w*nodeStride[nP] : h*nodeStride[nPP]);
+						q.node[3] = node + ((o==0) ? h*nodeStride[nPP] : w*nodeStride[nP]);
+						quads[t].push_back(q);
 					}
+		}
+	};
 
-					if ((mat_up_val>0) && (mat_down_val==0))
-						bd=true;
-					else if ((mat_up_val==0) && (mat_down_val>0))
-						bu=true;
+	if (numThreads==1)
+		extract(0);
+	else
+	{
+		std::vector<std::thread> threads;
+		for (unsigned int t=0;t<numThreads;++t)
+			threads.push_back(std::thread(extract, t));
+		for (size_t t=0;t<threads.size();++t)
+			threads.at(t).join();
+	}
 
-					rpos[0]=pos[0];
-					rpos[1]=pos[1];
-					rpos[2]=0;
+	vtkPolyData* polydata = vtkPolyData::New();
+	vtkCellArray *poly = vtkCellArray::New();
+	vtkPoints *points = vtkPoints::New();
+	vtkUnsignedIntArray* matIndex = vtkUnsignedIntArray::New();
+	matIndex->SetName("MaterialIndex");
 
-					if (bu) // draw poly for surface up
-					{
-						nP = (n+1)%3;
-						nPP = (n+2)%3;
-						poly->InsertNextCell(4);
-
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-
-						++rpos[nP];
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-
-						++rpos[nPP];
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-
-						--rpos[nP];
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-					}
-					else if (bd) // draw poly for surface down
-					{
-						nP = (n+1)%3;
-						nPP = (n+2)%3;
-						poly->InsertNextCell(4);
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-
-						++rpos[nPP];
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-
-						++rpos[nP];
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-
-						--rpos[nPP];
-						mesh_idx = rpos[0] + rpos[1]*m_Size[0];
-						if (pointIdx[rpos[2]][mesh_idx]<0)
-							pointIdx[rpos[2]][mesh_idx] = (int)points->InsertNextPoint(m_mesh[0][rpos[0]],m_mesh[1][rpos[1]],m_mesh[2][pos[2]+rpos[2]]);
-						poly->InsertCellPoint(pointIdx[rpos[2]][mesh_idx]);
-					}
+	// all rectangles in the order of the planes, a mesh node shared by rectangles is a single point
+	std::unordered_map<size_t, vtkIdType> pointIdx;
+	for (size_t t=0;t<quads.size();++t)
+		for (size_t q=0;q<quads[t].size();++q)
+		{
+			poly->InsertNextCell(4);
+			for (int c=0;c<4;++c)
+			{
+				size_t node = quads[t][q].node[c];
+				std::unordered_map<size_t, vtkIdType>::iterator it = pointIdx.find(node);
+				if (it==pointIdx.end())
+				{
+					size_t i = node%m_Size[0];
+					size_t j = (node/m_Size[0])%m_Size[1];
+					size_t k = node/nodeStride[2];
+					it = pointIdx.insert(std::make_pair(node, points->InsertNextPoint(m_mesh[0][i],m_mesh[1][j],m_mesh[2][k]))).first;
 				}
+				poly->InsertCellPoint(it->second);
 			}
-	}
-	delete[] pointIdx[0];
-	delete[] pointIdx[1];
+			matIndex->InsertNextValue(quads[t][q].mat);
+		}
 
 	polydata->SetPoints(points);
 	points->Delete();
 	polydata->SetPolys(poly);
 	poly->Delete();
+	polydata->GetCellData()->AddArray(matIndex);
+	matIndex->Delete();
 
 	return polydata;
 }
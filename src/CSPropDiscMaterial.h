@@ -17,10 +17,15 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "CSProperties.h"
 #include "CSPropMaterial.h"
 
 typedef unsigned char uint8;
+typedef unsigned short uint16;
+typedef unsigned int uint32;
 
 class vtkPolyData;
 
@@ -48,6 +53,25 @@ public:
 
 	virtual double GetDensityWeighted(const double* coords);
 
+	//! The discrete material values are looked up per coordinate, also for many coordinates at once
+	virtual void GetEpsilonWeighted(int ny, size_t numCoords, const double* coords, double* values);
+	virtual void GetMueWeighted(int ny, size_t numCoords, const double* coords, double* values);
+	virtual void GetKappaWeighted(int ny, size_t numCoords, const double* coords, double* values);
+	virtual void GetSigmaWeighted(int ny, size_t numCoords, const double* coords, double* values);
+	virtual void GetDensityWeighted(size_t numCoords, const double* coords, double* values);
+
+	//! Get all weighted material values at all points of a volume of grid lines, e.g. the lines of a CSRectGrid.
+	/*!
+	  Without a rotation in the transform and with cartesian coordinates, the voxel of each line is found once per direction
+	  and the values of all points are gathered from the voxel data. Otherwise the voxel is found once per point.
+	  Same results as GetEpsilonWeighted and the like at each point.
+	  \param ny The direction of the continuous material used outside of the voxel data
+	  \param lines The lines in x-, y- and z-direction
+	  \param epsilon Resized and filled, the value at (lines[0][i], lines[1][j], lines[2][k]) at index (i*lines[1].size()+j)*lines[2].size()+k
+	  */
+	void GetWeightedVolume(int ny, const std::vector<double> lines[3], std::vector<double>& epsilon, std::vector<double>& mue,
+						   std::vector<double>& kappa, std::vector<double>& sigma, std::vector<double>& density);
+
 	//! Set true if database index 0 is used as background material (default), or false if CSPropMaterial should be used as index 0
 	virtual void SetUseDataBaseForBackground(bool val) {m_DB_Background=val;}
 	bool GetUseDataBaseForBackground() const {return m_DB_Background;}
@@ -76,6 +100,15 @@ public:
 	void SetScale(double val) {m_Scale=val;}
 	double GetScale() {return m_Scale;}
 
+	//! Read only the voxels intersecting a region of interest, e.g. the simulation area, instead of the complete voxel data.
+	/*! The bounds (xmin,xmax,ymin,ymax,zmin,zmax) are cartesian coordinates of the structure, set the transform and scale first.
+	 *  Only the part of the voxel data intersecting the bounds is read from the file, for a chunked and compressed dataset only
+	 *  the chunks of this part. Points outside of the voxels read get the background material, as outside of the voxel data. */
+	void SetRegionOfInterest(const double bounds[6]);
+	//! Read the complete voxel data again (default) \sa SetRegionOfInterest
+	void ClearRegionOfInterest() {m_UseROI=false; m_FileRead=false;}
+	bool HasRegionOfInterest() const {return m_UseROI;}
+
 	virtual bool Write2XML(TiXmlNode& root, bool parameterised=true, bool sparse=false);
 	virtual bool ReadFromXML(TiXmlNode &root);
 
@@ -84,31 +117,89 @@ public:
 	virtual void ShowPropertyStatus(std::ostream& stream);
 
 	//! Create a vtkPolyData surface that separates the discrete material from background material.
-	//! Loads the data file if not already read. Returns NULL if no valid data is available.
-	virtual vtkPolyData* CreatePolyDataModel();
+	/*!
+	  Coplanar faces of the same material and orientation are merged into rectangles, the planes of faces are extracted in parallel.
+	  The cell data array "MaterialIndex" holds the material index of each polygon.
+	  Loads the data file if not already read. Returns NULL if no valid data is available.
+	  \param separateMaterials Create a closed surface for each material index, including the faces between two materials
+	  \param numThreads Number of threads to use, 0 to use all available cores
+	  */
+	virtual vtkPolyData* CreatePolyDataModel(bool separateMaterials=false, unsigned int numThreads=0);
 
 protected:
 	unsigned int GetWeightingPos(const double* coords);
+	//! Get the cell of a coordinate on one axis (a binary search, or direct for a uniform mesh), -1 if outside
+	static unsigned int FindCell(const float* mesh, unsigned int size, bool uniform, double invDelta, double coord);
 	int GetDBPos(const double* coords);
+	//! Get the database index of a voxel, for all sizes of the index volume
+	unsigned int GetIndex(unsigned int pos) const
+	{
+		switch (m_IndexBytes)
+		{
+		case 2:
+			return ((const uint16*)m_Disc_Ind)[pos];
+		case 4:
+			return ((const uint32*)m_Disc_Ind)[pos];
+		default:
+			return m_Disc_Ind[pos];
+		}
+	}
+	//! Get the database position of a voxel, -1 for the continuous material
+	int GetDBPosOfCell(unsigned int pos);
+	//! Get the inverse transform as scale*coord+offset per direction, false if it mixes the directions or for cylindrical coordinates
+	bool GetAxisMapping(double scale[3], double offset[3]) const;
 	virtual void Init();
 
+	//! The content of a discrete material file, shared by all properties using the same file. \sa CSFileCache
+	struct DiscData
+	{
+		unsigned int size[3] = {0,0,0};
+		//! the first voxel read from the file, if only a part of it was read
+		unsigned int offset[3] = {0,0,0};
+		unsigned int dbSize = 0;
+		std::vector<float> mesh[3];
+		//! the index volume, with indexBytes (1, 2 or 4) per voxel as stored in the file
+		std::vector<uint8> index;
+		unsigned int indexBytes = 1;
+		//! database values, empty if not found in the file
+		std::vector<float> epsR;
+		std::vector<float> kappa;
+		std::vector<float> mueR;
+		std::vector<float> sigma;
+		std::vector<float> density;
+		//! uniformly spaced mesh lines and their inverse spacing, detected at load time
+		bool uniform[3] = {false,false,false};
+		double invDelta[3] = {0,0,0};
+	};
+	std::shared_ptr<const DiscData> m_Data;
+
 	int m_FileType;
 	std::string m_Filename;
+	//! views into m_Data, NULL if not available
 	unsigned int m_Size[3];
 	unsigned int m_DB_size;
-	uint8* m_Disc_Ind;
-	float *m_mesh[3];
-	float *m_Disc_epsR;
-	float *m_Disc_kappa;
-	float *m_Disc_mueR;
-	float *m_Disc_sigma;
-	float *m_Disc_Density;
+	const uint8* m_Disc_Ind;
+	unsigned int m_IndexBytes;
+	const float *m_mesh[3];
+	const float *m_Disc_epsR;
+	const float *m_Disc_kappa;
+	const float *m_Disc_mueR;
+	const float *m_Disc_sigma;
+	const float *m_Disc_Density;
 	double m_Scale;
 	bool m_DB_Background;
 	bool m_FileRead;
 	CSTransform* m_Transform;
+	bool m_UseROI;
+	double m_ROI[6];
 
 	void EnsureFileLoaded();
 	bool ReadHDF5(std::string filename);
+	//! Read a discrete material file, optional only the voxels intersecting the bounds (in voxel mesh coordinates) of a region of interest
+	static bool ReadHDF5Data(const std::string& filename, DiscData& data, const double* roi=NULL);
+	//! Get the bounds of the region of interest in voxel mesh coordinates
+	void GetVoxelRegion(double roi[6]) const;
+	//! Set the views into m_Data, or reset them if no data is loaded
+	void SetDataViews();
 };
 
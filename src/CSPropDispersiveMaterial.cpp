@@ -82,6 +82,17 @@ double CSPropDispersiveMaterial::GetWeight3(ParameterScalar **ps, int order, int
 	return this->GetWeight(ps[order], ny, coords);
 }
 
+void CSPropDispersiveMaterial::GetWeight3(ParameterScalar **ps, int order, int ny, size_t numCoords, const double* coords, double* values, double value)
+{
+	if ((ny>2) || (ny<0) || (order>=m_Order) || (order<0))
+	{
+		for (size_t n=0;n<numCoords;++n)
+			values[n] = 0;
+		return;
+	}
+	this->GetWeight(ps[order], ny, numCoords, coords, values, value);
+}
+
 bool CSPropDispersiveMaterial::Write2XML(TiXmlNode& root, bool parameterised, bool sparse)
 {
 	return CSPropMaterial::Write2XML(root,parameterised,sparse);
@@ -50,6 +50,7 @@ protected:
 	void SetValue3(double val, ParameterScalar **ps, int order, int ny);
 	int SetValue3(std::string val, ParameterScalar **ps, int order, int ny);
 	double GetWeight3(ParameterScalar **ps, int order, int ny, const double* coords);
+	void GetWeight3(ParameterScalar **ps, int order, int ny, size_t numCoords, const double* coords, double* values, double value);
 
 	virtual bool Write2XML(TiXmlNode& root, bool parameterised=true, bool sparse=false);
 	virtual bool ReadFromXML(TiXmlNode &root);
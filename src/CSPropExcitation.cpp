@@ -20,6 +20,11 @@
 
 #include "CSPropExcitation.h"
 
+#include <algorithm>
+
+// number of coordinates of which the weighting function variables are set up at once
+#define EXCITATION_BLOCK_SIZE 64
+
 CSPropExcitation::CSPropExcitation(ParameterSet* paraSet,unsigned int number) : CSProperties(paraSet) {Type=EXCITATION;Init();uiNumber=number;}
 CSPropExcitation::CSPropExcitation(CSPropExcitation* prop, bool copyPrim) : CSProperties(prop, copyPrim)
 {
@@ -120,10 +125,75 @@ std::string CSPropExcitation::GetWeightFile()
 
 double CSPropExcitation::GetWeightedExcitation(int ny, const double* coords)
 {
-	if ((ny<0) || (ny>=3)) return 0;
-	//Warning: this is not reentrant....!!!!
+	double value = 0;
+	GetWeightedExcitation(ny, 1, coords, &value);
+	return value;
+}
+
+void CSPropExcitation::GetWeightedExcitation(int ny, size_t numCoords, const double* coords, double* values)
+{
+	if ((ny<0) || (ny>=3))
+	{
+		for (size_t n=0;n<numCoords;++n)
+			values[n] = 0;
+		return;
+	}
+
+	if (!m_WeightFile.empty())
+	{
+		GetWeightFileExcitation(ny, numCoords, coords, values);
+		return;
+	}
+
+	double excitation = GetExcitation(ny);
+	unsigned int used = WeightFct[ny].GetDependency();
+	if (used==0)
+	{
+		double weight = WeightFct[ny].GetValue()*excitation;
+		for (size_t n=0;n<numCoords;++n)
+			values[n] = weight;
+		return;
+	}
+
+	// the coordinate variables are local to this call, the shared coordinate parameters are not touched
+	double paraVal[7*EXCITATION_BLOCK_SIZE];
+	int EC=0;
+	for (size_t start=0;start<numCoords;start+=EXCITATION_BLOCK_SIZE)
+	{
+		size_t count = std::min<size_t>(numCoords-start,EXCITATION_BLOCK_SIZE);
+		for (size_t n=0;n<count;++n)
+			GetWeightCoords(&coords[3*(start+n)],&paraVal[7*n]);
+		if (used & (8|64))
+			for (size_t n=0;n<count;++n)
+				paraVal[7*n+3] = sqrt(paraVal[7*n]*paraVal[7*n] + paraVal[7*n+1]*paraVal[7*n+1]); //rho
+		if (used & 16)
+			for (size_t n=0;n<count;++n)
+				paraVal[7*n+4] = sqrt(paraVal[7*n]*paraVal[7*n] + paraVal[7*n+1]*paraVal[7*n+1] + paraVal[7*n+2]*paraVal[7*n+2]); //r
+		if (used & 32)
+			for (size_t n=0;n<count;++n)
+				paraVal[7*n+5] = atan2(paraVal[7*n+1], paraVal[7*n]); //alpha
+		if (used & 64)
+			for (size_t n=0;n<count;++n)
+				paraVal[7*n+6] = asin(1) - atan(paraVal[7*n+2] / paraVal[7*n+3]); //theta
+
+		int blockEC=0;
+		WeightFct[ny].GetEvaluated(count,paraVal,&values[start],blockEC);
+		if (EC==0)
+			EC = blockEC;
+		for (size_t n=start;n<start+count;++n)
+			values[n] *= excitation;
+	}
+	if (EC)
+		std::cerr << "CSPropExcitation::GetWeightedExcitation: error evaluating weight function "
+		             "(ID: " << this->GetID() << ", n=" << ny << "): " << PSErrorCode2Msg(EC) << "\n";
+}
+
+void CSPropExcitation::GetWeightCoords(const double* coords, double* loc_coords) const
+{
 	// Convert input to Cartesian, then apply weight origin shift
-	double loc_coords[3] = {coords[0],coords[1],coords[2]};
+	loc_coords[0] = coords[0];
+	loc_coords[1] = coords[1];
+	loc_coords[2] = coords[2];
 	if (coordInputType==1)
 	{
 		loc_coords[0] = coords[0]*cos(coords[1]);
@@ -132,70 +202,111 @@ double CSPropExcitation::GetWeightedExcitation(int ny, const double* coords)
 	loc_coords[0] -= m_WeightOrigin[0];
 	loc_coords[1] -= m_WeightOrigin[1];
 	loc_coords[2] -= m_WeightOrigin[2];
+}
 
-	double rho   = sqrt(loc_coords[0]*loc_coords[0] + loc_coords[1]*loc_coords[1]);
-	double alpha = atan2(loc_coords[1], loc_coords[0]);
-	double r     = sqrt(loc_coords[0]*loc_coords[0] + loc_coords[1]*loc_coords[1] + loc_coords[2]*loc_coords[2]);
-	double theta = asin(1) - atan(loc_coords[2] / rho);
-
-	double cWeight;
-	if (!m_WeightFile.empty())
+int CSPropExcitation::LoadWeightFile()
+{
 	{
+		// the weight file is loaded by the first call, concurrent calls wait for it
+		std::lock_guard<std::mutex> lock(m_WeightFileMutex);
 		if (!m_WeightFileData.IsLoaded())
 			m_WeightFileData.ReadFromHDF5(m_WeightFile);
+	}
 
-		if (!m_WeightFileData.IsLoaded())
-		{
-			std::cerr << "CSPropExcitation::GetWeightedExcitation: weight file '" << m_WeightFile << "' could not be loaded\n";
-			return 0.0;
-		}
-
-		int nPy = 0, checkSum = 0;
-		for (int dirIdx = 0; dirIdx < 3; dirIdx++)
-		{
-			nPy      += (PropagationDir[dirIdx].GetValue() != 0) * (dirIdx + 1);
-			checkSum += (PropagationDir[dirIdx].GetValue() != 0);
-		}
-		nPy--;
+	if (!m_WeightFileData.IsLoaded())
+	{
+		std::cerr << "CSPropExcitation::GetWeightedExcitation: weight file '" << m_WeightFile << "' could not be loaded\n";
+		return -1;
+	}
 
-		if ((nPy < 0) || (checkSum != 1))
-		{
-			std::cerr << "CSPropExcitation::GetWeightedExcitation: cannot determine propagation direction, "
-			             "PropagationDir = ("
-			          << PropagationDir[0].GetValue() << ", "
-			          << PropagationDir[1].GetValue() << ", "
-			          << PropagationDir[2].GetValue() << ")\n";
-			return 0.0;
-		}
+	int nPy = 0, checkSum = 0;
+	for (int dirIdx = 0; dirIdx < 3; dirIdx++)
+	{
+		nPy      += (PropagationDir[dirIdx].GetValue() != 0) * (dirIdx + 1);
+		checkSum += (PropagationDir[dirIdx].GetValue() != 0);
+	}
+	nPy--;
 
-		const int nPyp  = (nPy + 1) % 3;
-		const int nPypp = (nPy + 2) % 3;
+	if ((nPy < 0) || (checkSum != 1))
+	{
+		std::cerr << "CSPropExcitation::GetWeightedExcitation: cannot determine propagation direction, "
+		             "PropagationDir = ("
+		          << PropagationDir[0].GetValue() << ", "
+		          << PropagationDir[1].GetValue() << ", "
+		          << PropagationDir[2].GetValue() << ")\n";
+		return -1;
+	}
+	return nPy;
+}
 
-		cWeight = 0.0;
-		if (nPy != ny)
+void CSPropExcitation::GetWeightFileExcitation(int ny, size_t numCoords, const double* coords, double* values)
+{
+	for (size_t n=0;n<numCoords;++n)
+		values[n] = 0.0;
+
+	int nPy = LoadWeightFile();
+	if ((nPy < 0) || (nPy == ny))
+		return;
+
+	const int nPyp  = (nPy + 1) % 3;
+	const int nPypp = (nPy + 2) % 3;
+	double excitation = GetExcitation(ny);
+	double pos[2][EXCITATION_BLOCK_SIZE];
+	double fields[2][EXCITATION_BLOCK_SIZE];
+	for (size_t start=0;start<numCoords;start+=EXCITATION_BLOCK_SIZE)
+	{
+		size_t count = std::min<size_t>(numCoords-start,EXCITATION_BLOCK_SIZE);
+		for (size_t n=0;n<count;++n)
 		{
-			// fields[0]=Ex (first transverse), fields[1]=Ey (second transverse)
-			auto fields = m_WeightFileData.LinInterp2(loc_coords[nPyp], loc_coords[nPypp]);
-			cWeight = fields[int(ny == nPypp)];
+			double loc_coords[3];
+			GetWeightCoords(&coords[3*(start+n)],loc_coords);
+			pos[0][n] = loc_coords[nPyp];
+			pos[1][n] = loc_coords[nPypp];
 		}
+		// fields[0]=Ex (first transverse), fields[1]=Ey (second transverse)
+		m_WeightFileData.LinInterp2(count, pos[0], pos[1], fields[0], fields[1]);
+		for (size_t n=0;n<count;++n)
+			values[start+n] = fields[int(ny == nPypp)][n] * excitation;
 	}
-	else
+}
+
+void CSPropExcitation::GetWeightedExcitationPlane(int ny, int normDir, double normPos, const std::vector<double>& lines1, const std::vector<double>& lines2, std::vector<double>& values)
+{
+	values.assign(lines1.size()*lines2.size(), 0.0);
+	if ((ny<0) || (ny>=3) || (normDir<0) || (normDir>=3) || values.empty())
+		return;
+
+	// a mode on a cartesian plane normal to the propagation direction is separable in the two transverse directions
+	if (!m_WeightFile.empty() && (coordInputType!=CYLINDRICAL) && (PropagationDir[normDir].GetValue()!=0))
 	{
-		coordPara[0]->SetValue(loc_coords[0]);
-		coordPara[1]->SetValue(loc_coords[1]);
-		coordPara[2]->SetValue(loc_coords[2]);
-		coordPara[3]->SetValue(rho); //rho
-		coordPara[4]->SetValue(r); //r
-		coordPara[5]->SetValue(alpha);
-		coordPara[6]->SetValue(theta); //theta
-
-		int EC = WeightFct[ny].Evaluate();
-		if (EC)
-			std::cerr << "CSPropExcitation::GetWeightedExcitation: error evaluating weight function "
-			             "(ID: " << this->GetID() << ", n=" << ny << "): " << PSErrorCode2Msg(EC) << "\n";
-		cWeight = WeightFct[ny].GetValue();
+		int nPy = LoadWeightFile();
+		if ((nPy < 0) || (nPy == ny))
+			return;
+
+		std::vector<double> x(lines1), y(lines2);
+		for (size_t i=0;i<x.size();++i)
+			x[i] -= m_WeightOrigin[(normDir+1)%3];
+		for (size_t j=0;j<y.size();++j)
+			y[j] -= m_WeightOrigin[(normDir+2)%3];
+		std::vector<double> vx, vy;
+		m_WeightFileData.Resample(x, y, vx, vy);
+		const std::vector<double>& fields = (ny == (nPy + 2) % 3) ? vy : vx;
+		double excitation = GetExcitation(ny);
+		for (size_t n=0;n<values.size();++n)
+			values[n] = fields[n] * excitation;
+		return;
 	}
-	return cWeight * GetExcitation(ny);
+
+	std::vector<double> coords(3*values.size());
+	for (size_t i=0;i<lines1.size();++i)
+		for (size_t j=0;j<lines2.size();++j)
+		{
+			double* coord = &coords[3*(i*lines2.size()+j)];
+			coord[normDir] = normPos;
+			coord[(normDir+1)%3] = lines1[i];
+			coord[(normDir+2)%3] = lines2[j];
+		}
+	GetWeightedExcitation(ny, values.size(), &coords[0], &values[0]);
 }
 
 void CSPropExcitation::SetDelay(double val)	{Delay.SetValue(val);}
@@ -296,6 +407,9 @@ bool CSPropExcitation::Update(std::string *ErrStr)
 		ErrStr->append(stream.str());
 		PSErrorCode2Msg(EC,ErrStr);
 	}
+	// find constant weighting functions and the coordinate variables used by all others
+	for (unsigned int i=0;i<3;++i)
+		WeightFct[i].AnalyzeDependency();
 	return bOK;
 }
 
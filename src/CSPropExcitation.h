@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "CSProperties.h"
 #include "CSModeData.h"
 
@@ -94,7 +96,23 @@ public:
 	//! Get one component of the weight origin (0=x, 1=y, 2=z)
 	double GetWeightOrigin(int n) const { return (n>=0 && n<3) ? m_WeightOrigin[n] : 0.0; }
 
+	//! Get the weighted excitation amplitude of a component at a given coordinate. Reentrant, may be called from multiple threads.
 	double GetWeightedExcitation(int ny, const double* coords);
+	//! Get the weighted excitation amplitude of a component at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once. \sa GetWeightedExcitation
+	void GetWeightedExcitation(int ny, size_t numCoords, const double* coords, double* values);
+	//! Get the weighted excitation amplitude of a component at all points of a plane of grid lines.
+	/*!
+	  The plane is given by its normal direction and position and the lines of the two other directions, e.g. from CSRectGrid::GetSamplePositions.
+	  The mode of a weight file, for a plane normal to the propagation direction, is resampled onto the lines at once. \sa CSModeData::Resample
+	  All other weightings are evaluated at each point. \sa GetWeightedExcitation
+	  \param ny The excitation component
+	  \param normDir The normal direction of the plane
+	  \param normPos The position of the plane in the normal direction
+	  \param lines1 Lines in direction (normDir+1)%3
+	  \param lines2 Lines in direction (normDir+2)%3
+	  \param values Resized and filled with the weighted excitation, values[i*lines2.size()+j] at lines1[i] and lines2[j]
+	  */
+	void GetWeightedExcitationPlane(int ny, int normDir, double normPos, const std::vector<double>& lines1, const std::vector<double>& lines2, std::vector<double>& values);
 
 	//! Set the propagation direction for a given component
 	void SetPropagationDir(double val, int Component=0);
@@ -135,5 +153,12 @@ protected:
 
 	std::string m_WeightFile;
 	CSModeData  m_WeightFileData;
+	std::mutex  m_WeightFileMutex;
 	double      m_WeightOrigin[3];
+
+	//! Convert a coordinate to the cartesian coordinate of the weighting, relative to the weight origin
+	void GetWeightCoords(const double* coords, double* loc_coords) const;
+	void GetWeightFileExcitation(int ny, size_t numCoords, const double* coords, double* values);
+	//! Load the weight file if not done yet and get the propagation direction of its mode, -1 on an error
+	int LoadWeightFile();
 };
@@ -297,6 +297,13 @@ bool CSPropLorentzMaterial::Update(std::string *ErrStr)
 				ErrStr->append(stream.str());
 				PSErrorCode2Msg(EC,ErrStr);
 			}
+
+			WeightEpsPlasma[o][n].AnalyzeDependency();
+			WeightMuePlasma[o][n].AnalyzeDependency();
+			WeightEpsLorPole[o][n].AnalyzeDependency();
+			WeightMueLorPole[o][n].AnalyzeDependency();
+			WeightEpsRelaxTime[o][n].AnalyzeDependency();
+			WeightMueRelaxTime[o][n].AnalyzeDependency();
 		}
 	}
 	return bOK & CSPropDispersiveMaterial::Update(ErrStr);
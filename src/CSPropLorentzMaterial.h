@@ -55,6 +55,8 @@ public:
 	const std::string GetEpsPlasmaFreqWeightFunction(int order, int ny) {return GetTerm3(WeightEpsPlasma,order,ny);}
 	//! Get the epsilon plasma frequency weighting
 	double GetEpsPlasmaFreqWeighted(int order, int ny, const double* coords) {return GetWeight3(WeightEpsPlasma,order,ny,coords)*GetEpsPlasmaFreq(order,ny);}
+	//! Get the epsilon plasma frequency weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetEpsPlasmaFreqWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightEpsPlasma,order,ny,numCoords,coords,values,GetEpsPlasmaFreq(order,ny));}
 
 	//! Set the epsilon lorentz pole frequency
 	void SetEpsLorPoleFreq(int order, double val, int ny=0) {SetValue3(val,EpsLorPole,order,ny);}
@@ -71,6 +73,8 @@ public:
 	const std::string GetEpsLorPoleFreqWeightFunction(int order, int ny) {return GetTerm3(WeightEpsLorPole,order,ny);}
 	//! Get the epsilon lorentz pole frequency weighting
 	double GetEpsLorPoleFreqWeighted(int order, int ny, const double* coords) {return GetWeight3(WeightEpsLorPole,order,ny,coords)*GetEpsLorPoleFreq(order,ny);}
+	//! Get the epsilon lorentz pole frequency weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetEpsLorPoleFreqWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightEpsLorPole,order,ny,numCoords,coords,values,GetEpsLorPoleFreq(order,ny));}
 
 	//! Set the epsilon relaxation time
 	void SetEpsRelaxTime(int order, double val, int ny=0) {SetValue3(val,EpsRelaxTime,order,ny);}
@@ -87,6 +91,8 @@ public:
 	const std::string GetEpsRelaxTimeWeightFunction(int order, int ny) {return GetTerm3(WeightEpsRelaxTime,order,ny);}
 	//! Get the epsilon relaxation time weighting
 	double GetEpsRelaxTimeWeighted(int order, int ny, const double* coords) {return GetWeight3(WeightEpsRelaxTime,order,ny,coords)*GetEpsRelaxTime(order,ny);}
+	//! Get the epsilon relaxation time weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetEpsRelaxTimeWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightEpsRelaxTime,order,ny,numCoords,coords,values,GetEpsRelaxTime(order,ny));}
 
 	//! Set the mue plasma frequency
 	void SetMuePlasmaFreq(int order, double val, int ny=0)  {SetValue3(val,MuePlasma,order,ny);}
@@ -103,6 +109,8 @@ public:
 	const std::string GetMuePlasmaFreqWeightFunction(int order, int ny) {return GetTerm3(WeightMuePlasma,order,ny);}
 	//! Get the mue plasma frequency weighting
 	double GetMuePlasmaFreqWeighted(int order, int ny, const double* coords)  {return GetWeight3(WeightMuePlasma,order,ny,coords)*GetMuePlasmaFreq(order,ny);}
+	//! Get the mue plasma frequency weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetMuePlasmaFreqWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightMuePlasma,order,ny,numCoords,coords,values,GetMuePlasmaFreq(order,ny));}
 
 	//! Set the mue lorentz pole frequency
 	void SetMueLorPoleFreq(int order, double val, int ny=0)  {SetValue3(val,MueLorPole,order,ny);}
@@ -119,6 +127,8 @@ public:
 	const std::string GetMueLorPoleFreqWeightFunction(int order, int ny) {return GetTerm3(WeightMueLorPole,order,ny);}
 	//! Get the mue lorentz pole frequency weighting
 	double GetMueLorPoleFreqWeighted(int order, int ny, const double* coords)  {return GetWeight3(WeightMueLorPole,order,ny,coords)*GetMueLorPoleFreq(order,ny);}
+	//! Get the mue lorentz pole frequency weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetMueLorPoleFreqWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightMueLorPole,order,ny,numCoords,coords,values,GetMueLorPoleFreq(order,ny));}
 
 	//! Set the mue relaxation time
 	void SetMueRelaxTime(int order, double val, int ny=0)  {SetValue3(val,MueRelaxTime,order,ny);}
@@ -135,6 +145,8 @@ public:
 	const std::string GetMueRelaxTimeWeightFunction(int order, int ny) {return GetTerm3(WeightMueRelaxTime,order,ny);}
 	//! Get the mue relaxation time weighting
 	double GetMueRelaxTimeWeighted(int order, int ny, const double* coords)  {return GetWeight3(WeightMueRelaxTime,order,ny,coords)*GetMueRelaxTime(order,ny);}
+	//! Get the mue relaxation time weighting at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once
+	void GetMueRelaxTimeWeighted(int order, int ny, size_t numCoords, const double* coords, double* values) {GetWeight3(WeightMueRelaxTime,order,ny,numCoords,coords,values,GetMueRelaxTime(order,ny));}
 
 	virtual bool Update(std::string *ErrStr=NULL);
 
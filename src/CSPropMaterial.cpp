@@ -19,6 +19,11 @@
 
 #include "CSPropMaterial.h"
 
+#include <algorithm>
+
+// number of coordinates of which the weighting function variables are set up at once
+#define WEIGHT_BLOCK_SIZE 64
+
 CSPropMaterial::CSPropMaterial(ParameterSet* paraSet) : CSProperties(paraSet)
 {
 	Type=MATERIAL;
@@ -89,37 +94,105 @@ double CSPropMaterial::GetWeight(ParameterScalar *ps, int ny, const double* coor
 
 double CSPropMaterial::GetWeight(ParameterScalar &ps, const double* coords)
 {
+	unsigned int used = ps.GetDependency();
+	if (used==0)
+		return ps.GetValue();
 	double paraVal[7];
-	if (coordInputType==1)
+	SetWeightVariables(1,coords,paraVal,used);
+
+	int EC=0;
+	double value = ps.GetEvaluated(paraVal,EC);
+	if (EC)
 	{
-		double rho = coords[0];
-		double alpha=coords[1];
-		paraVal[0] = rho*cos(alpha);
-		paraVal[1] = rho*sin(alpha);
-		paraVal[2] = coords[2]; //z
-		paraVal[3] = rho;
-		paraVal[4] = sqrt(pow(rho,2)+pow(coords[2],2)); // r
-		paraVal[5] = alpha; //alpha
-		paraVal[6] = asin(1)-atan(coords[2]/rho); //theta
+		std::cerr << "CSPropMaterial::GetWeight: Error evaluating the weighting function (ID: " << this->GetID() << "): " << PSErrorCode2Msg(EC) << std::endl;
 	}
-	else
+	return value;
+}
+
+void CSPropMaterial::GetWeight(ParameterScalar *ps, int ny, size_t numCoords, const double* coords, double* values, double value)
+{
+	if (bIsotropy) ny=0;
+	if ((ny>2) || (ny<0))
 	{
-		paraVal[0] = coords[0]; //x
-		paraVal[1] = coords[1]; //y
-		paraVal[2] = coords[2]; //z
-		paraVal[3] = sqrt(pow(coords[0],2)+pow(coords[1],2));		//rho
-		paraVal[4] = sqrt(pow(coords[0],2)+pow(coords[1],2)+pow(coords[2],2)); // r
-		paraVal[5] = atan2(coords[1],coords[0]); //alpha
-		paraVal[6] = asin(1)-atan(coords[2]/paraVal[3]); //theta
+		for (size_t n=0;n<numCoords;++n)
+			values[n] = 0;
+		return;
 	}
+	GetWeight(ps[ny],numCoords,coords,values,value);
+}
 
+void CSPropMaterial::GetWeight(ParameterScalar &ps, size_t numCoords, const double* coords, double* values, double value)
+{
+	unsigned int used = ps.GetDependency();
+	if (used==0)
+	{
+		double weight = ps.GetValue()*value;
+		for (size_t n=0;n<numCoords;++n)
+			values[n] = weight;
+		return;
+	}
+	double paraVal[7*WEIGHT_BLOCK_SIZE];
 	int EC=0;
-	double value = ps.GetEvaluated(paraVal,EC);
+	for (size_t start=0;start<numCoords;start+=WEIGHT_BLOCK_SIZE)
+	{
+		size_t count = std::min<size_t>(numCoords-start,WEIGHT_BLOCK_SIZE);
+		SetWeightVariables(count,&coords[3*start],paraVal,used);
+		int blockEC=0;
+		ps.GetEvaluated(count,paraVal,&values[start],blockEC);
+		if (EC==0)
+			EC = blockEC;
+		for (size_t n=start;n<start+count;++n)
+			values[n] *= value;
+	}
 	if (EC)
 	{
 		std::cerr << "CSPropMaterial::GetWeight: Error evaluating the weighting function (ID: " << this->GetID() << "): " << PSErrorCode2Msg(EC) << std::endl;
 	}
-	return value;
+}
+
+void CSPropMaterial::SetWeightVariables(size_t numCoords, const double* coords, double* paraVal, unsigned int used) const
+{
+	// every variable in a loop of its own, without branches, so the compiler can vectorize them
+	// the bits of used follow the order of the variables: x,y,z,rho,r,alpha,theta
+	if (coordInputType==CYLINDRICAL)
+	{
+		for (size_t n=0;n<numCoords;++n)
+		{
+			paraVal[7*n+3] = coords[3*n]; //rho
+			paraVal[7*n+5] = coords[3*n+1]; //alpha
+			paraVal[7*n+2] = coords[3*n+2]; //z
+		}
+		if (used & 1)
+			for (size_t n=0;n<numCoords;++n)
+				paraVal[7*n] = paraVal[7*n+3]*cos(paraVal[7*n+5]); //x
+		if (used & 2)
+			for (size_t n=0;n<numCoords;++n)
+				paraVal[7*n+1] = paraVal[7*n+3]*sin(paraVal[7*n+5]); //y
+		if (used & 16)
+			for (size_t n=0;n<numCoords;++n)
+				paraVal[7*n+4] = sqrt(paraVal[7*n+3]*paraVal[7*n+3]+paraVal[7*n+2]*paraVal[7*n+2]); // r
+	}
+	else
+	{
+		for (size_t n=0;n<numCoords;++n)
+		{
+			paraVal[7*n] = coords[3*n]; //x
+			paraVal[7*n+1] = coords[3*n+1]; //y
+			paraVal[7*n+2] = coords[3*n+2]; //z
+		}
+		if (used & (8|64))
+			for (size_t n=0;n<numCoords;++n)
+				paraVal[7*n+3] = sqrt(coords[3*n]*coords[3*n]+coords[3*n+1]*coords[3*n+1]); //rho
+		if (used & 16)
+			for (size_t n=0;n<numCoords;++n)
+				paraVal[7*n+4] = sqrt(coords[3*n]*coords[3*n]+coords[3*n+1]*coords[3*n+1]+coords[3*n+2]*coords[3*n+2]); // r
+		if (used & 32)
+			for (size_t n=0;n<numCoords;++n)
+				paraVal[7*n+5] = atan2(coords[3*n+1],coords[3*n]); //alpha
+	}
+	if (used & 64)
+		for (size_t n=0;n<numCoords;++n)
+			paraVal[7*n+6] = asin(1)-atan(paraVal[7*n+2]/paraVal[7*n+3]); //theta
 }
 
 void CSPropMaterial::Init()
@@ -249,6 +322,16 @@ bool CSPropMaterial::Update(std::string *ErrStr)
 		PSErrorCode2Msg(EC,ErrStr);
 	}
 
+	// find constant weighting functions and the coordinate variables used by all others
+	for (int n=0;n<3;++n)
+	{
+		WeightEpsilon[n].AnalyzeDependency();
+		WeightMue[n].AnalyzeDependency();
+		WeightKappa[n].AnalyzeDependency();
+		WeightSigma[n].AnalyzeDependency();
+	}
+	WeightDensity.AnalyzeDependency();
+
 	return bOK;
 }
 
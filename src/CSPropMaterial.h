@@ -49,6 +49,8 @@ public:
 	int SetEpsilonWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightEpsilon,ny);}
 	const std::string GetEpsilonWeightFunction(int ny)			{return GetTerm(WeightEpsilon,ny);}
 	virtual double GetEpsilonWeighted(int ny, const double* coords)	{return GetWeight(WeightEpsilon,ny,coords)*GetEpsilon(ny);}
+	//! Get the weighted epsilon at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once. \sa GetEpsilonWeighted
+	virtual void GetEpsilonWeighted(int ny, size_t numCoords, const double* coords, double* values)	{GetWeight(WeightEpsilon,ny,numCoords,coords,values,GetEpsilon(ny));}
 
 	void SetMue(double val, int ny=0)			{SetValue(val,Mue,ny);}
 	int SetMue(const std::string val, int ny=0)		{return SetValue(val,Mue,ny);}
@@ -58,6 +60,8 @@ public:
 	int SetMueWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightMue,ny);}
 	const std::string GetMueWeightFunction(int ny)			{return GetTerm(WeightMue,ny);}
 	virtual double GetMueWeighted(int ny, const double* coords)	{return GetWeight(WeightMue,ny,coords)*GetMue(ny);}
+	//! Get the weighted mue at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once. \sa GetMueWeighted
+	virtual void GetMueWeighted(int ny, size_t numCoords, const double* coords, double* values)	{GetWeight(WeightMue,ny,numCoords,coords,values,GetMue(ny));}
 
 	void SetKappa(double val, int ny=0)			{SetValue(val,Kappa,ny);}
 	int SetKappa(const std::string val, int ny=0)	{return SetValue(val,Kappa,ny);}
@@ -67,6 +71,8 @@ public:
 	int SetKappaWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightKappa,ny);}
 	const std::string GetKappaWeightFunction(int ny)				{return GetTerm(WeightKappa,ny);}
 	virtual double GetKappaWeighted(int ny, const double* coords)	{return GetWeight(WeightKappa,ny,coords)*GetKappa(ny);}
+	//! Get the weighted kappa at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once. \sa GetKappaWeighted
+	virtual void GetKappaWeighted(int ny, size_t numCoords, const double* coords, double* values)	{GetWeight(WeightKappa,ny,numCoords,coords,values,GetKappa(ny));}
 
 	void SetSigma(double val, int ny=0)			{SetValue(val,Sigma,ny);}
 	int SetSigma(const std::string val, int ny=0)	{return SetValue(val,Sigma,ny);}
@@ -76,6 +82,8 @@ public:
 	int SetSigmaWeightFunction(const std::string fct, int ny)	{return SetValue(fct,WeightSigma,ny);}
 	const std::string GetSigmaWeightFunction(int ny)				{return GetTerm(WeightSigma,ny);}
 	virtual double GetSigmaWeighted(int ny, const double* coords)	{return GetWeight(WeightSigma,ny,coords)*GetSigma(ny);}
+	//! Get the weighted sigma at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once. \sa GetSigmaWeighted
+	virtual void GetSigmaWeighted(int ny, size_t numCoords, const double* coords, double* values)	{GetWeight(WeightSigma,ny,numCoords,coords,values,GetSigma(ny));}
 
 	void SetDensity(double val)			{Density.SetValue(val);}
 	int SetDensity(const std::string val)	{return Density.SetValue(val);}
@@ -85,6 +93,8 @@ public:
 	int SetDensityWeightFunction(const std::string fct) {return WeightDensity.SetValue(fct);}
 	const std::string GetDensityWeightFunction() {return WeightDensity.GetString();}
 	virtual double GetDensityWeighted(const double* coords)	{return GetWeight(WeightDensity,coords)*GetDensity();}
+	//! Get the weighted density at numCoords coordinates (x1,y1,z1,x2,y2,z2,...) at once. \sa GetDensityWeighted
+	virtual void GetDensityWeighted(size_t numCoords, const double* coords, double* values)	{GetWeight(WeightDensity,numCoords,coords,values,GetDensity());}
 
 	void SetIsotropy(bool val) {bIsotropy=val;}
 	bool GetIsotropy() {return bIsotropy;}
@@ -112,5 +122,11 @@ protected:
 
 	double GetWeight(ParameterScalar &ps, const double* coords);
 	double GetWeight(ParameterScalar *ps, int ny, const double* coords);
+	//! Evaluate a weighting function at numCoords coordinates and multiply it with the given value
+	void GetWeight(ParameterScalar &ps, size_t numCoords, const double* coords, double* values, double value);
+	void GetWeight(ParameterScalar *ps, int ny, size_t numCoords, const double* coords, double* values, double value);
+	//! Set up the coordinate variables of the weighting functions (x,y,z,rho,r,alpha,theta) for numCoords coordinates, one set after the other.
+	//! Only the variables given by the bit mask used are guaranteed to be set. \sa ParameterScalar::GetDependency
+	void SetWeightVariables(size_t numCoords, const double* coords, double* paraVal, unsigned int used) const;
 	bool bIsotropy;
 };
@@ -51,6 +51,8 @@ CSProperties::CSProperties(CSProperties* prop, bool copyPrim)
 			prop->vPrimitives.at(i)->GetCopy(this);
 	m_Attribute_Name = prop->m_Attribute_Name;
 	m_Attribute_Value = prop->m_Attribute_Value;
+	m_PrimBoundBoxValid = false;
+	m_PrimBoundBoxFound = false;
 	InitCoordParameter();
 }
 
@@ -68,6 +70,8 @@ CSProperties::CSProperties(ParameterSet* paraSet)
 	FillColor.a=EdgeColor.a=255;
 	bVisible=true;
 	Type=ANY;
+	m_PrimBoundBoxValid = false;
+	m_PrimBoundBoxFound = false;
 	InitCoordParameter();
 }
 
@@ -85,6 +89,8 @@ CSProperties::CSProperties(unsigned int ID, ParameterSet* paraSet)
 	FillColor.a=EdgeColor.a=255;
 	bVisible=true;
 	Type=ANY;
+	m_PrimBoundBoxValid = false;
+	m_PrimBoundBoxFound = false;
 	InitCoordParameter();
 }
 
@@ -104,6 +110,7 @@ void CSProperties::SetCoordInputType(CoordinateSystem type, bool CopyToPrimitive
 	coordInputType = type;
 	if (CopyToPrimitives==false)
 		return;
+	InvalidatePrimitivesBoundBox();
 	for (size_t i=0;i<vPrimitives.size();++i)
 		vPrimitives.at(i)->SetCoordInputType(type);
 }
@@ -269,6 +276,46 @@ void CSProperties::AddPrimitive(CSPrimitives *prim)
 	prim->SetOwner(this);
 	vPrimitives.push_back(prim);
 	prim->SetProperty(this);
+	// a primitive with an up to date box only extends the cached union
+	double box[6];
+	bool extend = m_PrimBoundBoxValid && prim->IsBoundBoxCached() && prim->GetCachedBoundBox(box);
+	InvalidatePrimitivesBoundBox();
+	if (extend)
+	{
+		ExtendPrimitivesBoundBox(box);
+		m_PrimBoundBoxValid = true;
+	}
+}
+
+bool CSProperties::GetPrimitivesBoundBox(double box[6])
+{
+	if (m_PrimBoundBoxValid==false)
+	{
+		m_PrimBoundBoxFound = false;
+		double primBox[6];
+		for (size_t i=0;i<vPrimitives.size();++i)
+			if (vPrimitives.at(i)->GetCachedBoundBox(primBox))
+				ExtendPrimitivesBoundBox(primBox);
+		m_PrimBoundBoxValid = true;
+	}
+	for (int n=0;n<6;++n)
+		box[n] = m_PrimBoundBox[n];
+	return m_PrimBoundBoxFound;
+}
+
+void CSProperties::ExtendPrimitivesBoundBox(const double box[6])
+{
+	for (int n=0;n<3;++n)
+	{
+		m_PrimBoundBox[2*n] = m_PrimBoundBoxFound ? std::min(m_PrimBoundBox[2*n],box[2*n]) : box[2*n];
+		m_PrimBoundBox[2*n+1] = m_PrimBoundBoxFound ? std::max(m_PrimBoundBox[2*n+1],box[2*n+1]) : box[2*n+1];
+	}
+	m_PrimBoundBoxFound = true;
+}
+
+void CSProperties::InvalidatePrimitivesBoundBox()
+{
+	m_PrimBoundBoxValid = false;
 }
 
 bool CSProperties::HasPrimitive(CSPrimitives *prim)
@@ -289,6 +336,7 @@ void CSProperties::RemovePrimitive(CSPrimitives *prim)
 		{
 			std::vector<CSPrimitives*>::iterator iter=vPrimitives.begin()+i;
 			vPrimitives.erase(iter);
+			InvalidatePrimitivesBoundBox();
 			prim->SetOwner(NULL);   // ownership is handed back to the caller
 			prim->SetProperty(NULL);
 			return;
@@ -313,6 +361,7 @@ CSPrimitives* CSProperties::TakePrimitive(size_t index)
 	CSPrimitives* prim=vPrimitives.at(index);
 	std::vector<CSPrimitives*>::iterator iter=vPrimitives.begin()+index;
 	vPrimitives.erase(iter);
+	InvalidatePrimitivesBoundBox();
 	prim->SetOwner(NULL);   // ownership is handed back to the caller
 	return prim;
 }
@@ -150,6 +150,16 @@ public:
 
 	//! Get all Primitives \sa GetPrimitive
 	std::vector<CSPrimitives*> GetAllPrimitives() {return vPrimitives;}
+
+	//! Get the union of the accurate bounding boxes of all primitives, see CSPrimitives::GetCachedBoundBox
+	/*!
+	 The union is cached. An added primitive extends it, it is only recomputed after a primitive was removed or modified.
+	 A primitive modified through a parameter requires an Update() of the structure.
+	 \return false if no primitive has an accurate bounding box.
+	 */
+	bool GetPrimitivesBoundBox(double box[6]);
+	//! Drop the cached union of the primitive bounding boxes, e.g. because a primitive was modified. \sa GetPrimitivesBoundBox
+	void InvalidatePrimitivesBoundBox();
 	
 	//! Set a fill-color for this property. \sa GetFillColor
 	void SetFillColor(RGBa color);
@@ -231,6 +241,12 @@ protected:
 
 	std::vector<CSPrimitives*> vPrimitives;
 
+	//! Cached union of the primitive bounding boxes, see GetPrimitivesBoundBox
+	void ExtendPrimitivesBoundBox(const double box[6]);
+	bool m_PrimBoundBoxValid;
+	bool m_PrimBoundBoxFound;
+	double m_PrimBoundBox[6];
+
 	//! List of additional attribute names
 	std::vector<std::string> m_Attribute_Name;
 	//! List of additional attribute values
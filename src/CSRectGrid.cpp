@@ -22,6 +22,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <iostream>
+#include <math.h>
+#include <set>
+#include <queue>
+#include <functional>
+
+#define _C0_ 299792458.0
 
 CSRectGrid::CSRectGrid(void)
 {
@@ -57,6 +63,19 @@ void CSRectGrid::AddDiscLines(int direct, int numLines, double* vals)
 	}
 }
 
+void CSRectGrid::MergeDiscLines(int direct, std::vector<double> vals)
+{
+	if ((direct<0)||(direct>=3)) return;
+	std::sort(vals.begin(), vals.end());
+	std::vector<double> &lines = Lines[direct];
+	if (std::is_sorted(lines.begin(), lines.end())==false)
+		std::sort(lines.begin(), lines.end());
+	size_t mid = lines.size();
+	lines.insert(lines.end(), vals.begin(), vals.end());
+	std::inplace_merge(lines.begin(), lines.begin()+mid, lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+}
+
 std::string CSRectGrid::AddDiscLines(int direct, int numLines, double* vals, std::string DistFunction)
 {
 	if ((direct<0)||(direct>=3)) return std::string("Unknown grid direction!");
@@ -156,6 +175,18 @@ double* CSRectGrid::GetLines(int direct, double *array, unsigned int &qty, bool
 	return array;
 }
 
+std::vector<double> CSRectGrid::GetSamplePositions(int direct, bool cellCenter)
+{
+	std::vector<double> pos;
+	if ((direct<0) || (direct>=3)) return pos;
+	Sort(direct);
+	if (cellCenter==false)
+		return Lines[direct];
+	for (size_t i=1;i<Lines[direct].size();++i)
+		pos.push_back(0.5*(Lines[direct].at(i-1)+Lines[direct].at(i)));
+	return pos;
+}
+
 size_t CSRectGrid::GetQtyLines(int direct)
 {
 	if ((direct>=0) && (direct<3))
@@ -178,24 +209,72 @@ std::string CSRectGrid::GetLinesAsString(int direct)
 	return xStr.str();
 }
 
-unsigned int CSRectGrid::Snap2LineNumber(int ny, double value, bool &inside) const
+unsigned int CSRectGrid::SnapSorted(const std::vector<double>& lines, size_t first, double value, bool &inside)
 {
 	inside = false;
-	if ((ny<0) || (ny>2))
-		return -1;
-	if (Lines[ny].size()==0)
+	if (lines.size()==0)
 		return -1;
-	if (value<Lines[ny].at(0))
+	if (value<lines.front())
 		return 0;
-	if (value>Lines[ny].at(Lines[ny].size()-1))
-		return Lines[ny].size()-1;
+	if (value>lines.back())
+		return lines.size()-1;
 	inside = true;
-	for (size_t n=0;n<Lines[ny].size()-1;++n)
+	// first line above value, the nearest line is this or the one before
+	size_t n = std::upper_bound(lines.begin()+first, lines.end(), value) - lines.begin();
+	if (n==lines.size())
+		return lines.size()-1;
+	if (value < 0.5*(lines[n-1]+lines[n]))
+		return n-1;
+	return n;
+}
+
+unsigned int CSRectGrid::Snap2LineNumber(int ny, double value, bool &inside) const
+{
+	inside = false;
+	if ((ny<0) || (ny>2))
+		return -1;
+	return SnapSorted(Lines[ny], 0, value, inside);
+}
+
+bool CSRectGrid::Snap2LineNumbers(int ny, const double* values, unsigned int count, unsigned int* lines, bool* inside) const
+{
+	if ((ny<0) || (ny>2) || (Lines[ny].size()==0))
+		return false;
+	bool in;
+	size_t first = 0;
+	for (unsigned int n=0;n<count;++n)
 	{
-		if (value < 0.5*(Lines[ny].at(n)+Lines[ny].at(n+1)) )
-			return n;
+		// ascending values continue the search behind the last hit
+		if ((n==0) || (values[n]<values[n-1]))
+			first = 0;
+		lines[n] = SnapSorted(Lines[ny], first, values[n], in);
+		if (in && (lines[n]>0))
+			first = lines[n]-1;
+		if (inside)
+			inside[n] = in;
+	}
+	return true;
+}
+
+bool CSRectGrid::SnapBox2LineNumbers(const double box[6], unsigned int lines[6], bool inside[6]) const
+{
+	bool ok = true;
+	for (int ny=0;ny<3;++ny)
+	{
+		double vals[2] = {box[2*ny], box[2*ny+1]};
+		bool in[2] = {false, false};
+		if (Snap2LineNumbers(ny, vals, 2, &lines[2*ny], in)==false)
+		{
+			lines[2*ny] = lines[2*ny+1] = -1;
+			ok = false;
+		}
+		if (inside)
+		{
+			inside[2*ny]   = in[0];
+			inside[2*ny+1] = in[1];
+		}
 	}
-	return Lines[ny].size()-1;
+	return ok;
 }
 
 int CSRectGrid::GetDimension()
@@ -263,6 +342,452 @@ bool CSRectGrid::isValid()
 	return true;
 }
 
+namespace
+{
+//! Sort the lines, remove duplicates and lines closer to their successor than tol times the mean line distance.
+void UniqueLines(std::vector<double>& lines, double tol=1e-7)
+{
+	std::sort(lines.begin(), lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+	if (lines.size()<2)
+		return;
+	double min_dl = (lines.back()-lines.front())/(lines.size()-1)*tol;
+	size_t k = 0;
+	for (size_t n=0;n<lines.size();++n)
+		if ((n+1==lines.size()) || (lines[n+1]-lines[n]>=min_dl))
+			lines[k++] = lines[n];
+	lines.resize(k);
+}
+
+//! Lines from 0 to rng, starting with start_res and growing by ratio up to max_res.
+std::vector<double> OneSideTaper(double rng, double start_res, double ratio, double max_res)
+{
+	std::vector<double> lines(1,0);
+	double res = start_res;
+	double pos = 0;
+	int N = 0;
+	while ((res<max_res) && (pos<rng))
+	{
+		res *= ratio;
+		pos += res;
+		++N;
+	}
+	if (pos>rng)
+	{
+		// the taper does not fit, shrink it to the range
+		double sum = 0;
+		for (int n=1;n<=N;++n)
+		{
+			sum += start_res*pow(ratio,n);
+			lines.push_back(sum*rng/pos);
+		}
+		return lines;
+	}
+
+	// reach max_res exactly after N steps and fill the rest with max_res
+	double taper_ratio = exp((log(max_res)-log(start_res))/N);
+	pos = 0;
+	res = start_res;
+	for (int n=0;n<N;++n)
+	{
+		res *= taper_ratio;
+		pos += res;
+		lines.push_back(pos);
+	}
+	while (pos<rng)
+	{
+		pos += max_res;
+		lines.push_back(pos);
+	}
+	double scale = rng/lines.back();
+	for (size_t n=0;n<lines.size();++n)
+		lines[n] *= scale;
+	return lines;
+}
+
+//! Map the relative lines from 0 to length onto start to stop, keeping start and stop exact.
+std::vector<double> MapRange(std::vector<double> rel, double length, double start, double stop)
+{
+	UniqueLines(rel);
+	std::vector<double> lines(1,start);
+	for (size_t n=1;n+1<rel.size();++n)
+		lines.push_back(start + rel[n]*(stop-start)/length);
+	lines.push_back(stop);
+	return lines;
+}
+
+//! Number of steps growing res by ratio up to max_res, and the ratio reaching max_res exactly in this number of steps.
+int TaperSteps(double res, double ratio, double max_res, double &exact_ratio)
+{
+	int N = 0;
+	double r = res;
+	while (r<max_res)
+	{
+		r *= ratio;
+		++N;
+	}
+	exact_ratio = exp((log(max_res)-log(res))/N);
+	return N;
+}
+
+//! Snap lines within tol (relative to the range of ref) of a sorted reference line onto that exact reference line.
+void SnapToLines(std::vector<double>& lines, const std::vector<double>& ref, double tol=1e-10)
+{
+	if (ref.size()<2)
+		return;
+	double abs_tol = (ref.back()-ref.front())*tol;
+	for (size_t n=0;n<lines.size();++n)
+	{
+		size_t idx = std::lower_bound(ref.begin(), ref.end(), lines[n]) - ref.begin();
+		idx = std::min(std::max(idx, (size_t)1), ref.size()-1);
+		double nearest = (lines[n]-ref[idx-1] <= ref[idx]-lines[n]) ? ref[idx-1] : ref[idx];
+		if (fabs(lines[n]-nearest)<=abs_tol)
+			lines[n] = nearest;
+	}
+}
+
+//! Linear histogram of the values from lo to hi, all values in the first bin if lo==hi
+void Histogram(const std::vector<double>& values, double lo, double hi, unsigned int numBins, std::vector<double> &bins, std::vector<unsigned int> &hist)
+{
+	bins.resize(numBins+1);
+	for (unsigned int n=0;n<=numBins;++n)
+		bins[n] = lo + (hi-lo)*n/numBins;
+	hist.assign(numBins, 0);
+	for (size_t n=0;n<values.size();++n)
+	{
+		unsigned int bin = 0;
+		if (hi>lo)
+			bin = std::min(numBins-1, (unsigned int)((values[n]-lo)/(hi-lo)*numBins));
+		++hist[bin];
+	}
+}
+}
+
+std::vector<double> CSRectGrid::SmoothRange(double start, double stop, double start_res, double stop_res, double max_res, double ratio)
+{
+	std::vector<double> lines;
+	if ((ratio<=1) || (start_res<=0) || (stop_res<=0) || (max_res<=0))
+		return lines;
+	double rng = stop-start;
+
+	// very small range
+	if ((rng<max_res) && (rng<start_res*ratio) && (rng<stop_res*ratio))
+	{
+		lines.push_back(start);
+		lines.push_back(stop);
+		UniqueLines(lines);
+		return lines;
+	}
+
+	// no taper needed at either end
+	double limit = max_res/ratio;
+	if ((start_res>=limit) && (stop_res>=limit))
+	{
+		int N = (int)ceil(rng/max_res);
+		double step = rng/N;
+		lines.push_back(start);
+		for (int n=1;n<N;++n)
+			lines.push_back(n*step+start);
+		lines.push_back(stop);
+		return lines;
+	}
+
+	// taper at the start only
+	if ((start_res<limit) && (stop_res>=limit))
+	{
+		std::vector<double> taper = OneSideTaper(rng, start_res, ratio, max_res);
+		lines.push_back(start);
+		for (size_t n=1;n+1<taper.size();++n)
+			lines.push_back(start+taper[n]);
+		lines.push_back(stop);
+		return lines;
+	}
+
+	// taper at the stop only
+	if ((start_res>=limit) && (stop_res<limit))
+	{
+		std::vector<double> taper = OneSideTaper(rng, stop_res, ratio, max_res);
+		lines.push_back(start);
+		for (size_t n=taper.size()-2;n>=1;--n)
+			lines.push_back(stop-taper[n]);
+		lines.push_back(stop);
+		return lines;
+	}
+
+	// taper at both ends, check if the full tapers up to max_res fit into the range
+	double ratio1, ratio2;
+	int N1 = TaperSteps(start_res, ratio, max_res, ratio1);
+	int N2 = TaperSteps(stop_res, ratio, max_res, ratio2);
+	double pos1 = 0;
+	for (int n=1;n<=N1;++n)
+		pos1 += start_res*pow(ratio1,n);
+	double pos2 = 0;
+	for (int n=1;n<=N2;++n)
+		pos2 += stop_res*pow(ratio2,n);
+
+	std::vector<double> l(1,0), r(1,0);
+	if (pos1+pos2<rng)
+	{
+		for (int n=1;n<=N1;++n)
+			l.push_back(l.back()+start_res*pow(ratio1,n));
+		for (int n=1;n<=N2;++n)
+			r.push_back(r.back()+stop_res*pow(ratio2,n));
+		int N = (int)ceil((rng-pos1-pos2)/max_res);
+		for (int n=0;n<N;++n)
+			l.push_back(l.back()+max_res);
+	}
+	else
+	{
+		// grow the finer end until both tapers meet
+		while (l.back()+r.back()<rng)
+		{
+			if (start_res==stop_res)
+			{
+				start_res *= ratio;
+				l.push_back(l.back()+start_res);
+				stop_res *= ratio;
+				r.push_back(r.back()+stop_res);
+			}
+			else if (start_res<stop_res)
+			{
+				start_res *= ratio;
+				l.push_back(l.back()+start_res);
+			}
+			else
+			{
+				stop_res *= ratio;
+				r.push_back(r.back()+stop_res);
+			}
+		}
+	}
+	double length = l.back()+r.back();
+	for (size_t n=0;n<r.size();++n)
+		l.push_back(length-r[n]);
+	return MapRange(l, length, start, stop);
+}
+
+int CSRectGrid::CheckSymmetry(const std::vector<double>& lines)
+{
+	const double tolerance = 1e-10;
+	size_t NP = lines.size();
+	if (NP<=2)
+		return 0;
+	double line_range = lines.back()-lines.front();
+	double center = 0.5*(lines.back()+lines.front());
+
+	for (size_t n=0;n<NP/2;++n)
+		if (fabs((center-lines[n])-(lines[NP-n-1]-center)) > line_range*tolerance)
+			return 0;
+
+	// the center line has to be the center of symmetry
+	if ((NP%2==1) && (fabs(lines[NP/2]-center) > line_range*tolerance))
+		return 0;
+
+	return (NP%2==0) ? 2 : 1;
+}
+
+std::vector<double> CSRectGrid::SmoothMeshLines(const std::vector<double>& lines, double max_res, double ratio, bool check_symmetry)
+{
+	std::vector<double> out = lines;
+	UniqueLines(out);
+	if ((max_res<=0) || (ratio<=1) || (out.size()<2))
+		return out;
+	const std::vector<double> orig = out;
+
+	int sym = check_symmetry ? CheckSymmetry(out) : 0;
+	double center = 0.5*(out.back()+out.front());
+	if (sym==1)
+		out.resize(out.size()/2+1);
+	else if (sym==2)
+		out.resize(out.size()/2);
+
+	// cells larger than max_res by size and start, the smallest is smoothed first
+	typedef std::pair<double,double> Cell;
+	std::priority_queue<Cell, std::vector<Cell>, std::greater<Cell> > cells;
+	const double max_tol = max_res*(1+1e-10);
+	size_t too_large = 0;
+	auto add_cell = [&](double a, double b)
+	{
+		if (b-a<=max_res)
+			return;
+		cells.push(Cell(b-a,a));
+		if (b-a>max_tol)
+			++too_large;
+	};
+	for (size_t n=0;n+1<out.size();++n)
+		add_cell(out[n], out[n+1]);
+
+	std::set<double> mesh(out.begin(), out.end());
+	while (too_large>0)
+	{
+		Cell cell = cells.top();
+		cells.pop();
+		if (cell.first>max_tol)
+			--too_large;
+
+		// a cell is only split once taken, its lines are still neighbors
+		std::set<double>::iterator first = mesh.find(cell.second);
+		std::set<double>::iterator last = std::next(first);
+		double start_res = (first==mesh.begin()) ? max_res : *first-*std::prev(first);
+		double stop_res = (std::next(last)==mesh.end()) ? max_res : *std::next(last)-*last;
+		std::vector<double> l = SmoothRange(*first, *last, start_res, stop_res, max_res, ratio);
+
+		// a uniform split of the cell if the smoothing did not return any inner line
+		if (l.size()<3)
+		{
+			size_t num = (size_t)ceil((*last-*first)/max_res);
+			l.clear();
+			for (size_t n=0;n<=num;++n)
+				l.push_back(*first+(*last-*first)*n/num);
+		}
+
+		// drop new lines too close to an existing one, as UniqueLines on the full mesh would
+		double min_dl = (*mesh.rbegin()-*mesh.begin())/(mesh.size()+l.size()-3)*1e-7;
+		double prev = *first;
+		for (size_t n=1;n+1<l.size();++n)
+		{
+			if ((l[n]-prev<min_dl) || (*last-l[n]<min_dl))
+				continue;
+			mesh.insert(last, l[n]);
+			add_cell(prev, l[n]);
+			prev = l[n];
+		}
+		// the cell is not split at all only with a max. resolution below the line tolerance, it is left as it is
+		if (prev!=*first)
+			add_cell(prev, *last);
+	}
+	out.assign(mesh.begin(), mesh.end());
+
+	if (sym==1)
+	{
+		for (size_t n=out.size()-1;n>0;--n)
+			out.push_back(2*center-out[n-1]);
+		UniqueLines(out);
+		SnapToLines(out, orig);
+	}
+	else if (sym==2)
+	{
+		double dl = out[out.size()-1]-out[out.size()-2];
+		std::vector<double> l = SmoothRange(out.back(), 2*center-out.back(), dl, dl, max_res, ratio);
+		for (size_t n=out.size();n>0;--n)
+			out.push_back(2*center-out[n-1]);
+		out.insert(out.end(), l.begin(), l.end());
+		UniqueLines(out);
+		SnapToLines(out, orig);
+	}
+	else
+		UniqueLines(out);
+	return out;
+}
+
+bool CSRectGrid::SmoothMeshLines(int direct, double max_res, double ratio, bool check_symmetry)
+{
+	if ((direct<0) || (direct>=3))
+		return false;
+	if ((max_res<=0) || (ratio<=1))
+		return false;
+	Lines[direct] = SmoothMeshLines(Lines[direct], max_res, ratio, check_symmetry);
+	// the mirrored half of a symmetric mesh may differ by rounding
+	const double max_tol = max_res*(1+1e-6);
+	for (size_t n=1;n<Lines[direct].size();++n)
+		if (Lines[direct][n]-Lines[direct][n-1]>max_tol)
+			return false;
+	return true;
+}
+
+bool CSRectGrid::AnalyseMesh(int direct, MeshQuality &quality, unsigned int numBins) const
+{
+	if ((direct<0) || (direct>=3))
+	{
+		quality.numLines = 0;
+		return false;
+	}
+	return AnalyseMesh(Lines[direct], quality, numBins);
+}
+
+bool CSRectGrid::AnalyseMesh(const std::vector<double>& lines, MeshQuality &quality, unsigned int numBins)
+{
+	// the lines of a grid are usually sorted already, only others need a sorted copy
+	std::vector<double> copy;
+	const std::vector<double>* l = &lines;
+	if ((std::is_sorted(lines.begin(), lines.end())==false) || (std::adjacent_find(lines.begin(), lines.end())!=lines.end()))
+	{
+		copy = lines;
+		std::sort(copy.begin(), copy.end());
+		copy.erase(std::unique(copy.begin(), copy.end()), copy.end());
+		l = &copy;
+	}
+	quality.numLines = l->size();
+	quality.res_bins.clear();
+	quality.res_hist.clear();
+	quality.ratio_bins.clear();
+	quality.ratio_hist.clear();
+	if (l->size()<2)
+		return false;
+	if (numBins<1)
+		numBins = 1;
+
+	std::vector<double> res(l->size()-1);
+	std::vector<double> ratio(res.size()-1);
+	for (size_t n=0;n<res.size();++n)
+		res[n] = (*l)[n+1]-(*l)[n];
+	quality.min_res = quality.max_res = res[0];
+	quality.min_res_idx = quality.max_res_idx = 0;
+	quality.max_ratio = 1;
+	quality.max_ratio_idx = 0;
+	for (size_t n=1;n<res.size();++n)
+	{
+		if (res[n]<quality.min_res)
+		{
+			quality.min_res = res[n];
+			quality.min_res_idx = n;
+		}
+		if (res[n]>quality.max_res)
+		{
+			quality.max_res = res[n];
+			quality.max_res_idx = n;
+		}
+		ratio[n-1] = (res[n]>res[n-1]) ? res[n]/res[n-1] : res[n-1]/res[n];
+		if (ratio[n-1]>quality.max_ratio)
+		{
+			quality.max_ratio = ratio[n-1];
+			quality.max_ratio_idx = n;
+		}
+	}
+	quality.homogeneous = (quality.max_res-quality.min_res <= 1e-10*quality.max_res);
+	quality.symmetric = CheckSymmetry(*l);
+
+	Histogram(res, quality.min_res, quality.max_res, numBins, quality.res_bins, quality.res_hist);
+	Histogram(ratio, 1, quality.max_ratio, numBins, quality.ratio_bins, quality.ratio_hist);
+	return true;
+}
+
+double CSRectGrid::GetCFLTimestep() const
+{
+	double inv_dl2 = 0;
+	for (int n=0;n<3;++n)
+	{
+		MeshQuality quality;
+		if (AnalyseMesh(Lines[n], quality, 1)==false)
+			continue;
+		double dl = quality.min_res*dDeltaUnit;
+		if ((m_meshType==CYLINDRICAL) && (n==1))
+		{
+			// the alpha cells are smallest at the smallest positive radius
+			double r = 0;
+			for (size_t i=0;i<Lines[0].size();++i)
+				if ((Lines[0][i]>0) && ((r==0) || (Lines[0][i]<r)))
+					r = Lines[0][i];
+			if (r==0)
+				continue;
+			dl *= r;
+		}
+		inv_dl2 += 1/(dl*dl);
+	}
+	if (inv_dl2==0)
+		return 0;
+	return 1/(_C0_*sqrt(inv_dl2));
+}
 
 bool CSRectGrid::Write2XML(TiXmlNode &root, bool sorted)
 {
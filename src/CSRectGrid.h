@@ -53,6 +53,8 @@ public:
 	void AddDiscLine(int direct, double val);
 	void AddDiscLines(int direct, int numLines, double* vals);
 	std::string AddDiscLines(int direct, int numLines, double* vals, std::string DistFunction);
+	//! Merge the given lines into the lines of a direction, which are sorted and unique afterwards. Already sorted lines are merged without sorting them again.
+	void MergeDiscLines(int direct, std::vector<double> vals);
 
 	//! Remove the disc-line at certain index and direction.
 	bool RemoveDiscLine(int direct, int index);
@@ -87,8 +89,41 @@ public:
 	//! Get disc-lines as a comma-seperated string for given direction
 	std::string GetLinesAsString(int direct);
 
+	//! Get the sampling positions in a certain direction, the sorted disc-lines or the centers between them.
+	/*!
+	\param direct The direction of interest.
+	\param cellCenter Get the N-1 cell centers instead of the N disc-lines.
+	 */
+	std::vector<double> GetSamplePositions(int direct, bool cellCenter=false);
+
 	//! Snap a given value to a grid line for the given direction
+	/*!
+	The lines have to be sorted, see Sort(). The nearest line is found by a binary search.
+	\param ny The direction of interest.
+	\param value The value to snap.
+	\param inside Set to false if the value is outside the grid (snapped to the first or last line).
+	\return The index of the nearest line, -1 if the direction has no lines.
+	 */
 	unsigned int Snap2LineNumber(int ny, double value, bool &inside) const;
+	//! Snap an array of values to grid lines for the given direction, same as calling Snap2LineNumber for each value.
+	/*!
+	Runs of ascending values continue the search behind the previous line found, sorted probe positions are therefore cheapest.
+	\param ny The direction of interest.
+	\param values The values to snap.
+	\param count Number of values.
+	\param lines Array of size count for the line indices.
+	\param inside Optional array of size count for the inside flags.
+	\return false if the direction is invalid or has no lines.
+	 */
+	bool Snap2LineNumbers(int ny, const double* values, unsigned int count, unsigned int* lines, bool* inside=NULL) const;
+	//! Snap a bounding box (xmin,xmax,ymin,ymax,zmin,zmax) to grid lines in all directions.
+	/*!
+	\param box The bounding box to snap.
+	\param lines The line indices in the same order as the box.
+	\param inside Optional inside flags in the same order as the box.
+	\return false if a direction has no lines, its line indices are set to -1.
+	 */
+	bool SnapBox2LineNumbers(const double box[6], unsigned int lines[6], bool inside[6]=NULL) const;
 
 	//! Write the grid to a given XML-node.
 	bool Write2XML(TiXmlNode &root, bool sorted=false);
@@ -116,7 +151,73 @@ public:
 	//! This will check if the given mesh is a valid 3D mesh (at least 2 lines in all directions);
 	bool isValid();
 
+	//! Smooth the lines in a given direction, see SmoothMeshLines(const std::vector<double>&, double, double, bool). \return false on an invalid direction, resolution or ratio, or if a cell is still larger than max_res.
+	bool SmoothMeshLines(int direct, double max_res, double ratio=1.5, bool check_symmetry=true);
+
+	//! Smooth the given mesh lines with a max. resolution and a max. ratio of neighboring cell sizes.
+	/*!
+	The fixed lines are kept, the cells too large are filled in the order of increasing size, each graded towards its neighbors.
+	A cell the grading fails for is split uniformly. Only a max_res below the tolerance of merged lines leaves cells larger than max_res.
+	\param lines The fixed mesh lines, need not be sorted.
+	\param max_res Max. allowed distance of two lines.
+	\param ratio Max. ratio of neighboring cell sizes, has to be larger than one.
+	\param check_symmetry Detect a symmetric mesh and smooth only one half, which is mirrored afterwards.
+	\return The sorted smooth mesh lines, the sorted input lines if max_res or ratio are invalid.
+	 */
+	static std::vector<double> SmoothMeshLines(const std::vector<double>& lines, double max_res, double ratio=1.5, bool check_symmetry=true);
+	//! Create the lines from start to stop with a max. resolution, graded from start_res and stop_res at the ends by ratio. \return An empty vector for a ratio not larger than one or a resolution not larger than zero.
+	static std::vector<double> SmoothRange(double start, double stop, double start_res, double stop_res, double max_res, double ratio);
+	//! Check the sorted lines for symmetry. \return 0 if not symmetric, 1 for a symmetric odd number of lines (with a center line) and 2 for an even number.
+	static int CheckSymmetry(const std::vector<double>& lines);
+
+	//! Quality figures of the mesh lines in one direction, see AnalyseMesh()
+	struct MeshQuality
+	{
+		//! number of unique lines
+		size_t numLines;
+		//! smallest cell, between the (sorted) lines min_res_idx and min_res_idx+1
+		double min_res;
+		size_t min_res_idx;
+		//! largest cell, between the lines max_res_idx and max_res_idx+1
+		double max_res;
+		size_t max_res_idx;
+		//! largest ratio of two neighboring cell sizes (>=1), at the line max_ratio_idx between them
+		double max_ratio;
+		size_t max_ratio_idx;
+		bool homogeneous;
+		//! see CheckSymmetry()
+		int symmetric;
+		//! histogram of the cell sizes, res_hist[n] counts the cells from res_bins[n] to res_bins[n+1]
+		std::vector<double> res_bins;
+		std::vector<unsigned int> res_hist;
+		//! histogram of the neighboring cell size ratios, from one to max_ratio
+		std::vector<double> ratio_bins;
+		std::vector<unsigned int> ratio_hist;
+	};
+	//! Analyse the lines in a given direction, see AnalyseMesh(const std::vector<double>&, MeshQuality&, unsigned int).
+	bool AnalyseMesh(int direct, MeshQuality &quality, unsigned int numBins=10) const;
+	//! Analyse the given mesh lines for the smallest and largest cells and the largest ratio of neighboring cells.
+	/*!
+	Sorted unique lines are analysed in a single pass, other lines are sorted first.
+	\param lines The mesh lines.
+	\param quality The figures found, numLines is set even on failure.
+	\param numBins Number of bins of the histograms.
+	\return false if there are less than two lines.
+	 */
+	static bool AnalyseMesh(const std::vector<double>& lines, MeshQuality &quality, unsigned int numBins=10);
+	//! Estimate the max. stable FDTD time step (CFL criterion) of this grid in seconds, using the drawing unit.
+	/*!
+	The smallest cells of all directions are combined, in a rectilinear grid that cell always exists.
+	In a cylindrical grid the smallest alpha cell is taken at the smallest positive radius.
+	A direction with less than two lines is ignored.
+	\return The time step, 0 if no direction has any cell.
+	 */
+	double GetCFLTimestep() const;
+
 protected:
+	//! Snap a value to the sorted lines, searching from line index first on.
+	static unsigned int SnapSorted(const std::vector<double>& lines, size_t first, double value, bool &inside);
+
 	std::vector<double> Lines[3];
 	double dDeltaUnit;
 	double SimBox[6];
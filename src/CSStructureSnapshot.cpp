@@ -0,0 +1,167 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <thread>
+
+#include "CSStructureSnapshot.h"
+#include "CSPrimitives.h"
+#include "CSPropMaterial.h"
+
+CSStructureSnapshot::CSStructureSnapshot(const std::vector<CSProperties*> &props, CoordinateSystem cs, double tol)
+{
+	m_Properties = props;
+	m_MeshType = cs;
+	m_Tolerance = tol;
+
+	for (size_t i=0;i<m_Properties.size();++i)
+	{
+		CSPropMaterial* mat = m_Properties.at(i)->ToMaterial();
+		if (mat==NULL)
+		{
+			m_MaterialIndex.push_back(-1);
+			continue;
+		}
+		MaterialValues values;
+		for (int n=0;n<3;++n)
+		{
+			values.epsilon[n] = mat->GetEpsilon(n);
+			values.mue[n] = mat->GetMue(n);
+			values.kappa[n] = mat->GetKappa(n);
+			values.sigma[n] = mat->GetSigma(n);
+		}
+		values.density = mat->GetDensity();
+		m_MaterialIndex.push_back((int)m_Materials.size());
+		m_Materials.push_back(values);
+	}
+
+	m_BVH.Build(m_Properties, m_MeshType);
+	m_Usage.reset(new std::atomic<unsigned long>[m_BVH.GetQtyPrimitives()]);
+	ResetPrimitiveUsage();
+}
+
+CSStructureSnapshot::~CSStructureSnapshot()
+{
+}
+
+CSProperties* CSStructureSnapshot::GetProperty(size_t index) const
+{
+	if (index<m_Properties.size())
+		return m_Properties.at(index);
+	return NULL;
+}
+
+const CSStructureSnapshot::MaterialValues* CSStructureSnapshot::GetMaterialValues(size_t index) const
+{
+	if ((index>=m_MaterialIndex.size()) || (m_MaterialIndex.at(index)<0))
+		return NULL;
+	return &m_Materials.at(m_MaterialIndex.at(index));
+}
+
+int CSStructureSnapshot::GetPropertyIndexByCoordPriority(const double* coord, CSProperties::PropertyType type, bool countUsage, CSPrimitives** foundPrimitive) const
+{
+	int entry = m_BVH.FindEntry(coord, type, m_Tolerance);
+	if (foundPrimitive)
+		*foundPrimitive = (entry<0) ? NULL : m_BVH.GetEntryPrimitive(entry);
+	if (entry<0)
+		return -1;
+	if (countUsage)
+		m_Usage[entry].fetch_add(1, std::memory_order_relaxed);
+	return (int)m_BVH.GetEntryPropertyIndex(entry);
+}
+
+CSProperties* CSStructureSnapshot::GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type, bool countUsage, CSPrimitives** foundPrimitive) const
+{
+	int index = GetPropertyIndexByCoordPriority(coord, type, countUsage, foundPrimitive);
+	if (index<0)
+		return NULL;
+	return m_Properties.at(index);
+}
+
+void CSStructureSnapshot::GetPropertyIndicesByCoordsPriority(size_t numCoords, const double* coords, int* indices, CSProperties::PropertyType type, bool countUsage, unsigned int numThreads) const
+{
+	if ((numCoords==0) || (indices==NULL))
+		return;
+
+	if (numThreads==0)
+		numThreads = std::thread::hardware_concurrency();
+	// a thread per few coordinates is not worth its start-up
+	size_t maxThreads = numCoords/256+1;
+	if (numThreads>maxThreads)
+		numThreads = (unsigned int)maxThreads;
+
+	if (numThreads<=1)
+	{
+		FindIndices(0, numCoords, coords, indices, type, countUsage);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	size_t block = numCoords/numThreads;
+	size_t start = 0;
+	for (unsigned int n=0;n<numThreads;++n)
+	{
+		size_t stop = start + block + (n < numCoords%numThreads ? 1 : 0);
+		threads.push_back(std::thread(&CSStructureSnapshot::FindIndices, this, start, stop, coords, indices, type, countUsage));
+		start = stop;
+	}
+	for (size_t n=0;n<threads.size();++n)
+		threads.at(n).join();
+}
+
+void CSStructureSnapshot::FindIndices(size_t start, size_t stop, const double* coords, int* indices, CSProperties::PropertyType type, bool countUsage) const
+{
+	// count locally, a shared counter per hit would be contended by all threads
+	std::vector<unsigned long> usage;
+	if (countUsage)
+		usage.resize(m_BVH.GetQtyPrimitives(),0);
+	for (size_t n=start;n<stop;++n)
+	{
+		int entry = m_BVH.FindEntry(&coords[3*n], type, m_Tolerance);
+		if (entry<0)
+		{
+			indices[n] = -1;
+			continue;
+		}
+		indices[n] = (int)m_BVH.GetEntryPropertyIndex(entry);
+		if (countUsage)
+			++usage[entry];
+	}
+	for (size_t n=0;n<usage.size();++n)
+		if (usage[n]>0)
+			m_Usage[n].fetch_add(usage[n], std::memory_order_relaxed);
+}
+
+unsigned long CSStructureSnapshot::GetPrimitiveUsage(const CSPrimitives* prim) const
+{
+	for (size_t n=0;n<m_BVH.GetQtyPrimitives();++n)
+		if (m_BVH.GetEntryPrimitive(n)==prim)
+			return m_Usage[n].load();
+	return 0;
+}
+
+void CSStructureSnapshot::ResetPrimitiveUsage()
+{
+	for (size_t n=0;n<m_BVH.GetQtyPrimitives();++n)
+		m_Usage[n].store(0);
+}
+
+void CSStructureSnapshot::ApplyPrimitiveUsage() const
+{
+	for (size_t n=0;n<m_BVH.GetQtyPrimitives();++n)
+		if (m_Usage[n].load()>0)
+			m_BVH.GetEntryPrimitive(n)->SetPrimitiveUsed(true);
+}
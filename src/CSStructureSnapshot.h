@@ -0,0 +1,118 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CSSTRUCTURESNAPSHOT_H
+#define CSSTRUCTURESNAPSHOT_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include "CSXCAD_Global.h"
+#include "CSProperties.h"
+#include "CSBoundingVolumeHierarchy.h"
+
+class CSPrimitives;
+
+//! Read-only snapshot of a ContinuousStructure for concurrent coordinate queries.
+/*!
+  Created by ContinuousStructure::Compile() from an up to date structure. All primitives are evaluated,
+  the search order of all primitives is resolved into a bounding volume hierarchy and the material values
+  of all material properties are stored. None of the queries modifies the snapshot or the structure, they
+  may therefore be called from any number of threads without locking.
+
+  Found primitives are not marked as used directly, as CSPrimitives::SetPrimitiveUsed is not thread safe.
+  A query may count its result in an atomic usage counter instead, the counts can be written back into the
+  primitives with ApplyPrimitiveUsage() once all threads are done.
+
+  The snapshot holds plain pointers into the structure, which must neither be modified nor deleted while
+  the snapshot is in use. Any change of the structure requires a new snapshot.
+*/
+class CSXCAD_EXPORT CSStructureSnapshot
+{
+	friend class ContinuousStructure;
+public:
+	virtual ~CSStructureSnapshot();
+
+	//! Material values of a property, evaluated when the snapshot was created
+	struct MaterialValues
+	{
+		double epsilon[3];
+		double mue[3];
+		double kappa[3];
+		double sigma[3];
+		double density;
+	};
+
+	//! Get the mesh coordinate system of all queries
+	CoordinateSystem GetCoordInputType() const {return m_MeshType;}
+
+	//! Get the quantity of properties, in the order of the structure
+	size_t GetQtyProperties() const {return m_Properties.size();}
+	//! Get the property at the given index, as in ContinuousStructure::GetProperty
+	CSProperties* GetProperty(size_t index) const;
+	//! Get the material values of the property at the given index, NULL if it is not a material
+	const MaterialValues* GetMaterialValues(size_t index) const;
+
+	//! Get the index of the property with the highest priority at a given coordinate. \sa ContinuousStructure::GetPropertyByCoordPriority
+	/*!
+	\param coord Coordinate in the mesh coordinate system
+	\param type Specify the type searched for. (Default is ANY-type)
+	\param countUsage Count the found primitive in its usage counter. \sa ApplyPrimitiveUsage
+	\param foundPrimitive return the found primitive, set to NULL if none was found
+	\return The property index, -1 if no property was found
+	 */
+	int GetPropertyIndexByCoordPriority(const double* coord, CSProperties::PropertyType type=CSProperties::ANY, bool countUsage=false, CSPrimitives** foundPrimitive=NULL) const;
+	//! Get the property with the highest priority at a given coordinate, NULL if none was found. \sa GetPropertyIndexByCoordPriority
+	CSProperties* GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type=CSProperties::ANY, bool countUsage=false, CSPrimitives** foundPrimitive=NULL) const;
+
+	//! Get the property indices at many coordinates, evaluated in parallel. \sa GetPropertyIndexByCoordPriority
+	/*!
+	\param numCoords Number of coordinates n
+	\param coords Give a 3*n-element array with the 3D-coordinate set (e.g. x1,y1,z1,x2,y2,z2,...)
+	\param indices Array of n property indices to fill, -1 for any coordinate without a property found
+	\param type Specify the type searched for. (Default is ANY-type)
+	\param countUsage Count the found primitives in their usage counters, each thread counts locally and adds its counts at the end
+	\param numThreads Number of threads to use, 0 to use all available cores
+	 */
+	void GetPropertyIndicesByCoordsPriority(size_t numCoords, const double* coords, int* indices, CSProperties::PropertyType type=CSProperties::ANY, bool countUsage=false, unsigned int numThreads=0) const;
+
+	//! Get how often a primitive was found by a query with usage counting
+	unsigned long GetPrimitiveUsage(const CSPrimitives* prim) const;
+	//! Reset all usage counters, must not be called during a query
+	void ResetPrimitiveUsage();
+	//! Mark all primitives counted as found as used. Not thread safe, call it after all queries are done. \sa CSPrimitives::SetPrimitiveUsed
+	void ApplyPrimitiveUsage() const;
+
+protected:
+	CSStructureSnapshot(const std::vector<CSProperties*> &props, CoordinateSystem cs, double tol);
+
+	std::vector<CSProperties*> m_Properties;
+	//! index into m_Materials per property, -1 for properties which are no material
+	std::vector<int> m_MaterialIndex;
+	std::vector<MaterialValues> m_Materials;
+
+	CSBoundingVolumeHierarchy m_BVH;
+	CoordinateSystem m_MeshType;
+	double m_Tolerance;
+
+	//! usage counter per entry of the hierarchy, owned by the snapshot, which therefore can not be copied
+	std::unique_ptr<std::atomic<unsigned long>[]> m_Usage;
+
+	void FindIndices(size_t start, size_t stop, const double* coords, int* indices, CSProperties::PropertyType type, bool countUsage) const;
+};
+
+#endif // CSSTRUCTURESNAPSHOT_H
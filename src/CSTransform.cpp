@@ -29,12 +29,14 @@
 
 CSTransform::CSTransform()
 {
+	m_Revision=0;
 	Reset();
 	SetParameterSet(NULL);
 }
 
 CSTransform::CSTransform(CSTransform* transform)
 {
+	m_Revision=0;
 	if (transform==NULL)
 	{
 		Reset();
@@ -55,6 +57,7 @@ CSTransform::CSTransform(CSTransform* transform)
 
 CSTransform::CSTransform(ParameterSet* paraSet)
 {
+	m_Revision=0;
 	Reset();
 	SetParameterSet(paraSet);
 }
@@ -71,6 +74,7 @@ void CSTransform::Reset()
 	m_TransformArguments.clear();
 	MakeUnitMatrix(m_TMatrix);
 	MakeUnitMatrix(m_Inv_TMatrix);
+	++m_Revision;
 }
 
 bool CSTransform::HasTransform()
@@ -90,6 +94,7 @@ void CSTransform::Invert()
 			m_TMatrix[n] = m_Inv_TMatrix[n];
 			m_Inv_TMatrix[n]=help;
 	}
+	++m_Revision;
 }
 
 void CSTransform::UpdateInverse()
@@ -482,6 +487,7 @@ void CSTransform::ApplyMatrix(const double matrix[16], bool concatenate)
 			m_TMatrix[n]=matrix[n];
 	}
 	UpdateInverse();
+	++m_Revision;
 }
 
 bool CSTransform::TransformByString(std::string operation, std::string argument, bool concatenate)
@@ -52,6 +52,8 @@ public:
 	void Invert();
 
 	double* GetMatrix() {return m_TMatrix;}
+	//! Get the inverse of the transformation matrix, as used by InvertTransform
+	const double* GetInverseMatrix() const {return m_Inv_TMatrix;}
 
 	//! Apply a matrix directly
 	void SetMatrix(const double matrix[16], bool concatenate=true);
@@ -91,6 +93,8 @@ public:
 
 	//! Check if this CSTransform has any transformations
 	bool HasTransform();
+	//! Get the revision of this transformation, it changes with every modification
+	unsigned int GetRevision() const {return m_Revision;}
 
 	//! All subsequent operations will be occur before the previous operations (not the default).
 	void SetPreMultiply() {m_PostMultiply=false;}
@@ -128,6 +132,7 @@ protected:
 
 	bool m_PostMultiply;
 	bool m_AngleRadian;
+	unsigned int m_Revision;
 
 	ParameterSet* m_ParaSet;
 
@@ -48,11 +48,55 @@
 #include "CSPropResBox.h"
 #include "CSPropAbsorbingBC.h"
 
+#include "CSBoundingVolumeHierarchy.h"
+#include "CSStructureSnapshot.h"
+
+#include <algorithm>
+#include <math.h>
+#include <thread>
+
 #include "tinyxml.h"
 
+namespace
+{
+//! A primitive as seen by ContinuousStructure::GetPropertyIndexVolume
+struct VoxelPrim
+{
+	CSPrimitives* prim;
+	int propIdx;
+	int priority;
+	size_t primIdx;
+	bool bounded;
+	double box[6];
+};
+
+//! priority descending, then by property and primitive index, as GetPropertyByCoordPriority does
+bool VoxelSearchOrder(const VoxelPrim &a, const VoxelPrim &b)
+{
+	if (a.priority!=b.priority)
+		return a.priority>b.priority;
+	if (a.propIdx!=b.propIdx)
+		return a.propIdx<b.propIdx;
+	return a.primIdx<b.primIdx;
+}
+
+//! A line collected by ContinuousStructure::GenerateMesh
+struct EdgeLine
+{
+	double coord;
+	//! the side of a metal edge the metal is on, +1 or -1, 0 for any other edge
+	int side;
+	//! a line of the grid, always kept
+	bool fixed;
+	bool operator<(const EdgeLine &other) const {return coord<other.coord;}
+};
+}
+
 /*********************ContinuousStructure********************************************************************/
 ContinuousStructure::ContinuousStructure(void)
 {
+	m_UseBVH = false;
+	m_BVH = NULL;
 	clParaSet = new ParameterSet();
 	// these belong to us and are destroyed with us
 	clParaSet->SetOwner(this);
@@ -69,6 +113,8 @@ ContinuousStructure::~ContinuousStructure(void)
 	clear();
 	delete clParaSet;
 	clParaSet=NULL;
+	delete m_BVH;
+	m_BVH=NULL;
 }
 
 ParameterSet* ContinuousStructure::GetParameterSet() {return clParaSet;}
@@ -83,6 +129,7 @@ void ContinuousStructure::AddProperty(CSProperties* prop)
 	prop->SetCoordInputType(m_MeshType);
 	prop->Update(&ErrString);
 	vProperties.push_back(prop);
+	InvalidateBVH();
 	prop->SetOwner(this);
 	prop->SetUniqueID(UniqueIDCounter++);
 	this->UpdateIDs();
@@ -104,6 +151,7 @@ bool ContinuousStructure::ReplaceProperty(CSProperties* oldProp, CSProperties* n
 			}
 			delete *iter;
 			*iter=newProp;
+			InvalidateBVH();
 			newProp->SetOwner(this);
 			newProp->SetUniqueID(UniqueIDCounter++);
 			return true;
@@ -119,6 +167,7 @@ void ContinuousStructure::RemoveProperty(CSProperties* prop)
 		if (*iter==prop)
 		{
 			vProperties.erase(iter);
+			InvalidateBVH();
 			prop->SetOwner(NULL);   // ownership is handed back to the caller
 			this->UpdateIDs();
 			return;
@@ -131,6 +180,7 @@ void ContinuousStructure::DeleteProperty(size_t index)
 	std::vector<CSProperties*>::iterator iter=vProperties.begin();
 	delete vProperties.at(index);
 	vProperties.erase(iter+index);
+	InvalidateBVH();
 	this->UpdateIDs();
 }
 
@@ -143,6 +193,7 @@ void ContinuousStructure::DeleteProperty(CSProperties* prop)
 		{
 			delete *iter;
 			vProperties.erase(iter);
+			InvalidateBVH();
 			this->UpdateIDs();
 			return;
 		}
@@ -216,6 +267,7 @@ void ContinuousStructure::DeletePrimitive(CSPrimitives* prim)
 {
 	// no special handling is necessary, deleted primitive will release itself from its owning property
 	delete prim;
+	InvalidateBVH();
 }
 
 std::vector<CSPrimitives*> ContinuousStructure::GetPrimitivesByType(CSPrimitives::PrimitiveType type)
@@ -243,20 +295,195 @@ bool ContinuousStructure::InsertEdges2Grid(int nu)
 {
 	if (nu<0) return false;
 	if (nu>2) return false;
+	bool dirs[3] = {nu==0, nu==1, nu==2};
+	InsertBoundBoxEdges(dirs);
+	return true;
+}
+
+bool ContinuousStructure::InsertEdges2Grid()
+{
+	bool dirs[3] = {true, true, true};
+	InsertBoundBoxEdges(dirs);
+	return true;
+}
+
+void ContinuousStructure::InsertBoundBoxEdges(const bool dirs[3])
+{
+	std::vector<double> lines[3];
 	double box[6] = {0,0,0,0,0,0};
-	bool accBound=false;
-	std::vector<CSPrimitives*> vPrimitives=GetAllPrimitives();
-	for (size_t i=0;i<vPrimitives.size();++i)
+	for (size_t p=0;p<vProperties.size();++p)
 	{
-		accBound = vPrimitives.at(i)->GetBoundBox(box);
-		if (accBound)
+		CSProperties* prop = vProperties.at(p);
+		for (size_t i=0;i<prop->GetQtyPrimitives();++i)
 		{
-			clGrid.AddDiscLine(nu,box[2*nu]);
-			clGrid.AddDiscLine(nu,box[2*nu+1]);
+			if (prop->GetPrimitive(i)->GetCachedBoundBox(box)==false)
+				continue;
+			for (int n=0;n<3;++n)
+				if (dirs[n])
+				{
+					lines[n].push_back(box[2*n]);
+					lines[n].push_back(box[2*n+1]);
+				}
 		}
 	}
-	clGrid.Sort(nu);
-	return true;
+	for (int n=0;n<3;++n)
+		if (dirs[n])
+			clGrid.MergeDiscLines(n, lines[n]);
+}
+
+bool ContinuousStructure::GenerateMesh(const double max_res[3], double ratio, double metalEdgeRes, CSProperties::PropertyType type, double tol, unsigned int numThreads)
+{
+	std::vector<CSPrimitives*> prims = GetAllPrimitives(false, type);
+
+	if (numThreads==0)
+		numThreads = std::thread::hardware_concurrency();
+	if (numThreads>prims.size())
+		numThreads = (unsigned int)prims.size();
+	if (numThreads<1)
+		numThreads = 1;
+	std::vector<std::vector<EdgeLine> > found(3*numThreads);
+
+	// the thirds rule applies to the edges of metal sheets
+	// GetDimension() updates an invalidated primitive, so it is called for all primitives before the threads start
+	std::vector<bool> sheets(prims.size(), false);
+	for (size_t p=0;p<prims.size();++p)
+	{
+		int dim = prims.at(p)->GetDimension();
+		sheets[p] = (metalEdgeRes>0) && (prims.at(p)->GetProperty()->GetType() & CSProperties::METAL) && (dim==2);
+	}
+
+	// every thread handles every numThreads-th primitive
+	auto collect = [&](unsigned int thread)
+	{
+		std::vector<CSPrimitives::MeshEdge> edges;
+		for (size_t p=thread;p<prims.size();p+=numThreads)
+		{
+			CSPrimitives* prim = prims.at(p);
+			edges.clear();
+			if (prim->GetMeshEdges(edges)==false)
+				continue;
+			// the side of the metal is found next to the edge, IsInside() does not update a sheet with its known dimension
+			bool sheet = sheets[p];
+			double delta[3] = {0,0,0};
+			for (int n=0;sheet && (n<3);++n)
+			{
+				double lo = 0, hi = 0;
+				bool any = false;
+				for (size_t e=0;e<edges.size();++e)
+				{
+					double c = edges[e].pos[n];
+					lo = any ? std::min(lo,c) : c;
+					hi = any ? std::max(hi,c) : c;
+					any = true;
+				}
+				delta[n] = 1e-6*(hi-lo);
+			}
+			for (size_t e=0;e<edges.size();++e)
+			{
+				const CSPrimitives::MeshEdge &edge = edges[e];
+				EdgeLine line;
+				line.coord = edge.pos[edge.ny];
+				line.side = 0;
+				line.fixed = false;
+				if (sheet && (delta[edge.ny]>0))
+				{
+					double pos[3] = {edge.pos[0], edge.pos[1], edge.pos[2]};
+					pos[edge.ny] = line.coord + delta[edge.ny];
+					bool upper = prim->IsInside(pos);
+					pos[edge.ny] = line.coord - delta[edge.ny];
+					bool lower = prim->IsInside(pos);
+					if (upper!=lower)
+						line.side = upper ? 1 : -1;
+				}
+				found[3*thread+edge.ny].push_back(line);
+			}
+		}
+	};
+
+	if (numThreads==1)
+		collect(0);
+	else
+	{
+		std::vector<std::thread> threads;
+		for (unsigned int t=0;t<numThreads;++t)
+			threads.push_back(std::thread(collect, t));
+		for (size_t t=0;t<threads.size();++t)
+			threads.at(t).join();
+	}
+
+	bool ok = true;
+	for (int n=0;n<3;++n)
+	{
+		std::vector<EdgeLine> lines;
+		for (unsigned int t=0;t<numThreads;++t)
+			lines.insert(lines.end(), found[3*t+n].begin(), found[3*t+n].end());
+		for (size_t i=0;i<clGrid.GetQtyLines(n);++i)
+		{
+			EdgeLine line = {clGrid.GetLine(n,i), 0, true};
+			lines.push_back(line);
+		}
+		if (lines.size()==0)
+		{
+			ok = false;
+			continue;
+		}
+		std::sort(lines.begin(), lines.end());
+		double absTol = tol*(lines.back().coord-lines.front().coord);
+
+		std::vector<double> fixed;
+		for (size_t i=0;i<lines.size();)
+		{
+			// a group of lines, each closer than the tolerance to the next
+			size_t j = i+1;
+			while ((j<lines.size()) && (lines[j].coord-lines[j-1].coord<=absTol))
+				++j;
+			bool grid = false;
+			bool conflict = false;
+			int side = 0;
+			double edge = lines[i].coord;
+			for (size_t k=i;k<j;++k)
+			{
+				if (lines[k].fixed)
+				{
+					fixed.push_back(lines[k].coord);
+					grid = true;
+				}
+				else if ((lines[k].side!=0) && (side==0))
+				{
+					side = lines[k].side;
+					edge = lines[k].coord;
+				}
+				else if ((lines[k].side!=0) && (lines[k].side!=side))
+					conflict = true;
+			}
+			// a metal edge gets the thirds rule, metal on both sides (conflict) is no edge and gets a plain line
+			if (grid==false)
+			{
+				if ((side!=0) && (conflict==false))
+				{
+					fixed.push_back(edge + side*metalEdgeRes/3);
+					fixed.push_back(edge - side*2*metalEdgeRes/3);
+				}
+				else
+					fixed.push_back(lines[i].coord);
+			}
+			i = j;
+		}
+
+		// the lines of the thirds rule may have come too close to others
+		std::sort(fixed.begin(), fixed.end());
+		size_t k = 1;
+		for (size_t i=1;i<fixed.size();++i)
+			if (fixed[i]-fixed[k-1]>absTol)
+				fixed[k++] = fixed[i];
+		fixed.resize(k);
+
+		if (max_res[n]>0)
+			fixed = CSRectGrid::SmoothMeshLines(fixed, max_res[n], ratio);
+		clGrid.ClearLines(n);
+		clGrid.AddDiscLines(n, fixed.size(), &fixed[0]);
+	}
+	return ok;
 }
 
 CSPrimitives* ContinuousStructure::GetPrimitiveByID(unsigned int ID)
@@ -285,6 +512,22 @@ CSProperties* ContinuousStructure::GetProperty(size_t index)
 
 CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type, bool markFoundAsUsed, CSPrimitives** foundPrimitive)
 {
+	PrepareBVH();
+	CSPrimitives* winPrim = FindPrimitiveByCoordPriority(coord, type);
+	if ((markFoundAsUsed) && (winPrim))
+		winPrim->SetPrimitiveUsed(true);
+	if (foundPrimitive)
+		*foundPrimitive=winPrim;
+	if (winPrim)
+		return winPrim->GetProperty();
+	return NULL;
+}
+
+CSPrimitives* ContinuousStructure::FindPrimitiveByCoordPriority(const double* coord, CSProperties::PropertyType type)
+{
+	if (m_BVH)
+		return m_BVH->FindPrimitive(coord, type, dDrawingTol);
+
 	CSProperties* winProp=NULL;
 	CSPrimitives* winPrim=NULL;
 	CSPrimitives* locPrim=NULL;
@@ -312,18 +555,235 @@ CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coor
 			}
 		}
 	}
-	if ((markFoundAsUsed) && (winPrim))
-		winPrim->SetPrimitiveUsed(true);
-	if (foundPrimitive)
-		*foundPrimitive=winPrim;
-	return winProp;
+	return winPrim;
 }
 
+void ContinuousStructure::GetPropertiesByCoordsPriority(size_t numCoords, const double* coords, CSProperties** props, CSPrimitives** prims, CSProperties::PropertyType type, bool markFoundAsUsed, unsigned int numThreads)
+{
+	const double* const xyz[3] = {coords, coords+1, coords+2};
+	FindPropertiesByCoordsPriority(numCoords, xyz, 3, props, prims, type, markFoundAsUsed, numThreads);
+}
 
-CSProperties** ContinuousStructure::GetPropertiesByCoordsPriority(const double* /*coords*/, CSProperties::PropertyType /*type*/, bool /*markFoundAsUsed*/)
+void ContinuousStructure::GetPropertiesByCoordsPriority(size_t numCoords, const double* const coords[3], CSProperties** props, CSPrimitives** prims, CSProperties::PropertyType type, bool markFoundAsUsed, unsigned int numThreads)
 {
-	std::cerr << "ContinuousStructure::GetPropertiesByCoordsPriority --> This methode has not been implemented yet!!! return NULL" << std::endl;
-	return NULL;
+	FindPropertiesByCoordsPriority(numCoords, coords, 1, props, prims, type, markFoundAsUsed, numThreads);
+}
+
+CSStructureSnapshot* ContinuousStructure::Compile(std::string* ErrStr)
+{
+	std::string err = Update();
+	if (ErrStr)
+		ErrStr->append(err);
+	return new CSStructureSnapshot(vProperties, m_MeshType, dDrawingTol);
+}
+
+void ContinuousStructure::FindPropertiesByCoordsPriority(size_t numCoords, const double* const coords[3], size_t stride, CSProperties** props, CSPrimitives** prims, CSProperties::PropertyType type, bool markFoundAsUsed, unsigned int numThreads)
+{
+	if ((numCoords==0) || (props==NULL))
+		return;
+
+	std::vector<CSPrimitives*> primBuffer;
+	if (prims==NULL)
+	{
+		primBuffer.resize(numCoords);
+		prims = &primBuffer[0];
+	}
+
+	// anything lazily created has to exist before the threads start
+	PrepareBVH();
+
+	if (numThreads==0)
+		numThreads = std::thread::hardware_concurrency();
+	// a thread per few coordinates is not worth its start-up
+	size_t maxThreads = numCoords/256+1;
+	if (numThreads>maxThreads)
+		numThreads = (unsigned int)maxThreads;
+
+	if (numThreads<=1)
+		FindPrimitivesByCoordsPriority(0, numCoords, coords, stride, prims, type);
+	else
+	{
+		std::vector<std::thread> threads;
+		size_t block = numCoords/numThreads;
+		size_t start = 0;
+		for (unsigned int n=0;n<numThreads;++n)
+		{
+			size_t stop = start + block + (n < numCoords%numThreads ? 1 : 0);
+			threads.push_back(std::thread(&ContinuousStructure::FindPrimitivesByCoordsPriority, this, start, stop, coords, stride, prims, type));
+			start = stop;
+		}
+		for (size_t n=0;n<threads.size();++n)
+			threads.at(n).join();
+	}
+
+	for (size_t n=0;n<numCoords;++n)
+	{
+		if (prims[n]==NULL)
+		{
+			props[n] = NULL;
+			continue;
+		}
+		props[n] = prims[n]->GetProperty();
+		// marking is not thread safe, done afterwards
+		if (markFoundAsUsed)
+			prims[n]->SetPrimitiveUsed(true);
+	}
+}
+
+void ContinuousStructure::FindPrimitivesByCoordsPriority(size_t start, size_t stop, const double* const coords[3], size_t stride, CSPrimitives** prims, CSProperties::PropertyType type)
+{
+	double coord[3];
+	for (size_t n=start;n<stop;++n)
+	{
+		for (int d=0;d<3;++d)
+			coord[d] = coords[d][n*stride];
+		prims[n] = FindPrimitiveByCoordPriority(coord, type);
+	}
+}
+
+bool ContinuousStructure::GetPropertyIndexVolume(std::vector<int> &volume, bool cellCenter, CSProperties::PropertyType type, bool markFoundAsUsed, unsigned int numThreads)
+{
+	std::vector<double> pos[3];
+	for (int n=0;n<3;++n)
+	{
+		pos[n] = clGrid.GetSamplePositions(n, cellCenter);
+		if (pos[n].size()==0)
+		{
+			volume.clear();
+			return false;
+		}
+	}
+	const size_t numX = pos[0].size();
+	const size_t numY = pos[1].size();
+	const size_t numZ = pos[2].size();
+	volume.assign(numX*numY*numZ, -1);
+
+	// all primitives in search order, with their cartesian bounding box
+	std::vector<VoxelPrim> prims;
+	for (size_t i=0;i<vProperties.size();++i)
+	{
+		if ((type!=CSProperties::ANY) && ((vProperties.at(i)->GetType() & type)==0))
+			continue;
+		for (size_t j=0;j<vProperties.at(i)->GetQtyPrimitives();++j)
+		{
+			VoxelPrim vp;
+			vp.prim = vProperties.at(i)->GetPrimitive(j);
+			vp.propIdx = (int)i;
+			vp.priority = vp.prim->GetPriority();
+			vp.primIdx = j;
+			vp.bounded = (vp.prim->GetCoordInputType()==m_MeshType) && vp.prim->GetConservativeBoundBox(vp.box);
+			// be robust against round-off of the coordinate transformations
+			for (int n=0;vp.bounded && (n<3);++n)
+			{
+				double pad = 1e-12*(fabs(vp.box[2*n])+fabs(vp.box[2*n+1]));
+				vp.box[2*n]-=pad;
+				vp.box[2*n+1]+=pad;
+			}
+			prims.push_back(vp);
+		}
+	}
+	std::sort(prims.begin(), prims.end(), VoxelSearchOrder);
+
+	if (numThreads==0)
+		numThreads = std::thread::hardware_concurrency();
+	if (numThreads<1)
+		numThreads = 1;
+	if (numThreads>numX)
+		numThreads = (unsigned int)numX;
+	std::vector<std::vector<char> > used(numThreads, std::vector<char>(prims.size(), 0));
+	const double* z = &pos[2][0];
+	const double tol = dDrawingTol;
+
+	// every thread handles every numThreads-th yz-slice
+	auto voxelize = [&](unsigned int thread)
+	{
+		std::vector<size_t> slicePrims, linePrims;
+		std::vector<double> intervals;
+		double coord[3] = {0,0,0};
+		double xyz[3];
+		for (size_t i=thread;i<numX;i+=numThreads)
+		{
+			// primitives that may touch this slice
+			slicePrims.clear();
+			double rad = fabs(pos[0][i]);
+			for (size_t p=0;p<prims.size();++p)
+			{
+				const double* box = prims[p].box;
+				if (prims[p].bounded==false)
+					slicePrims.push_back(p);
+				else if (m_MeshType==CYLINDRICAL)
+				{
+					// a slice of constant radius, the circle has to touch the box in the xy-plane
+					double dmin[2], dmax[2];
+					for (int n=0;n<2;++n)
+					{
+						dmin[n] = (box[2*n]>0) ? box[2*n] : ((box[2*n+1]<0) ? -box[2*n+1] : 0);
+						dmax[n] = std::max(fabs(box[2*n]),fabs(box[2*n+1]));
+					}
+					if ((rad*rad>=dmin[0]*dmin[0]+dmin[1]*dmin[1]) && (rad*rad<=dmax[0]*dmax[0]+dmax[1]*dmax[1]))
+						slicePrims.push_back(p);
+				}
+				else if ((pos[0][i]>=box[0]) && (pos[0][i]<=box[1]))
+					slicePrims.push_back(p);
+			}
+
+			for (size_t j=0;j<numY;++j)
+			{
+				coord[0] = pos[0][i];
+				coord[1] = pos[1][j];
+				coord[2] = 0;
+				TransformCoordSystem(coord, xyz, m_MeshType, CARTESIAN);
+				int* line = &volume[(i*numY+j)*numZ];
+				size_t remaining = numZ;
+				for (size_t n=0;(n<slicePrims.size()) && (remaining>0);++n)
+				{
+					const VoxelPrim &vp = prims[slicePrims[n]];
+					size_t lo = 0, hi = numZ;
+					if (vp.bounded)
+					{
+						if ((xyz[0]<vp.box[0]) || (xyz[0]>vp.box[1]) || (xyz[1]<vp.box[2]) || (xyz[1]>vp.box[3]))
+							continue;
+						lo = std::lower_bound(z, z+numZ, vp.box[4]) - z;
+						hi = std::upper_bound(z, z+numZ, vp.box[5]) - z;
+						if (lo>=hi)
+							continue;
+					}
+					vp.prim->GetLineIntervals(2, coord, z+lo, hi-lo, intervals, tol);
+					// higher priorities are already assigned, only fill the remaining samples
+					for (size_t m=0;m+1<intervals.size();m+=2)
+					{
+						size_t start = std::lower_bound(z+lo, z+hi, intervals[m]) - z;
+						size_t stop = std::upper_bound(z+lo, z+hi, intervals[m+1]) - z;
+						for (size_t k=start;k<stop;++k)
+							if (line[k]<0)
+							{
+								line[k] = vp.propIdx;
+								used[thread][slicePrims[n]] = 1;
+								--remaining;
+							}
+					}
+				}
+			}
+		}
+	};
+
+	if (numThreads==1)
+		voxelize(0);
+	else
+	{
+		std::vector<std::thread> threads;
+		for (unsigned int t=0;t<numThreads;++t)
+			threads.push_back(std::thread(voxelize, t));
+		for (size_t t=0;t<threads.size();++t)
+			threads.at(t).join();
+	}
+
+	if (markFoundAsUsed)
+		for (unsigned int t=0;t<numThreads;++t)
+			for (size_t p=0;p<prims.size();++p)
+				if (used[t][p])
+					prims[p].prim->SetPrimitiveUsed(true);
+	return true;
 }
 
 CSProperties* ContinuousStructure::GetPropertyByCoordPriority(const double* coord, std::vector<CSPrimitives*> primList, bool markFoundAsUsed, CSPrimitives** foundPrimitive)
@@ -370,6 +830,7 @@ void ContinuousStructure::ShowPropertyStatus(std::ostream& stream, CSProperties:
 void ContinuousStructure::SetCoordInputType(CoordinateSystem type)
 {
 	m_MeshType = type;
+	InvalidateBVH();
 	for (size_t i=0;i<vProperties.size();++i)
 	{
 		vProperties.at(i)->SetCoordInputType(type);
@@ -380,6 +841,26 @@ CoordinateSystem ContinuousStructure::GetCoordInputType() {return m_MeshType;}
 
 void ContinuousStructure::SetDrawingTolerance(double val) {dDrawingTol=val;}
 
+void ContinuousStructure::SetUseBoundingVolumeHierarchy(bool val)
+{
+	m_UseBVH = val;
+	InvalidateBVH();
+}
+
+void ContinuousStructure::InvalidateBVH()
+{
+	delete m_BVH;
+	m_BVH = NULL;
+}
+
+void ContinuousStructure::PrepareBVH()
+{
+	if ((m_UseBVH==false) || (m_BVH!=NULL))
+		return;
+	m_BVH = new CSBoundingVolumeHierarchy();
+	m_BVH->Build(vProperties, m_MeshType);
+}
+
 bool ContinuousStructure::isGeometryValid()
 {
 	if (GetQtyProperties()<=0) return false;
@@ -410,40 +891,72 @@ bool ContinuousStructure::isGeometryValid()
 
 double* ContinuousStructure::GetObjectArea(CSProperties::PropertyType type)
 {
-	CSPrimitives* prim=NULL;
-	bool AccBound;
-	std::vector<CSPrimitives*> vPrimitives=GetAllPrimitives(type);
-	for (size_t i=0;i<vPrimitives.size();++i)
+	bool found = false;
+	double box[6];
+	for (int n=0;n<6;++n)
+		ObjArea[n] = 0;
+	for (size_t i=0;i<vProperties.size();++i)
 	{
-		prim=vPrimitives.at(i);
-		double box[6] = {0,0,0,0,0,0};
-		AccBound = prim->GetBoundBox(box);
-		if (AccBound)
+		if (((vProperties.at(i)->GetType() & type)==0) || (vProperties.at(i)->GetPrimitivesBoundBox(box)==false))
+			continue;
+		for (int n=0;n<3;++n)
 		{
-			if (i==0) for (int i=0;i<6;++i) ObjArea[i]=box[i];
-			else
-			{
-				for (int i=0;i<3;++i)
-				{
-					if (ObjArea[2*i]>box[2*i]) ObjArea[2*i]=box[2*i];
-					if (ObjArea[2*i+1]<box[2*i+1]) ObjArea[2*i+1]=box[2*i+1];
-				}
-			}
+			ObjArea[2*n] = found ? std::min(ObjArea[2*n],box[2*n]) : box[2*n];
+			ObjArea[2*n+1] = found ? std::max(ObjArea[2*n+1],box[2*n+1]) : box[2*n+1];
 		}
+		found = true;
 	}
 	return ObjArea;
 }
 
-std::string ContinuousStructure::Update()
+unsigned int ContinuousStructure::GetChangedParameters()
+{
+	unsigned int changed = 0;
+	size_t num = clParaSet->GetQtyParameter();
+	if ((m_UpdateValid==false) || (m_UpdateRevision!=clParaSet->GetRevision()) || (m_UpdateValues.size()!=num))
+		changed = ~0u;
+	m_UpdateNames.resize(num);
+	m_UpdateValues.resize(num);
+	for (size_t n=0;n<num;++n)
+	{
+		Parameter* para = clParaSet->GetParameter(n);
+		double val = para->GetValue();
+		if ((changed!=~0u) && (para->GetName()!=m_UpdateNames.at(n)))
+			changed = ~0u;  // a renamed parameter may change any expression
+		else if ((changed!=~0u) && (val!=m_UpdateValues.at(n)))
+			changed |= (n<8*sizeof(changed)) ? 1u<<n : ~0u;
+		m_UpdateNames.at(n) = para->GetName();
+		m_UpdateValues.at(n) = val;
+	}
+	m_UpdateRevision = clParaSet->GetRevision();
+	m_UpdateValid = true;
+	return changed;
+}
+
+std::string ContinuousStructure::Update(bool full)
 {
 	ErrString.clear();
+	InvalidateBVH();
 
+	// the properties only evaluate a few values, they are always updated
 	for (size_t i=0;i<vProperties.size();++i)
+	{
 		vProperties.at(i)->Update(&ErrString);
+		vProperties.at(i)->InvalidatePrimitivesBoundBox();
+	}
 
-	std::vector<CSPrimitives*> vPrimitives=GetAllPrimitives();
-	for (size_t i=0;i<vPrimitives.size();++i)
-		vPrimitives.at(i)->Update(&ErrString);
+	unsigned int changed = GetChangedParameters();
+	if (full)
+		changed = ~0u;
+	for (size_t i=0;i<vProperties.size();++i)
+	{
+		for (size_t n=0;n<vProperties.at(i)->GetQtyPrimitives();++n)
+		{
+			CSPrimitives* prim = vProperties.at(i)->GetPrimitive(n);
+			// the changes are only known for parameters of this structure
+			prim->UpdateDependent(prim->GetParameterSet()==clParaSet ? changed : ~0u, &ErrString);
+		}
+	}
 
 	return std::string(ErrString);
 }
@@ -460,6 +973,8 @@ void ContinuousStructure::clear()
 		vProperties.at(n)=NULL;
 	}
 	vProperties.clear();
+	InvalidateBVH();
+	m_UpdateValid = false;
 	SetCoordInputType(CARTESIAN);
 	if (clParaSet)
 		clParaSet->clear();
@@ -38,6 +38,8 @@
 #include "CSObject.h"
 
 class TiXmlNode;
+class CSBoundingVolumeHierarchy;
+class CSStructureSnapshot;
 
 //! Continuous Structure containing properties (layer) and primitives.
 /*!
@@ -99,6 +101,16 @@ public:
 	//! Set a drawing tolerance. /sa GetPropertyByCoordPriority /sa GetPropertiesByCoordsPriority
 	void SetDrawingTolerance(double val);
 
+	//! Use a bounding volume hierarchy to speed up GetPropertyByCoordPriority, recommended for structures with many primitives.
+	/*!
+	 The hierarchy is built on the first query and dropped with any change made through this structure, e.g. by Update() or AddProperty().
+	 A primitive modified or deleted directly requires a call to Update() before the next query.
+	 \sa CSBoundingVolumeHierarchy
+	 */
+	void SetUseBoundingVolumeHierarchy(bool val);
+	//! Check if a bounding volume hierarchy is used. \sa SetUseBoundingVolumeHierarchy
+	bool GetUseBoundingVolumeHierarchy() const {return m_UseBVH;}
+
 	//! Get a property by its priority at a given coordinate and property type.
 	/*!
 	\param coord Give a 3-element array with a 3D-coordinate set (x,y,z).
@@ -109,18 +121,47 @@ public:
 	 */
 	CSProperties* GetPropertyByCoordPriority(const double* coord, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false, CSPrimitives** foundPrimitive=NULL);
 
-	//! Get properties by its priority at given coordinates and property type.
+	//! Get properties by their priority at given coordinates and property type.
 	/*!
+	The coordinates are split into blocks which are evaluated in parallel. The structure must be up to date, see Update(), and must not be modified during this call.
 	\sa GetPropertyByCoordPriority
+	\param numCoords Number of coordinates n
 	\param coords Give a 3*n-element array with the 3D-coordinate set (e.g. x1,y1,z1,x2,y2,z2,...)
+	\param props Array of n properties to fill, NULL for any coordinate without a property found
+	\param prims Optional array of n primitives to fill with the found primitives, may be NULL
+	\param type Specify the type searched for. (Default is ANY-type)
+	\param markFoundAsUsed Mark the found primitives as beeing used. \sa WarnUnusedPrimitves
+	\param numThreads Number of threads to use, 0 to use all available cores
+	 */
+	void GetPropertiesByCoordsPriority(size_t numCoords, const double* coords, CSProperties** props, CSPrimitives** prims=NULL, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false, unsigned int numThreads=0);
+	//! Get properties by their priority at given coordinates, with coordinates given as three separate arrays of n x-, y- and z-values. \sa GetPropertiesByCoordsPriority
+	void GetPropertiesByCoordsPriority(size_t numCoords, const double* const coords[3], CSProperties** props, CSPrimitives** prims=NULL, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false, unsigned int numThreads=0);
+
+	//! Get the index of the property with the highest priority at every node or cell center of the grid. \sa GetProperty
+	/*!
+	The grid is scanned line by line in z-direction. Instead of testing every sample against every primitive, only the primitives whose bounding box
+	touches a line are asked for the intervals in which the line is inside of them, and the priorities are resolved per interval.
+	The result equals GetPropertyByCoordPriority at every sample. The structure must be up to date, see Update(), and must not be modified during this call.
+	\sa CSPrimitives::GetLineIntervals
+	\param volume Filled with Nx*Ny*Nz property indices, -1 where no property was found. The sample (i,j,k) is stored at (i*Ny+j)*Nz+k.
+	\param cellCenter Sample the cell centers instead of the grid nodes. \sa CSRectGrid::GetSamplePositions
 	\param type Specify the type searched for. (Default is ANY-type)
 	\param markFoundAsUsed Mark the found primitives as beeing used. \sa WarnUnusedPrimitves
-	\return Returns an array of n properties. NULL if coordinate is outside the mesh, no mesh is defined or no property is found.
+	\param numThreads Number of threads to use, 0 to use all available cores
+	\return false if the grid has no sampling position in any direction
 	 */
-	CSProperties** GetPropertiesByCoordsPriority(const double* coords, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false);
+	bool GetPropertyIndexVolume(std::vector<int> &volume, bool cellCenter=false, CSProperties::PropertyType type=CSProperties::ANY, bool markFoundAsUsed=false, unsigned int numThreads=0);
 
 	CSProperties* GetPropertyByCoordPriority(const double* coord, std::vector<CSPrimitives*> primList, bool markFoundAsUsed=false, CSPrimitives** foundPrimitive=NULL);
 
+	//! Create a read-only snapshot of this structure for concurrent queries from many threads. \sa CSStructureSnapshot
+	/*!
+	 Updates the structure and evaluates everything a query needs up front. The snapshot refers to the properties and primitives of this structure,
+	 which must not be modified or deleted while it is in use. The caller takes ownership of the snapshot.
+	 \param ErrStr Optional, the error messages of Update() are appended
+	 */
+	CSStructureSnapshot* Compile(std::string* ErrStr=NULL);
+
 	//! Check and warn for unused primitives in properties of given type
 	void WarnUnusedPrimitves(std::ostream& stream, CSProperties::PropertyType type=CSProperties::ANY);
 
@@ -159,13 +200,39 @@ public:
 
 	//! Get the edges of all includes primitives and add to the desired grid direction. \param nu Direction of grid (x=0,y=1,z=2).
 	bool InsertEdges2Grid(int nu);
+	//! Get the edges of all includes primitives and add them to all grid directions in a single pass.
+	bool InsertEdges2Grid();
+
+	//! Generate the grid from the edges of all primitives of the given property types. \sa CSPrimitives::GetMeshEdges
+	/*!
+	 The edges are collected from the primitives in parallel, lines closer than the tolerance are merged and the lines are smoothed in every direction, see CSRectGrid::SmoothMeshLines.
+	 Lines already in the grid are kept. The structure must not be modified during this call, an invalidated primitive is updated before the edges are collected in parallel.
+	 \param max_res Max. resolution in all three directions, a direction with a max. resolution <=0 is not smoothed.
+	 \param ratio Max. ratio of neighboring cell sizes.
+	 \param metalEdgeRes Resolution at the edges of two-dimensional metal, with a line one third inside and two thirds outside of the metal (thirds rule). 0 places a line at the edge.
+	 \param type Property types to collect the edges from, by default everything but probes, dumps and boundary conditions.
+	 \param tol Lines closer than this tolerance, relative to the size of the grid in a direction, are merged.
+	 \param numThreads Number of threads to use, 0 to use all available cores
+	 \return false if a direction is left without any line.
+	 */
+	bool GenerateMesh(const double max_res[3], double ratio=1.5, double metalEdgeRes=0,
+					  CSProperties::PropertyType type=(CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL | CSProperties::EXCITATION | CSProperties::LUMPED_ELEMENT),
+					  double tol=1e-6, unsigned int numThreads=0);
 
 	//! Check whether the structure is valid.
 	virtual bool isGeometryValid();
 	//! Update all primitives and properties e.g. with respect to changed parameter settings. \return Gives an error message in case of a found error.
-	std::string Update();
+	/*!
+	 A primitive is only updated if it was modified or depends on a parameter changed since the last update, see CSPrimitives::UpdateDependent.
+	 \param full Update all primitives, regardless of the recorded dependencies
+	 */
+	std::string Update(bool full=false);
 
 	//! Get an array containing the absolute size of the current structure.
+	/*!
+	 The union of the accurate bounding boxes of all primitives of the given property types, zero if there is none. \sa CSProperties::GetPrimitivesBoundBox
+	 Only the cached unions of the properties are combined, a property recomputes its union after a primitive was added, removed or modified, or after Update().
+	 */
 	double* GetObjectArea(CSProperties::PropertyType type=CSProperties::ANY);
 
 	//! Delete and clear all objects includes. This will result in an empty structure.
@@ -212,6 +279,14 @@ protected:
 
 	void UpdateIDs();
 
+	//! Find the parameters changed since the last call, bit n is set for the n-th parameter, all bits for a changed parameter list. \sa Update
+	unsigned int GetChangedParameters();
+	//! parameter names and values at the last update \sa GetChangedParameters
+	bool m_UpdateValid;
+	unsigned int m_UpdateRevision;
+	std::vector<std::string> m_UpdateNames;
+	std::vector<double> m_UpdateValues;
+
 	CoordinateSystem m_MeshType;
 
 	unsigned int maxID;
@@ -219,6 +294,23 @@ protected:
 	double ObjArea[6];
 	double dDrawingTol;
 
+	bool m_UseBVH;
+	CSBoundingVolumeHierarchy* m_BVH;
+	//! Drop the bounding volume hierarchy, to be rebuilt on the next query
+	void InvalidateBVH();
+	//! Build the bounding volume hierarchy if it is used but not yet built
+	void PrepareBVH();
+
+	//! Add the cached bounding box edges of all primitives to the grid directions enabled in dirs. \sa InsertEdges2Grid
+	void InsertBoundBoxEdges(const bool dirs[3]);
+
+	//! Find the primitive with the highest priority at the given coordinate, does not modify anything and may be called from multiple threads
+	CSPrimitives* FindPrimitiveByCoordPriority(const double* coord, CSProperties::PropertyType type);
+	//! Search the coordinates [start,stop) given by three arrays with the given stride. \sa GetPropertiesByCoordsPriority
+	void FindPrimitivesByCoordsPriority(size_t start, size_t stop, const double* const coords[3], size_t stride, CSPrimitives** prims, CSProperties::PropertyType type);
+	//! Common implementation of both GetPropertiesByCoordsPriority variants, the i-th coordinate is (coords[0][i*stride],coords[1][i*stride],coords[2][i*stride])
+	void FindPropertiesByCoordsPriority(size_t numCoords, const double* const coords[3], size_t stride, CSProperties** props, CSPrimitives** prims, CSProperties::PropertyType type, bool markFoundAsUsed, unsigned int numThreads);
+
 	std::string ErrString;
 	unsigned int UniqueIDCounter;
 };
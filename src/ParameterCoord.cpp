@@ -64,6 +64,7 @@ double* TransformCoordSystem(const double* inCoord, double* out, CoordinateSyste
 ParameterCoord::ParameterCoord()
 {
 	m_CoordSystem = UNDEFINED_CS;
+	m_Revision = 0;
 	for (int n=0;n<3;++n)
 		m_Coords[n] = new ParameterScalar();
 	Update();
@@ -72,6 +73,7 @@ ParameterCoord::ParameterCoord()
 ParameterCoord::ParameterCoord(ParameterSet* ParaSet)
 {
 	m_CoordSystem = UNDEFINED_CS;
+	m_Revision = 0;
 	for (int n=0;n<3;++n)
 		m_Coords[n] = new ParameterScalar(ParaSet,0);
 	Update();
@@ -80,6 +82,7 @@ ParameterCoord::ParameterCoord(ParameterSet* ParaSet)
 ParameterCoord::ParameterCoord(CoordinateSystem cs)
 {
 	m_CoordSystem = cs;
+	m_Revision = 0;
 	for (int n=0;n<3;++n)
 		m_Coords[n] = new ParameterScalar();
 	Update();
@@ -88,6 +91,7 @@ ParameterCoord::ParameterCoord(CoordinateSystem cs)
 ParameterCoord::ParameterCoord(ParameterSet* ParaSet, const double value[3])
 {
 	m_CoordSystem = UNDEFINED_CS;
+	m_Revision = 0;
 	for (int n=0;n<3;++n)
 		m_Coords[n] = new ParameterScalar(ParaSet, value[n]);
 	Update();
@@ -96,6 +100,7 @@ ParameterCoord::ParameterCoord(ParameterSet* ParaSet, const double value[3])
 ParameterCoord::ParameterCoord(ParameterSet* ParaSet, const std::string value[3])
 {
 	m_CoordSystem = UNDEFINED_CS;
+	m_Revision = 0;
 	for (int n=0;n<3;++n)
 		m_Coords[n] = new ParameterScalar(ParaSet, value[n]);
 	Update();
@@ -104,6 +109,7 @@ ParameterCoord::ParameterCoord(ParameterSet* ParaSet, const std::string value[3]
 ParameterCoord::ParameterCoord(ParameterCoord* pc)
 {
 	m_CoordSystem = UNDEFINED_CS;
+	m_Revision = 0;
 	for (int n=0;n<3;++n)
 		m_Coords[n]=NULL;
 	Copy(pc);
@@ -225,14 +231,23 @@ bool ParameterCoord::Evaluate(std::string *ErrStr)
 void ParameterCoord::Copy(ParameterCoord* pc)
 {
 	m_CoordSystem = pc->m_CoordSystem;
+	++m_Revision;
+	// keep the scalar parameter, their revisions have to increase
 	for (int n=0;n<3;++n)
 	{
-		delete m_Coords[n];
-		m_Coords[n] = new ParameterScalar(pc->m_Coords[n]);
+		if (m_Coords[n])
+			m_Coords[n]->Copy(pc->m_Coords[n]);
+		else
+			m_Coords[n] = new ParameterScalar(pc->m_Coords[n]);
 	}
 	Update();
 }
 
+unsigned int ParameterCoord::GetRevision() const
+{
+	return m_Revision+m_Coords[0]->GetRevision()+m_Coords[1]->GetRevision()+m_Coords[2]->GetRevision();
+}
+
 void ParameterCoord::Update()
 {
 	double coords[3] = {m_Coords[0]->GetValue(),m_Coords[1]->GetValue(),m_Coords[2]->GetValue()};
@@ -35,7 +35,7 @@ public:
 	void SetParameterSet(ParameterSet *paraSet);
 
 	//! Set the coordinate system used for this coordinates
-	void SetCoordinateSystem(CoordinateSystem cs) {m_CoordSystem=cs; Update();}
+	void SetCoordinateSystem(CoordinateSystem cs) {if (m_CoordSystem!=cs) ++m_Revision; m_CoordSystem=cs; Update();}
 	//! Convienient method to set the coordinate system, including a fall back if primary coordinate system is undefined.
 	void SetCoordinateSystem(CoordinateSystem cs, CoordinateSystem fallBack_cs);
 	//! Get the coordinate system that has been set for this coordinate
@@ -51,6 +51,9 @@ public:
 	//! Get the internal scalar parameter, use carefully...
 	ParameterScalar* GetCoordPS(int ny);
 
+	//! Get the modification revision, changed by a new coordinate system and by every modification of a scalar parameter \sa ParameterScalar::GetRevision
+	unsigned int GetRevision() const;
+
 	//! Get the coordinate in the given coordinate system
 	double GetCoordValue(int ny, CoordinateSystem cs);
 
@@ -77,6 +80,8 @@ protected:
 
 	//! Coordinate system used for this coordinate
 	CoordinateSystem m_CoordSystem;
+	//! modifications of the coordinate system \sa GetRevision
+	unsigned int m_Revision;
 
 	//! evaluated cartesian coords
 	double m_CartesianCoords[3];
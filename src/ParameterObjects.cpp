@@ -18,6 +18,7 @@
 #include "ParameterObjects.h"
 #include <sstream>
 #include <iostream>
+#include <mutex>
 #include "tinyxml.h"
 #include "CSFunctionParser.h"
 #include "CSUseful.h"
@@ -114,7 +115,7 @@ Parameter::Parameter()
 	dValue=0;
 	Type=Const;
 	bSweep=true;
-//	Set=NULL;
+	clParaSet=NULL;
 }
 
 Parameter::Parameter(const std::string Paraname, double val)
@@ -123,7 +124,7 @@ Parameter::Parameter(const std::string Paraname, double val)
 	SetValue(val);
 	Type=Const;
 	bSweep=true;
-//	Set=NULL;
+	clParaSet=NULL;
 }
 
 Parameter::~Parameter()
@@ -131,6 +132,15 @@ Parameter::~Parameter()
 //	if (Set!=NULL) Set->RemoveParameter(this);
 }
 
+void Parameter::SetName(const std::string Paraname)
+{
+	sName=std::string(Paraname);
+	bModified=true;
+	// parsed expressions refer to the parameter by name
+	if (clParaSet!=NULL)
+		++clParaSet->m_Revision;
+}
+
 
 void Parameter::PrintSelf(FILE* /*out*/)
 {
@@ -275,6 +285,9 @@ bool LinearParameter::ReadFromXML(TiXmlNode &root)
 ParameterSet::ParameterSet(void)
 {
 	bModified=true;
+	m_Revision=0;
+	m_Recording=false;
+	m_RecordedDependency=0;
 }
 
 ParameterSet::~ParameterSet(void)
@@ -285,7 +298,8 @@ ParameterSet::~ParameterSet(void)
 size_t ParameterSet::LinkParameter(Parameter* newPara)
 {
 	vParameter.push_back(newPara);
-//	newPara->ParameterSet(this);
+	newPara->clParaSet=this;
+	++m_Revision;
 	return vParameter.size();
 }
 
@@ -295,6 +309,7 @@ size_t ParameterSet::DeleteParameter(size_t index)
 	std::vector<Parameter*>::iterator pIter=vParameter.begin()+index;
 	delete *pIter;
 	vParameter.erase(pIter);
+	++m_Revision;
 
 	return vParameter.size();
 }
@@ -308,6 +323,7 @@ size_t ParameterSet::DeleteParameter(Parameter* para)
 		{
 			delete *pIter;
 			vParameter.erase(pIter);
+			++m_Revision;
 			return vParameter.size();
 		}
 		++pIter;
@@ -322,6 +338,7 @@ void ParameterSet::clear()
 		delete vParameter.at(i);
 	}
 	vParameter.clear();
+	++m_Revision;
 //	ParameterString.clear();
 //	ParameterValueString.clear();
 }
@@ -516,23 +533,54 @@ bool ParameterSet::ReadFromXML(TiXmlNode &root)
 }
 
 
+struct ParameterScalar::ParserCache
+{
+	ParserCache() : valid(false), paraSet(NULL), revision(0), generation(0), parseError(FunctionParser::FP_NO_ERROR) {}
+	~ParserCache()
+	{
+		for (size_t n=0;n<parsers.size();++n)
+			delete parsers.at(n);
+	}
+	std::mutex mutex;
+	//! parsed and optimized parsers not in use, a parser evaluates on an internal stack and can serve only one thread at a time
+	std::vector<CSFunctionParser*> parsers;
+	//! the parameter set and its revision the parsers were parsed with
+	bool valid;
+	ParameterSet* paraSet;
+	unsigned int revision;
+	//! counts the parser changes, parsers of an older generation are discarded on release
+	unsigned int generation;
+	int parseError;
+};
+
 ParameterScalar::ParameterScalar()
 {
+	m_Revision=0;
 	clParaSet=NULL;
 	bModified=true;
 	ParameterMode=false;
 	sValue.clear();
 	dValue=0;
+	m_Cache=NULL;
+	m_DependencyValid=false;
 }
 
 ParameterScalar::ParameterScalar(ParameterSet* ParaSet, const std::string value)
 {
+	m_Revision=0;
+	clParaSet=NULL;
+	m_Cache=NULL;
+	m_DependencyValid=false;
 	SetParameterSet(ParaSet);
 	SetValue(value);
 }
 
 ParameterScalar::ParameterScalar(ParameterSet* ParaSet, double value)
 {
+	m_Revision=0;
+	clParaSet=NULL;
+	m_Cache=NULL;
+	m_DependencyValid=false;
 	SetParameterSet(ParaSet);
 	bModified=true;
 	SetValue(value);
@@ -540,16 +588,52 @@ ParameterScalar::ParameterScalar(ParameterSet* ParaSet, double value)
 
 ParameterScalar::ParameterScalar(ParameterScalar* ps)
 {
+	m_Revision=0;
+	clParaSet=NULL;
+	m_Cache=NULL;
+	m_DependencyValid=false;
 	Copy(ps);
 }
 
+ParameterScalar::ParameterScalar(const ParameterScalar& ps)
+{
+	m_Revision=0;
+	clParaSet=NULL;
+	m_Cache=NULL;
+	m_DependencyValid=false;
+	Copy(&ps);
+}
+
 ParameterScalar::~ParameterScalar()
 {
+	delete m_Cache;
+	m_Cache=NULL;
+}
+
+ParameterScalar& ParameterScalar::operator=(const ParameterScalar& ps)
+{
+	if (this!=&ps)
+		Copy(&ps);
+	return *this;
+}
+
+void ParameterScalar::ResetCache()
+{
+	if (ParameterMode==false)
+		return;
+	if (m_Cache==NULL)
+		m_Cache = new ParserCache();
+	m_Cache->valid=false;
 }
 
 void ParameterScalar::SetParameterSet(ParameterSet *paraSet)
 {
+	if (clParaSet!=paraSet)
+		++m_Revision;
 	clParaSet=paraSet;
+	if (m_Cache)
+		m_Cache->valid=false;
+	m_DependencyValid=false;
 }
 
 int ParameterScalar::SetValue(const std::string value, bool Eval)
@@ -569,6 +653,9 @@ int ParameterScalar::SetValue(const std::string value, bool Eval)
 	ParameterMode=true;
 	bModified=true;
 	sValue=value;
+	++m_Revision;
+	ResetCache();
+	m_DependencyValid=false;
 
 	if (Eval) return Evaluate();
 
@@ -580,6 +667,7 @@ void ParameterScalar::SetValue(double value)
 	ParameterMode=false;
 	dValue=value;
 	sValue.clear();
+	++m_Revision;
 }
 
 double ParameterScalar::GetValue() const
@@ -601,6 +689,9 @@ int ParameterScalar::Evaluate()
 	if (ParameterMode==false) return 0;
 	if (clParaSet!=NULL)
 		bModified = bModified || clParaSet->GetModified();
+	// the expression may have changed since AnalyzeDependency(), scan again whenever it is parsed again
+	if ((clParaSet!=NULL) && clParaSet->IsRecordingDependency())
+		clParaSet->RecordDependency(bModified ? FindDependency() : GetDependency());
 	if (bModified==false)
 		return 0;
 
@@ -627,28 +718,183 @@ int ParameterScalar::Evaluate()
 	return fParse.EvalError();
 }
 
+CSFunctionParser* ParameterScalar::AcquireParser(unsigned int &generation, int &EC)
+{
+	if (m_Cache==NULL)
+		ResetCache();
+
+	std::lock_guard<std::mutex> lock(m_Cache->mutex);
+	unsigned int revision = clParaSet ? clParaSet->GetRevision() : 0;
+	if ((m_Cache->valid==false) || (m_Cache->paraSet!=clParaSet) || (m_Cache->revision!=revision))
+	{
+		for (size_t n=0;n<m_Cache->parsers.size();++n)
+			delete m_Cache->parsers.at(n);
+		m_Cache->parsers.clear();
+		m_Cache->paraSet = clParaSet;
+		m_Cache->revision = revision;
+		m_Cache->parseError = FunctionParser::FP_NO_ERROR;
+		++m_Cache->generation;
+		m_Cache->valid = true;
+	}
+	generation = m_Cache->generation;
+	if (m_Cache->parseError!=FunctionParser::FP_NO_ERROR)
+	{
+		EC = m_Cache->parseError+100;
+		return NULL;
+	}
+	if (m_Cache->parsers.size()>0)
+	{
+		CSFunctionParser* fParse = m_Cache->parsers.back();
+		m_Cache->parsers.pop_back();
+		return fParse;
+	}
+
+	CSFunctionParser* fParse = new CSFunctionParser();
+	fParse->Parse(sValue, clParaSet ? clParaSet->GetParameterString() : std::string());
+	if (fParse->GetParseErrorType()!=FunctionParser::FP_NO_ERROR)
+	{
+		m_Cache->parseError = fParse->GetParseErrorType();
+		EC = m_Cache->parseError+100;
+		delete fParse;
+		return NULL;
+	}
+	fParse->Optimize();
+	return fParse;
+}
+
+void ParameterScalar::ReleaseParser(CSFunctionParser* fParse, unsigned int generation)
+{
+	std::lock_guard<std::mutex> lock(m_Cache->mutex);
+	if ((m_Cache->valid) && (m_Cache->generation==generation))
+		m_Cache->parsers.push_back(fParse);
+	else
+		delete fParse;
+}
+
 double ParameterScalar::GetEvaluated(double* ParaValues, int &EC)
 {
 	if (ParameterMode==false) return dValue;
-	CSFunctionParser fParse;
-	fParse.Parse(sValue, clParaSet ? clParaSet->GetParameterString() : std::string());
-	if (fParse.GetParseErrorType()!=FunctionParser::FP_NO_ERROR)
-	{
-		EC = fParse.GetParseErrorType()+100;
+
+	unsigned int generation;
+	CSFunctionParser* fParse = AcquireParser(generation, EC);
+	if (fParse==NULL)
 		return 0;
-	}
-	double dvalue = fParse.Eval(ParaValues);
-	EC = fParse.EvalError();
+	double dvalue = fParse->Eval(ParaValues);
+	EC = fParse->EvalError();
+	ReleaseParser(fParse, generation);
 	return dvalue;
 }
 
-void ParameterScalar::Copy(ParameterScalar* ps)
+void ParameterScalar::GetEvaluated(size_t num, const double* ParaValues, double* values, int &EC)
+{
+	EC = 0;
+	if (ParameterMode==false)
+	{
+		for (size_t n=0;n<num;++n)
+			values[n] = dValue;
+		return;
+	}
+
+	unsigned int generation;
+	CSFunctionParser* fParse = AcquireParser(generation, EC);
+	if (fParse==NULL)
+	{
+		for (size_t n=0;n<num;++n)
+			values[n] = 0;
+		return;
+	}
+	size_t numPara = clParaSet ? clParaSet->GetQtyParameter() : 0;
+	for (size_t n=0;n<num;++n)
+	{
+		values[n] = fParse->Eval(&ParaValues[n*numPara]);
+		if (EC==0)
+			EC = fParse->EvalError();
+	}
+	ReleaseParser(fParse, generation);
+}
+
+void ParameterScalar::AnalyzeDependency()
+{
+	m_Dependency=FindDependency();
+	m_DependencyRevision = clParaSet ? clParaSet->GetRevision() : 0;
+	m_DependencyValid=true;
+
+	// a constant is evaluated once, a failed evaluation is reported by the regular evaluation
+	if ((ParameterMode==true) && (m_Dependency==0) && (Evaluate()!=PS_NO_ERROR))
+		m_DependencyValid=false;
+}
+
+unsigned int ParameterScalar::FindDependency() const
+{
+	unsigned int dependency=0;
+	if (ParameterMode==false)
+		return dependency;
+
+	// scan all identifiers, skipping number literals and function names
+	const std::string &expr = sValue;
+	size_t pos=0;
+	while (pos<expr.size())
+	{
+		unsigned char c = expr.at(pos);
+		if (isdigit(c) || (c=='.'))
+		{
+			// a number, with an optional signed exponent
+			for (++pos;pos<expr.size();++pos)
+			{
+				unsigned char d = expr.at(pos);
+				bool sign = ((d=='+') || (d=='-')) && (tolower((unsigned char)expr.at(pos-1))=='e');
+				if ((isalnum(d)==0) && (d!='.') && (sign==false))
+					break;
+			}
+			continue;
+		}
+		if ((isalpha(c)==0) && (c!='_'))
+		{
+			++pos;
+			continue;
+		}
+		size_t start=pos;
+		while ((pos<expr.size()) && (isalnum((unsigned char)expr.at(pos)) || (expr.at(pos)=='_')))
+			++pos;
+		std::string name = expr.substr(start,pos-start);
+		size_t next=pos;
+		while ((next<expr.size()) && isspace((unsigned char)expr.at(next)))
+			++next;
+		if ((next<expr.size()) && (expr.at(next)=='('))
+			continue;
+		for (size_t n=0;(clParaSet!=NULL) && (n<clParaSet->GetQtyParameter());++n)
+		{
+			if (clParaSet->GetParameter(n)->GetName()!=name)
+				continue;
+			// the mask can not express any later parameter
+			if (n>=8*sizeof(dependency))
+				dependency = ~0u;
+			else
+				dependency |= 1u<<n;
+		}
+	}
+	return dependency;
+}
+
+unsigned int ParameterScalar::GetDependency() const
+{
+	if (ParameterMode==false)
+		return 0;
+	if ((m_DependencyValid==false) || (m_DependencyRevision!=(clParaSet ? clParaSet->GetRevision() : 0)))
+		return ~0u;
+	return m_Dependency;
+}
+
+void ParameterScalar::Copy(const ParameterScalar* ps)
 {
 	SetParameterSet(ps->clParaSet);
 	bModified=ps->bModified;
 	ParameterMode=ps->ParameterMode;
 	sValue=std::string(ps->sValue);
 	dValue=ps->dValue;
+	++m_Revision;
+	ResetCache();
+	m_DependencyValid=false;
 }
 
 std::string PSErrorCode2Msg(int code)
@@ -38,6 +38,7 @@ class ParameterSet;
 class ParameterScalar;
 class TiXmlNode;
 class TiXmlElement;
+class CSFunctionParser;
 
 bool ReadTerm(ParameterScalar &PS, TiXmlElement &elem, const char* attr, double val=0.0);
 void WriteTerm(ParameterScalar &PS, TiXmlElement &elem, const char* attr, bool mode, bool scientific=true);
@@ -52,7 +53,7 @@ class CSXCAD_EXPORT Parameter
 public:
 	Parameter();
 	Parameter(const std::string Paraname, double val);
-	Parameter(const Parameter* parameter) {sName=std::string(parameter->sName);dValue=parameter->dValue;bModified=true;Type=parameter->Type;bSweep=parameter->bSweep;}
+	Parameter(const Parameter* parameter) {sName=std::string(parameter->sName);dValue=parameter->dValue;bModified=true;Type=parameter->Type;bSweep=parameter->bSweep;clParaSet=NULL;}
 	virtual ~Parameter();
 	enum ParameterType
 	{
@@ -61,7 +62,8 @@ public:
 	ParameterType GetType() {return Type;}
 
 	const std::string GetName() {return sName;}
-	void SetName(const std::string Paraname) {sName=std::string(Paraname);bModified=true;}
+	//! Rename this parameter, this changes the revision of its parameter set \sa ParameterSet::GetRevision
+	void SetName(const std::string Paraname);
 
 	virtual double GetValue() {return dValue;}
 	virtual void SetValue(double val) {dValue=val;bModified=true;}
@@ -97,6 +99,9 @@ protected:
 	bool bModified;
 	bool bSweep;
 	ParameterType Type;
+	//! the parameter set this parameter is linked into, NULL if none \sa ParameterSet::LinkParameter
+	ParameterSet* clParaSet;
+	friend class ParameterSet;
 };
 
 class CSXCAD_EXPORT LinearParameter :  public Parameter
@@ -181,9 +186,20 @@ public:
 
 	//! Get the number of parameters in this Parameter-Set
 	size_t GetQtyParameter() {return vParameter.size();}
+	//! Get the revision of the parameter list, it changes with every added, deleted or renamed parameter
+	unsigned int GetRevision() const {return m_Revision;}
 	//! Fill a given array with the parameter values
 	double* GetValueArray(double *array);
 
+	//! Start recording the parameters used by all ParameterScalar evaluated with this set from now on. \sa EndDependencyRecord
+	void BeginDependencyRecord() {m_Recording=true;m_RecordedDependency=0;}
+	//! Stop the recording \return the parameters used since BeginDependencyRecord(), bit n is set for the n-th parameter \sa ParameterScalar::GetDependency
+	unsigned int EndDependencyRecord() {m_Recording=false;return m_RecordedDependency;}
+	//! Check whether the used parameters are recorded. \sa BeginDependencyRecord
+	bool IsRecordingDependency() const {return m_Recording;}
+	//! Add the given parameters to the recording, ignored if not recording
+	void RecordDependency(unsigned int dependency) {if (m_Recording) m_RecordedDependency|=dependency;}
+
 	//! Get the number of necessary sweep steps for the given mode (1: full sweep, 2: sweep independently)
 	int CountSweepSteps(int SweepMode);
 	//! Init a sweep, will set all sweep-enabled Parameter to there initial value
@@ -206,6 +222,11 @@ protected:
 	std::vector<Parameter* > vParameter;
 	bool bModified;
 	int SweepPara;
+	unsigned int m_Revision;
+	bool m_Recording;
+	unsigned int m_RecordedDependency;
+	//! a renamed parameter changes the revision
+	friend class Parameter;
 };
 
 void PSErrorCode2Msg(int code, std::string* msg);
@@ -222,8 +243,11 @@ public:
 	ParameterScalar(ParameterSet* ParaSet, double value);
 	ParameterScalar(ParameterSet* ParaSet, const std::string value);
 	explicit ParameterScalar(ParameterScalar* ps);
+	ParameterScalar(const ParameterScalar& ps);
 	~ParameterScalar();
 
+	ParameterScalar& operator=(const ParameterScalar& ps);
+
 	void SetParameterSet(ParameterSet *paraSet);
 
 	int SetValue(const std::string value, bool Eval=true); ///returns eval-error-code
@@ -239,10 +263,40 @@ public:
 	//returns error-code
 	int Evaluate();
 
+	//! Evaluate the expression for the given parameter values, in the order of the parameter set.
+	/*!
+	 The parsed and optimized expression is cached and only parsed again if the expression or the parameters of the parameter set change.
+	 The evaluation is reentrant, concurrent calls evaluate with parsers of their own.
+	 \param ParaValues Values of all parameter of the parameter set
+	 \param EC Error code of the parser or the evaluation
+	 */
 	double GetEvaluated(double* ParaValues, int &EC);
+	//! Evaluate the expression for many sets of parameter values at once. \sa GetEvaluated
+	/*!
+	 \param num Number of parameter sets
+	 \param ParaValues Values of all parameter of the parameter set, one set after the other
+	 \param values Array of num results to fill
+	 \param EC Error code of the parser or of the first failed evaluation
+	 */
+	void GetEvaluated(size_t num, const double* ParaValues, double* values, int &EC);
+
+	//! Find the parameters of the parameter set the expression refers to. \sa GetDependency
+	/*!
+	 The result is kept until the expression or the parameter set changes. An expression without any parameter is evaluated to its constant value.
+	 */
+	void AnalyzeDependency();
+	//! Get the parameters the expression depends on, bit n is set for the n-th parameter of the parameter set.
+	/*!
+	 Zero for a constant, which is then given by GetValue(). All bits are set if the expression was changed since the last AnalyzeDependency().
+	 \sa AnalyzeDependency
+	 */
+	unsigned int GetDependency() const;
+
+	//! Get the modification revision, changed by every SetValue() and Copy() and by a new parameter set
+	unsigned int GetRevision() const {return m_Revision;}
 
 	// Copy all values and parameter from ps to this.
-	void Copy(ParameterScalar* ps);
+	void Copy(const ParameterScalar* ps);
 
 protected:
 	ParameterSet* clParaSet;
@@ -250,4 +304,23 @@ protected:
 	bool ParameterMode;
 	std::string sValue;
 	double dValue;
+	unsigned int m_Revision;
+
+	//! parsed expressions of GetEvaluated, created with the expression
+	struct ParserCache;
+	ParserCache* m_Cache;
+	void ResetCache();
+
+	//! Scan the expression for the parameters of the parameter set \sa AnalyzeDependency
+	unsigned int FindDependency() const;
+
+	//! result of AnalyzeDependency, valid for the given revision of the parameter set
+	bool m_DependencyValid;
+	unsigned int m_Dependency;
+	unsigned int m_DependencyRevision;
+
+	//! Get a parsed expression for an evaluation, parsed again if the expression or the parameter set has changed. NULL on a parse error.
+	CSFunctionParser* AcquireParser(unsigned int &generation, int &EC);
+	//! Return a parser of AcquireParser() for the next evaluation
+	void ReleaseParser(CSFunctionParser* fParse, unsigned int generation);
 };
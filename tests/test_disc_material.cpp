@@ -0,0 +1,367 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Tests for the lookup of discrete materials.
+
+  Discrete material files with uniform and non-uniform voxel meshes are written
+  to the working directory. The material values at points inside, on and
+  outside of the voxel mesh have to agree with a plain search for the voxel,
+  whichever way the voxel of a point is found. The material of a volume of grid
+  lines has to agree exactly with the material at each point, with and without
+  a transform of the voxel data. Reading only the voxels of a region of
+  interest from a chunked and compressed file must not change the material
+  inside of that region. Index volumes of 8 and 16 bit are read. The surface
+  model has to cover the faces between the materials exactly, with closed
+  surfaces if the materials are separated.
+
+  Build with -DCSXCAD_BUILD_TESTS=ON and run it through ctest.
+  Exits non-zero and prints "FAIL: ..." per failed check.
+*/
+
+#include "ContinuousStructure.h"
+#include "CSPropDiscMaterial.h"
+#include "CSTransform.h"
+
+#include <vtkPolyData.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkIdList.h>
+
+#include <hdf5.h>
+#include <hdf5_hl.h>
+
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+#include <math.h>
+
+static int fails = 0;
+#define CHECK(cond, msg) do { if (!(cond)) { std::cout << "FAIL: " << msg << "\n"; ++fails; } } while (0)
+
+//! the size of the material database, an index volume of more than 256 materials is written with 16 bit
+static int db_size = 5;
+
+//! the material index of a voxel
+static unsigned int voxel_index(size_t i, size_t j, size_t k)
+{
+	return (unsigned int)((i+13*j+101*k)%db_size);
+}
+
+//! A discrete material file on the given meshes, with epsR = 2+index and kappa = index/10, optional a chunked and compressed index volume
+static bool write_disc(const char* fn, const std::vector<float> mesh[3], bool chunked=false)
+{
+	hid_t fid = H5Fcreate(fn, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+	if (fid<0)
+		return false;
+	std::vector<unsigned short> index;
+	for (size_t k=0;k<mesh[2].size()-1;++k)
+		for (size_t j=0;j<mesh[1].size()-1;++j)
+			for (size_t i=0;i<mesh[0].size()-1;++i)
+				index.push_back(voxel_index(i,j,k));
+	std::vector<float> epsR(db_size), kappa(db_size);
+	for (int n=0;n<db_size;++n)
+	{
+		epsR[n] = 2+n;
+		kappa[n] = n/10.0f;
+	}
+	double version = 2.0;
+	hsize_t dims[3] = {mesh[2].size()-1, mesh[1].size()-1, mesh[0].size()-1};
+	bool ok = H5LTset_attribute_double(fid, "/", "Version", &version, 1)>=0;
+	hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+	if (chunked)
+	{
+		hsize_t chunk[3] = {2,3,4};
+		H5Pset_chunk(dcpl, 3, chunk);
+		H5Pset_deflate(dcpl, 6);
+	}
+	hid_t space = H5Screate_simple(3, dims, NULL);
+	hid_t dset = H5Dcreate2(fid, "/DiscData", (db_size>256) ? H5T_STD_U16LE : H5T_STD_U8LE, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+	ok &= (dset>=0) && (H5Dwrite(dset, H5T_NATIVE_USHORT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &index[0])>=0);
+	H5Dclose(dset);
+	H5Sclose(space);
+	H5Pclose(dcpl);
+	ok &= H5LTset_attribute_int(fid, "/DiscData", "DB_Size", &db_size, 1)>=0;
+	ok &= H5LTset_attribute_float(fid, "/DiscData", "epsR", &epsR[0], db_size)>=0;
+	ok &= H5LTset_attribute_float(fid, "/DiscData", "kappa", &kappa[0], db_size)>=0;
+	hid_t group = H5Gcreate2(fid, "/mesh", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	ok &= group>=0;
+	H5Gclose(group);
+	const char* names[3] = {"/mesh/x","/mesh/y","/mesh/z"};
+	for (int n=0;n<3;++n)
+	{
+		hsize_t size = mesh[n].size();
+		ok &= H5LTmake_dataset_float(fid, names[n], 1, &size, &mesh[n][0])>=0;
+	}
+	H5Fclose(fid);
+	return ok;
+}
+
+//! plain search for the voxel on one axis, the last voxel includes the upper mesh line, -1 if outside
+static int reference_cell(const std::vector<float>& mesh, double c)
+{
+	if ((c<mesh.front()) || (c>mesh.back()))
+		return -1;
+	for (size_t i=1;i<mesh.size()-1;++i)
+		if (c<mesh[i])
+			return i-1;
+	return mesh.size()-2;
+}
+
+//! the material of a volume of grid lines has to agree with the material at each point
+static void compare_volume(const char* name, CSPropDiscMaterial* disc, const std::vector<double> lines[3])
+{
+	std::vector<double> volume[5];
+	disc->GetWeightedVolume(1, lines, volume[0], volume[1], volume[2], volume[3], volume[4]);
+	size_t wrong = 0, n = 0;
+	for (size_t i=0;i<lines[0].size();++i)
+		for (size_t j=0;j<lines[1].size();++j)
+			for (size_t k=0;k<lines[2].size();++k,++n)
+			{
+				double c[3] = {lines[0][i], lines[1][j], lines[2][k]};
+				double ref[5] = {disc->GetEpsilonWeighted(1,c), disc->GetMueWeighted(1,c), disc->GetKappaWeighted(1,c), disc->GetSigmaWeighted(1,c), disc->GetDensityWeighted(c)};
+				for (int m=0;m<5;++m)
+					if ((n<volume[m].size()) && (volume[m][n]!=ref[m]))
+						++wrong;
+			}
+	CHECK(wrong==0, name << ": " << wrong << " wrong material values of a volume");
+	for (int m=0;m<5;++m)
+		CHECK(volume[m].size()==n, name << ": size of a material volume");
+}
+
+//! the surface has to cover every face between two materials once, a closed surface per material if separated
+static void compare_surface(const char* name, CSPropDiscMaterial* disc, const std::vector<float> mesh[3], bool separate)
+{
+	// the area of all faces of each material, and the sum of their outward normals
+	std::vector<double> area(db_size,0), ref(db_size,0);
+	std::vector<double> normal(3*db_size,0);
+	for (int n=0;n<3;++n)
+	{
+		int nP = (n+1)%3, nPP = (n+2)%3;
+		size_t pos[3];
+		for (pos[n]=0;pos[n]<mesh[n].size();++pos[n])
+			for (pos[nP]=0;pos[nP]+1<mesh[nP].size();++pos[nP])
+				for (pos[nPP]=0;pos[nPP]+1<mesh[nPP].size();++pos[nPP])
+				{
+					unsigned int up = 0, down = 0;
+					if (pos[n]+1<mesh[n].size())
+						up = voxel_index(pos[0],pos[1],pos[2]);
+					if (pos[n]>0)
+					{
+						--pos[n];
+						down = voxel_index(pos[0],pos[1],pos[2]);
+						++pos[n];
+					}
+					if ((up==down) || (!separate && up && down))
+						continue;
+					double a = (mesh[nP][pos[nP]+1]-mesh[nP][pos[nP]])*(mesh[nPP][pos[nPP]+1]-mesh[nPP][pos[nPP]]);
+					ref[up] += up ? a : 0;
+					ref[down] += down ? a : 0;
+				}
+	}
+
+	vtkPolyData* polydata = disc->CreatePolyDataModel(separate, 3);
+	CHECK(polydata, name << ": no surface");
+	if (polydata==NULL)
+		return;
+	vtkDataArray* mat = polydata->GetCellData()->GetArray("MaterialIndex");
+	CHECK(mat && (mat->GetNumberOfTuples()==polydata->GetNumberOfCells()), name << ": material index of the surface");
+	vtkIdList* ids = vtkIdList::New();
+	for (vtkIdType c=0;mat && (c<polydata->GetNumberOfCells());++c)
+	{
+		polydata->GetCellPoints(c, ids);
+		double p[4][3];
+		for (int i=0;i<4;++i)
+			polydata->GetPoint(ids->GetId(i), p[i]);
+		double e1[3], e2[3];
+		for (int d=0;d<3;++d)
+		{
+			e1[d] = p[1][d]-p[0][d];
+			e2[d] = p[3][d]-p[0][d];
+		}
+		double cross[3] = {e1[1]*e2[2]-e1[2]*e2[1], e1[2]*e2[0]-e1[0]*e2[2], e1[0]*e2[1]-e1[1]*e2[0]};
+		unsigned int m = (unsigned int)mat->GetTuple1(c);
+		area[m] += fabs(cross[0])+fabs(cross[1])+fabs(cross[2]);
+		for (int d=0;d<3;++d)
+			normal[3*m+d] += cross[d];
+	}
+	ids->Delete();
+	polydata->Delete();
+
+	size_t wrong = 0, open = 0;
+	for (int m=0;m<db_size;++m)
+	{
+		if (fabs(area[m]-ref[m])>1e-6*(1+ref[m]))
+			++wrong;
+		for (int d=0;d<3;++d)
+			if (separate && (fabs(normal[3*m+d])>1e-6*(1+ref[m])))
+				++open;
+	}
+	CHECK(wrong==0, name << ": " << wrong << " materials with a wrong surface area");
+	CHECK(open==0, name << ": " << open << " open material surfaces");
+}
+
+static void compare(const char* name, const std::vector<float> mesh[3])
+{
+	const char* fn = "test_disc_material.h5";
+	CHECK(write_disc(fn, mesh), name << ": could not write " << fn);
+
+	ContinuousStructure csx;
+	CSPropDiscMaterial* disc = new CSPropDiscMaterial(csx.GetParameterSet());
+	csx.AddProperty(disc);
+	disc->SetEpsilon(1.5);
+	disc->SetFilename(fn);
+	disc->SetFileType(0);
+	CHECK(disc->ReadFile(), name << ": could not read " << fn);
+	remove(fn);
+
+	// points on and between all mesh lines, and beyond the mesh
+	std::vector<double> pos[3];
+	for (int n=0;n<3;++n)
+	{
+		const std::vector<float>& m = mesh[n];
+		pos[n].push_back(m.front()-0.1);
+		for (size_t i=0;i<m.size();++i)
+		{
+			pos[n].push_back(m[i]);
+			pos[n].push_back(nextafter((double)m[i], -1e9));
+			pos[n].push_back(nextafter((double)m[i], 1e9));
+			if (i+1<m.size())
+				pos[n].push_back(0.3*m[i]+0.7*m[i+1]);
+		}
+		pos[n].push_back(m.back()+0.1);
+	}
+
+	std::vector<double> coords, eps, kappa;
+	for (size_t k=0;k<pos[2].size();++k)
+		for (size_t j=0;j<pos[1].size();++j)
+			for (size_t i=0;i<pos[0].size();++i)
+			{
+				double c[3] = {pos[0][i], pos[1][j], pos[2][k]};
+				coords.insert(coords.end(), c, c+3);
+				int ci = reference_cell(mesh[0],c[0]), cj = reference_cell(mesh[1],c[1]), ck = reference_cell(mesh[2],c[2]);
+				bool inside = (ci>=0) && (cj>=0) && (ck>=0);
+				int idx = inside ? voxel_index(ci,cj,ck) : -1;
+				eps.push_back(inside ? 2+idx : 1.5);
+				kappa.push_back(inside ? (double)(idx/10.0f) : 0);
+			}
+
+	size_t num = eps.size(), wrong = 0;
+	for (size_t n=0;n<num;++n)
+		if ((disc->GetEpsilonWeighted(0,&coords[3*n])!=eps[n]) || (disc->GetKappaWeighted(1,&coords[3*n])!=kappa[n]))
+			++wrong;
+	CHECK(wrong==0, name << ": " << wrong << " of " << num << " points with wrong material");
+
+	std::vector<double> values(num);
+	disc->GetEpsilonWeighted(2, num, &coords[0], &values[0]);
+	CHECK(values==eps, name << ": material of many points at once");
+
+	compare_volume(name, disc, pos);
+	compare_surface(name, disc, mesh, false);
+	compare_surface(name, disc, mesh, true);
+	// continuous material for index 0, a transform along the axes and a rotated one
+	disc->SetUseDataBaseForBackground(false);
+	disc->SetScale(2.5);
+	CSTransform* transform = new CSTransform(csx.GetParameterSet());
+	double shift[3] = {0.1,-0.2,3};
+	transform->Translate(shift);
+	transform->Scale(0.4);
+	disc->SetTransform(transform);
+	compare_volume(name, disc, pos);
+	transform->RotateZ(30);
+	compare_volume(name, disc, pos);
+}
+
+//! only the voxels of a region of interest are read, the material inside of it has to be unchanged
+static void compare_roi(const char* name, const std::vector<float> mesh[3])
+{
+	const char* fn = "test_disc_material_roi.h5";
+	CHECK(write_disc(fn, mesh, true), name << ": could not write " << fn);
+
+	ContinuousStructure csx;
+	CSPropDiscMaterial* full = new CSPropDiscMaterial(csx.GetParameterSet());
+	CSPropDiscMaterial* part = new CSPropDiscMaterial(csx.GetParameterSet());
+	csx.AddProperty(full);
+	csx.AddProperty(part);
+	double roi[6];
+	for (int n=0;n<3;++n)
+	{
+		roi[2*n] = 0.7*mesh[n].front()+0.3*mesh[n].back();
+		roi[2*n+1] = 0.4*mesh[n].front()+0.6*mesh[n].back();
+	}
+	CSPropDiscMaterial* disc[2] = {full, part};
+	for (int d=0;d<2;++d)
+	{
+		disc[d]->SetEpsilon(1.5);
+		disc[d]->SetFilename(fn);
+		disc[d]->SetFileType(0);
+	}
+	part->SetRegionOfInterest(roi);
+	CHECK(full->ReadFile() && part->ReadFile(), name << ": could not read " << fn);
+	remove(fn);
+
+	size_t wrong = 0;
+	for (int n=0;n<=20;++n)
+		for (int m=0;m<=20;++m)
+			for (int l=0;l<=20;++l)
+			{
+				double c[3] = {roi[0]+(roi[1]-roi[0])*n/20, roi[2]+(roi[3]-roi[2])*m/20, roi[4]+(roi[5]-roi[4])*l/20};
+				if (full->GetEpsilonWeighted(0,c)!=part->GetEpsilonWeighted(0,c))
+					++wrong;
+			}
+	CHECK(wrong==0, name << ": " << wrong << " points with wrong material inside of the region of interest");
+	double outside[3] = {mesh[0].front(), mesh[1].front(), mesh[2].front()};
+	CHECK((full->GetEpsilonWeighted(0,outside)==2) && (part->GetEpsilonWeighted(0,outside)==1.5), name << ": material outside of the region of interest");
+
+	double missed[6] = {mesh[0].back()+1, mesh[0].back()+2, roi[2], roi[3], roi[4], roi[5]};
+	part->SetRegionOfInterest(missed);
+	CHECK(!part->ReadFile(), name << ": region of interest without voxels read");
+}
+
+int main()
+{
+	std::vector<float> mesh[3];
+	for (int n=0;n<=12;++n)
+		mesh[0].push_back(-0.3f+0.1f*n);
+	for (int n=0;n<=7;++n)
+		mesh[1].push_back(1e-3f*n);
+	for (int n=0;n<=9;++n)
+		mesh[2].push_back(0.25f*n*n-4);
+	compare("mixed meshes", mesh);
+	compare_roi("mixed meshes", mesh);
+
+	for (int n=0;n<3;++n)
+		mesh[n].assign(2, 0.0f);
+	mesh[0][1] = 1; mesh[1][1] = 2; mesh[2][1] = 0.5f;
+	compare("single voxel", mesh);
+
+	// a 16 bit index volume
+	db_size = 1000;
+	for (int n=0;n<3;++n)
+		mesh[n].clear();
+	for (int n=0;n<=10;++n)
+	{
+		mesh[0].push_back(0.5f*n);
+		mesh[1].push_back(0.1f*n*n);
+		mesh[2].push_back(-2.0f+0.4f*n);
+	}
+	compare("16 bit index", mesh);
+	compare_roi("16 bit index", mesh);
+
+	std::cout << (fails ? "FAILED" : "all discrete material tests passed") << std::endl;
+	return fails != 0;
+}
@@ -0,0 +1,319 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Tests for the evaluation of weighting functions.
+
+  The parsed weighting functions are cached, every evaluation therefore has to
+  follow changes of the function and of the parameter set, and copies must not
+  share the cache of their origin. The expected values are computed directly
+  from the coordinates, the evaluation of many coordinates at once has to agree
+  exactly with the evaluation per coordinate, with and without the analysis of
+  the variables a weighting function depends on. The excitation weights are
+  evaluated from several threads at once as well.
+
+  Build with -DCSXCAD_BUILD_TESTS=ON and run it through ctest.
+  Exits non-zero and prints "FAIL: ..." per failed check.
+*/
+
+#include "ContinuousStructure.h"
+#include "CSPropMaterial.h"
+#include "CSPropLorentzMaterial.h"
+#include "CSPropExcitation.h"
+#include "ParameterObjects.h"
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <math.h>
+
+static int fails = 0;
+#define CHECK(cond, msg) do { if (!(cond)) { std::cout << "FAIL: " << msg << "\n"; ++fails; } } while (0)
+
+static bool near(double a, double b)
+{
+	return fabs(a-b)<=1e-12*(1+fabs(a)+fabs(b));
+}
+
+int main()
+{
+	// 1. a cached expression follows changes of the expression and of the parameter set
+	{
+		ParameterSet set;
+		set.LinkParameter(new Parameter("a",2));
+		set.LinkParameter(new Parameter("b",3));
+		ParameterScalar ps(&set, "a*b+1");
+		double values[2] = {2,3};
+		int EC = 0;
+		CHECK(near(ps.GetEvaluated(values,EC),7) && EC==0, "a*b+1");
+		values[1] = 5;
+		CHECK(near(ps.GetEvaluated(values,EC),11) && EC==0, "a*b+1 with new values");
+
+		ps.SetValue("a-b");
+		CHECK(near(ps.GetEvaluated(values,EC),-3) && EC==0, "changed expression");
+
+		// copies evaluate on their own
+		ParameterScalar copy(ps);
+		std::vector<ParameterScalar> list(3, ps);
+		ps.SetValue("a+b");
+		CHECK(near(copy.GetEvaluated(values,EC),-3), "copy keeps its expression");
+		CHECK(near(list.at(2).GetEvaluated(values,EC),-3), "copy in a vector keeps its expression");
+		CHECK(near(ps.GetEvaluated(values,EC),7), "origin changed after the copy");
+		list.at(1) = ps;
+		CHECK(near(list.at(1).GetEvaluated(values,EC),7), "assigned copy");
+
+		// the parameter order is given by the set, a changed set needs a new parse
+		ParameterScalar third(&set, "c");
+		CHECK(third.GetEvaluated(values,EC)==0 && EC!=0, "unknown parameter");
+		set.LinkParameter(new Parameter("c",4));
+		double values3[3] = {2,5,4};
+		CHECK(near(third.GetEvaluated(values3,EC),4) && EC==0, "parameter added to the set");
+		set.DeleteParameter((size_t)0);
+		double values2[2] = {5,4};
+		CHECK(near(third.GetEvaluated(values2,EC),4) && EC==0, "parameter deleted from the set");
+
+		// a renamed parameter is no longer known by its old name, swapped names swap the values
+		set.GetParameter(1)->SetName("d");
+		CHECK(third.GetEvaluated(values2,EC)==0 && EC!=0, "renamed parameter");
+		ParameterScalar diff(&set, "b-d");
+		CHECK(near(diff.GetEvaluated(values2,EC),1) && EC==0, "b-d");
+		set.GetParameter(0)->SetName("d");
+		set.GetParameter(1)->SetName("b");
+		CHECK(near(diff.GetEvaluated(values2,EC),-1) && EC==0, "b-d with swapped names");
+
+		// a constant value is never parsed
+		ParameterScalar constant(&set, 1.5);
+		CHECK(near(constant.GetEvaluated(NULL,EC),1.5), "constant");
+	}
+
+	// 2. the parameters an expression depends on, in the order of the coordinate variables
+	{
+		ParameterSet set;
+		const char* names[7] = {"x","y","z","rho","r","a","t"};
+		for (int n=0;n<7;++n)
+			set.LinkParameter(new Parameter(names[n],0));
+		struct {const char* expr; unsigned int dep;} cases[] = {
+			{"2*3+1", 0}, {"x+sin(a)", 1|32}, {"rho*1e-3", 8}, {"r", 16}, {"exp(t)*2.5e+3*z", 4|64},
+			{"sqrt(x*x + y*y)", 1|2}, {"if(r<1, 1, 0)", 16}};
+		for (size_t n=0;n<sizeof(cases)/sizeof(cases[0]);++n)
+		{
+			ParameterScalar ps(&set, cases[n].expr);
+			CHECK(ps.GetDependency()==~0u, "not analyzed: " << cases[n].expr);
+			ps.AnalyzeDependency();
+			CHECK(ps.GetDependency()==cases[n].dep, "dependency of " << cases[n].expr << ": " << ps.GetDependency());
+			ps.SetValue("y");
+			CHECK(ps.GetDependency()==~0u, "changed after the analysis: " << cases[n].expr);
+		}
+		ParameterScalar renamed(&set, "r");
+		renamed.AnalyzeDependency();
+		set.GetParameter(4)->SetName("r2");
+		CHECK(renamed.GetDependency()==~0u, "renamed after the analysis");
+		set.GetParameter(4)->SetName("r");
+		ParameterScalar constant(&set, "2*3+1");
+		constant.AnalyzeDependency();
+		CHECK(constant.GetDependency()==0 && constant.GetValue()==7, "constant expression");
+		ParameterScalar plain(&set, 1.0);
+		CHECK(plain.GetDependency()==0, "plain value");
+	}
+
+	// 3. weighted material values, evaluated repeatedly
+	{
+		ContinuousStructure csx;
+		CSPropMaterial* mat = new CSPropMaterial(csx.GetParameterSet());
+		csx.AddProperty(mat);
+		mat->SetEpsilon(2.0);
+		mat->SetEpsilonWeightFunction("x+2*y+z*z", 0);
+		mat->SetMueWeightFunction("rho", 0);
+		mat->SetKappa(1.0);
+		mat->SetKappaWeightFunction("r", 0);
+		CHECK(mat->Update(), "material update");
+
+		for (int n=0;n<100;++n)
+		{
+			double coord[3] = {0.1*n-3, 0.05*n+0.5, 2-0.03*n};
+			double eps = 2*(coord[0]+2*coord[1]+coord[2]*coord[2]);
+			double rho = sqrt(coord[0]*coord[0]+coord[1]*coord[1]);
+			double r = sqrt(rho*rho+coord[2]*coord[2]);
+			CHECK(near(mat->GetEpsilonWeighted(0,coord),eps), "epsilon weighted " << n);
+			CHECK(near(mat->GetMueWeighted(0,coord),rho), "mue weighted " << n);
+			CHECK(near(mat->GetKappaWeighted(0,coord),r), "kappa weighted " << n);
+		}
+		double coord[3] = {1,2,3};
+		mat->SetEpsilonWeightFunction("y", 0);
+		CHECK(near(mat->GetEpsilonWeighted(0,coord),4), "epsilon weight function changed");
+
+		CSPropMaterial* copy = new CSPropMaterial(mat, false);
+		mat->SetEpsilonWeightFunction("z", 0);
+		CHECK(near(copy->GetEpsilonWeighted(0,coord),4), "copied material keeps its weight function");
+		CHECK(near(mat->GetEpsilonWeighted(0,coord),6), "material weight function changed after the copy");
+		delete copy;
+	}
+
+	// 4. many coordinates at once, cartesian and cylindrical
+	for (int cyl=0;cyl<2;++cyl)
+	{
+		ContinuousStructure csx;
+		CSPropMaterial* mat = new CSPropMaterial(csx.GetParameterSet());
+		csx.AddProperty(mat);
+		mat->SetIsotropy(false);
+		mat->SetEpsilon(3.0,1);
+		mat->SetEpsilonWeightFunction("x*y+sin(a)+cos(t)", 1);
+		mat->SetMueWeightFunction("r-rho", 0);
+		mat->SetKappa(2.0,2);
+		mat->SetSigma(0.5,0);
+		mat->SetSigmaWeightFunction("z", 0);
+		mat->SetDensity(7.0);
+		mat->SetDensityWeightFunction("2+x");
+		mat->SetKappaWeightFunction("3*4", 2);
+		if (cyl)
+			mat->SetCoordInputType(CYLINDRICAL);
+		CHECK(mat->Update(), "material update");
+
+		// more coordinates than one block of the evaluation
+		const size_t num = 1000;
+		std::vector<double> coords(3*num);
+		for (size_t n=0;n<num;++n)
+		{
+			coords[3*n] = cyl ? 0.1+0.01*n : 0.01*n-5;
+			coords[3*n+1] = cyl ? 0.007*n-3 : 4-0.013*n;
+			coords[3*n+2] = 0.002*n-1;
+		}
+		std::vector<double> values(num);
+		size_t mismatch = 0;
+		for (int ny=0;ny<3;++ny)
+		{
+			mat->GetEpsilonWeighted(ny,num,&coords[0],&values[0]);
+			for (size_t n=0;n<num;++n)
+				mismatch += values[n]!=mat->GetEpsilonWeighted(ny,&coords[3*n]);
+			mat->GetMueWeighted(ny,num,&coords[0],&values[0]);
+			for (size_t n=0;n<num;++n)
+				mismatch += values[n]!=mat->GetMueWeighted(ny,&coords[3*n]);
+			mat->GetKappaWeighted(ny,num,&coords[0],&values[0]);
+			for (size_t n=0;n<num;++n)
+				mismatch += values[n]!=mat->GetKappaWeighted(ny,&coords[3*n]);
+			mat->GetSigmaWeighted(ny,num,&coords[0],&values[0]);
+			for (size_t n=0;n<num;++n)
+				mismatch += values[n]!=mat->GetSigmaWeighted(ny,&coords[3*n]);
+		}
+		mat->GetDensityWeighted(num,&coords[0],&values[0]);
+		for (size_t n=0;n<num;++n)
+			mismatch += values[n]!=mat->GetDensityWeighted(&coords[3*n]);
+		CHECK(mismatch==0, mismatch << " weighted values differ from the single evaluation, cylindrical: " << cyl);
+		CHECK(values[10]==7.0*(2+(cyl ? coords[30]*cos(coords[31]) : coords[30])), "density weighted");
+		mat->GetKappaWeighted(2,num,&coords[0],&values[0]);
+		CHECK(values[0]==24 && values[num-1]==24, "constant weight function");
+
+		mat->GetEpsilonWeighted(3,num,&coords[0],&values[0]);
+		CHECK(values[0]==0 && values[num-1]==0, "invalid direction");
+	}
+
+	// 5. dispersive weighting functions at many coordinates
+	{
+		ContinuousStructure csx;
+		CSPropLorentzMaterial* mat = new CSPropLorentzMaterial(csx.GetParameterSet());
+		csx.AddProperty(mat);
+		mat->SetDispersionOrder(2);
+		mat->SetEpsPlasmaFreq(1, 1e9);
+		mat->SetEpsPlasmaFreqWeightFunction(1, "x+y", 0);
+		mat->SetMueRelaxTime(0, 1e-12);
+		mat->SetMueRelaxTimeWeightFunction(0, "z*z", 0);
+		CHECK(mat->Update(), "lorentz material update");
+
+		double coords[12] = {1,2,3, -1,0.5,2, 0,0,1, 4,-3,0};
+		double values[4];
+		mat->GetEpsPlasmaFreqWeighted(1,0,4,coords,values);
+		for (int n=0;n<4;++n)
+			CHECK(values[n]==mat->GetEpsPlasmaFreqWeighted(1,0,&coords[3*n]) && near(values[n],1e9*(coords[3*n]+coords[3*n+1])), "plasma frequency weighted " << n);
+		mat->GetMueRelaxTimeWeighted(0,0,4,coords,values);
+		for (int n=0;n<4;++n)
+			CHECK(values[n]==mat->GetMueRelaxTimeWeighted(0,0,&coords[3*n]), "relaxation time weighted " << n);
+		mat->GetEpsPlasmaFreqWeighted(2,0,4,coords,values);
+		CHECK(values[0]==0 && values[3]==0, "invalid order");
+	}
+
+	// 6. weighted excitations, per coordinate, at many coordinates and from many threads
+	{
+		ContinuousStructure csx;
+		CSPropExcitation* exc = new CSPropExcitation(csx.GetParameterSet());
+		csx.AddProperty(exc);
+		exc->SetExcitation(2.0,0);
+		exc->SetExcitation(1.0,1);
+		exc->SetExcitation(-1.0,2);
+		exc->SetWeightFunction("x*y+z", 0);
+		exc->SetWeightFunction("cos(a)*r", 1);
+		exc->SetWeightOrigin(1,0,-1);
+		CHECK(exc->Update(), "excitation update");
+
+		const size_t num = 500;
+		std::vector<double> coords(3*num);
+		for (size_t n=0;n<num;++n)
+		{
+			coords[3*n] = 0.02*n-4;
+			coords[3*n+1] = 3-0.01*n;
+			coords[3*n+2] = 0.005*n;
+		}
+		std::vector<double> expected(3*num);
+		for (size_t n=0;n<num;++n)
+		{
+			double x = coords[3*n]-1, y = coords[3*n+1], z = coords[3*n+2]+1;
+			expected[3*n] = 2*(x*y+z);
+			CHECK(near(exc->GetWeightedExcitation(0,&coords[3*n]),expected[3*n]), "weighted excitation " << n);
+			expected[3*n+1] = exc->GetWeightedExcitation(1,&coords[3*n]);
+			CHECK(near(expected[3*n+1],cos(atan2(y,x))*sqrt(x*x+y*y+z*z)), "weighted excitation with r and alpha " << n);
+			expected[3*n+2] = -1;
+		}
+
+		std::vector<double> values(num);
+		size_t mismatch = 0;
+		for (int ny=0;ny<3;++ny)
+		{
+			exc->GetWeightedExcitation(ny,num,&coords[0],&values[0]);
+			for (size_t n=0;n<num;++n)
+				mismatch += values[n]!=exc->GetWeightedExcitation(ny,&coords[3*n]);
+		}
+		CHECK(mismatch==0, mismatch << " weighted excitations differ from the single evaluation");
+
+		// every thread evaluates all coordinates, one by one and at once
+		std::vector<size_t> thread_mismatch(4,0);
+		std::vector<std::thread> threads;
+		for (size_t t=0;t<thread_mismatch.size();++t)
+			threads.push_back(std::thread([&,t]()
+			{
+				std::vector<double> local(num);
+				for (int ny=0;ny<3;++ny)
+				{
+					for (size_t n=0;n<num;++n)
+						thread_mismatch[t] += exc->GetWeightedExcitation(ny,&coords[3*n])!=expected[3*n+ny];
+					exc->GetWeightedExcitation(ny,num,&coords[0],&local[0]);
+					for (size_t n=0;n<num;++n)
+						thread_mismatch[t] += local[n]!=expected[3*n+ny];
+				}
+			}));
+		for (size_t t=0;t<threads.size();++t)
+			threads.at(t).join();
+		for (size_t t=0;t<thread_mismatch.size();++t)
+			CHECK(thread_mismatch[t]==0, thread_mismatch[t] << " weighted excitations differ in thread " << t);
+
+		exc->SetWeightFunction("z", 0);
+		CHECK(exc->GetWeightedExcitation(0,&coords[0])==2*(coords[2]+1), "changed excitation weight function");
+		exc->GetWeightedExcitation(3,num,&coords[0],&values[0]);
+		CHECK(values[0]==0 && values[num-1]==0, "invalid excitation component");
+	}
+
+	std::cout << (fails ? "FAILED" : "all material weight tests passed") << std::endl;
+	return fails != 0;
+}
@@ -0,0 +1,305 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Tests for the mesh generation of ContinuousStructure.
+
+  The generated grid has to have a line at every edge of the primitives, or
+  the two lines of the thirds rule at the edges of metal sheets, keep the lines
+  already in the grid and stay below the max. resolution. The result must not
+  depend on the number of threads.
+
+  Inserting the bounding box edges into the grid has to give the sorted unique
+  union of the grid lines and the edges, in one or all directions.
+
+  Build with -DCSXCAD_BUILD_TESTS=ON and run it through ctest.
+  Exits non-zero and prints "FAIL: ..." per failed check.
+*/
+
+#include "ContinuousStructure.h"
+#include "CSPropMaterial.h"
+#include "CSPropMetal.h"
+#include "CSPrimBox.h"
+#include "CSPrimPolygon.h"
+#include "CSPrimLinPoly.h"
+#include "CSTransform.h"
+#include "CSRectGrid.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+static int fails = 0;
+#define CHECK(cond, msg) do { if (!(cond)) { std::cout << "FAIL: " << msg << "\n"; ++fails; } } while (0)
+
+static bool has_line(CSRectGrid* grid, int ny, double val)
+{
+	for (size_t n=0;n<grid->GetQtyLines(ny);++n)
+		if (fabs(grid->GetLine(ny,n)-val)<1e-9)
+			return true;
+	return false;
+}
+
+static double max_cell(CSRectGrid* grid, int ny)
+{
+	double res = 0;
+	for (size_t n=1;n<grid->GetQtyLines(ny);++n)
+		res = std::max(res, grid->GetLine(ny,n)-grid->GetLine(ny,n-1));
+	return res;
+}
+
+static CSPrimBox* add_box(ParameterSet* ps, CSProperties* prop, const double box[6])
+{
+	CSPrimBox* prim = new CSPrimBox(ps, prop);
+	for (int n=0;n<6;++n)
+		prim->SetCoord(n, box[n]);
+	return prim;
+}
+
+int main()
+{
+	double max_res[3] = {0.5, 0.5, 0.5};
+
+	// a material box, lines at all faces
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMaterial* mat = new CSPropMaterial(ps);
+		csx.AddProperty(mat);
+		double box[6] = {-1, 2, 0, 3, -2.5, 0.5};
+		add_box(ps, mat, box);
+		csx.Update();
+		CSRectGrid* grid = csx.GetGrid();
+		CHECK(csx.GenerateMesh(max_res), "box: mesh generation failed");
+		for (int n=0;n<3;++n)
+		{
+			CHECK(has_line(grid, n, box[2*n]) && has_line(grid, n, box[2*n+1]), "box: missing face line in direction " << n);
+			CHECK(max_cell(grid, n)<=max_res[n]*(1+1e-10), "box: cell too large in direction " << n);
+		}
+	}
+
+	// a metal sheet, thirds rule in the sheet plane, a plain line at the sheet
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMetal* metal = new CSPropMetal(ps);
+		csx.AddProperty(metal);
+		double sheet[6] = {0, 3, -1, 1, 0.5, 0.5};
+		CSPrimBox* box = add_box(ps, metal, sheet);
+		csx.Update();
+		CSRectGrid* grid = csx.GetGrid();
+		CHECK(csx.GenerateMesh(max_res, 1.5, 0.3), "sheet: mesh generation failed");
+		CHECK(has_line(grid, 0, 0.1) && has_line(grid, 0, -0.2) && !has_line(grid, 0, 0), "sheet: no thirds rule at the lower x edge");
+		CHECK(has_line(grid, 0, 2.9) && has_line(grid, 0, 3.2) && !has_line(grid, 0, 3), "sheet: no thirds rule at the upper x edge");
+		CHECK(has_line(grid, 1, -0.9) && has_line(grid, 1, 0.9), "sheet: no thirds rule in y");
+		CHECK(has_line(grid, 2, 0.5) && grid->GetQtyLines(2)==1, "sheet: no plain line at the sheet plane");
+
+		// without a metal edge resolution all edges get a plain line
+		grid->ClearLines(0);
+		grid->ClearLines(1);
+		grid->ClearLines(2);
+		CHECK(csx.GenerateMesh(max_res), "sheet: mesh generation failed");
+		CHECK(has_line(grid, 0, 0) && has_line(grid, 0, 3) && has_line(grid, 1, -1) && has_line(grid, 1, 1), "sheet: missing edge lines");
+
+		// a sheet modified after the last update is updated before the edges are collected
+		box->SetCoord(1, 4.0);
+		grid->ClearLines(0);
+		grid->ClearLines(1);
+		grid->ClearLines(2);
+		CHECK(csx.GenerateMesh(max_res, 1.5, 0.3), "modified sheet: mesh generation failed");
+		CHECK(has_line(grid, 0, 3.9) && has_line(grid, 0, 4.2) && !has_line(grid, 0, 3.2), "modified sheet: no thirds rule at the modified x edge");
+	}
+
+	// an L-shaped metal polygon, the inner edges are metal edges as well
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMetal* metal = new CSPropMetal(ps);
+		csx.AddProperty(metal);
+		CSPrimPolygon* poly = new CSPrimPolygon(ps, metal);
+		double outline[] = {0,0, 4,0, 4,1, 1,1, 1,4, 0,4};
+		for (int n=0;n<12;++n)
+			poly->AddCoord(outline[n]);
+		poly->SetNormDir(2);
+		poly->SetElevation(0.25);
+		csx.Update();
+		CSRectGrid* grid = csx.GetGrid();
+		CHECK(csx.GenerateMesh(max_res, 1.5, 0.3), "polygon: mesh generation failed");
+		// metal left of x=1 and below y=1
+		CHECK(has_line(grid, 0, 0.9) && has_line(grid, 0, 1.2), "polygon: no thirds rule at the inner x edge");
+		CHECK(has_line(grid, 1, 0.9) && has_line(grid, 1, 1.2), "polygon: no thirds rule at the inner y edge");
+		CHECK(has_line(grid, 0, 3.9) && has_line(grid, 0, 4.2), "polygon: no thirds rule at the outer x edge");
+		CHECK(has_line(grid, 2, 0.25), "polygon: no line at the elevation");
+	}
+
+	// an extruded polygon, vertex and elevation lines
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMaterial* mat = new CSPropMaterial(ps);
+		csx.AddProperty(mat);
+		CSPrimLinPoly* linpoly = new CSPrimLinPoly(ps, mat);
+		double outline[] = {-2,-1, 3,-1, 0.5,2.5};
+		for (int n=0;n<6;++n)
+			linpoly->AddCoord(outline[n]);
+		linpoly->SetNormDir(1);
+		linpoly->SetElevation(-3.0);
+		linpoly->SetLength(2.0);
+		csx.Update();
+		CSRectGrid* grid = csx.GetGrid();
+		CHECK(csx.GenerateMesh(max_res), "linpoly: mesh generation failed");
+		// normal direction y, the outline is in z (first) and x (second)
+		CHECK(has_line(grid, 2, -2) && has_line(grid, 2, 3) && has_line(grid, 2, 0.5), "linpoly: missing vertex lines in z");
+		CHECK(has_line(grid, 0, -1) && has_line(grid, 0, 2.5), "linpoly: missing vertex lines in x");
+		CHECK(has_line(grid, 1, -3) && has_line(grid, 1, -1), "linpoly: missing elevation lines");
+	}
+
+	// transformed boxes, a translation and a rotation by 90deg keep their faces on mesh planes, any other rotation does not
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMaterial* mat = new CSPropMaterial(ps);
+		csx.AddProperty(mat);
+		double box[6] = {0, 1, 0, 2, 0, 3};
+		double shift[3] = {10, 20, 30};
+		add_box(ps, mat, box)->GetTransform()->Translate(shift);
+		add_box(ps, mat, box)->GetTransform()->RotateZ(M_PI/2);
+		add_box(ps, mat, box)->GetTransform()->RotateZ(0.3);
+		csx.Update();
+		CSRectGrid* grid = csx.GetGrid();
+		double no_smooth[3] = {0, 0, 0};
+		CHECK(csx.GenerateMesh(no_smooth), "transform: mesh generation failed");
+		CHECK(has_line(grid, 0, 10) && has_line(grid, 0, 11) && has_line(grid, 1, 20) && has_line(grid, 1, 22) && has_line(grid, 2, 33), "transform: translated box not meshed");
+		CHECK(has_line(grid, 0, -2) && has_line(grid, 1, 1), "transform: rotated box not meshed");
+		// translated box 2+2, rotated box 2+2, unmeshed rotated box 0 lines in x and y, two boxes in z share 0 and 3
+		CHECK(grid->GetQtyLines(0)==4 && grid->GetQtyLines(1)==4 && grid->GetQtyLines(2)==4, "transform: unexpected number of lines "
+			  << grid->GetQtyLines(0) << " " << grid->GetQtyLines(1) << " " << grid->GetQtyLines(2));
+	}
+
+	// lines already in the grid are kept exactly, close lines are merged
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMaterial* mat = new CSPropMaterial(ps);
+		csx.AddProperty(mat);
+		double box[6] = {0, 1, 0, 1, 0, 1};
+		add_box(ps, mat, box);
+		csx.Update();
+		CSRectGrid* grid = csx.GetGrid();
+		grid->AddDiscLine(0, -5);
+		grid->AddDiscLine(0, 1+1e-9);
+		CHECK(csx.GenerateMesh(max_res), "grid lines: mesh generation failed");
+		CHECK(has_line(grid, 0, -5) && grid->GetLine(0, grid->GetQtyLines(0)-1)==1+1e-9, "grid lines: existing lines not kept");
+		CHECK(max_cell(grid, 0)<=max_res[0]*(1+1e-10), "grid lines: cell too large");
+	}
+
+	// the thread count must not change the result
+	{
+		std::vector<double> result[2][3];
+		for (int run=0;run<2;++run)
+		{
+			ContinuousStructure csx;
+			ParameterSet* ps = csx.GetParameterSet();
+			CSPropMetal* metal = new CSPropMetal(ps);
+			CSPropMaterial* mat = new CSPropMaterial(ps);
+			csx.AddProperty(metal);
+			csx.AddProperty(mat);
+			for (int n=0;n<50;++n)
+			{
+				double box[6] = {0.37*n, 0.37*n+1.1, -0.21*n, 0.5, 0.13*n, 0.13*n+(n%3==0 ? 0 : 0.7)};
+				add_box(ps, (n%2) ? (CSProperties*)metal : (CSProperties*)mat, box);
+			}
+			csx.Update();
+			CHECK(csx.GenerateMesh(max_res, 1.4, 0.1, CSProperties::ANY, 1e-6, run==0 ? 1 : 4), "threads: mesh generation failed");
+			for (int d=0;d<3;++d)
+				for (size_t n=0;n<csx.GetGrid()->GetQtyLines(d);++n)
+					result[run][d].push_back(csx.GetGrid()->GetLine(d,n));
+		}
+		for (int d=0;d<3;++d)
+			CHECK(result[0][d]==result[1][d], "threads: result differs in direction " << d);
+	}
+
+	// bounding box edges, all directions at once or one by one
+	{
+		std::vector<double> result[2][3];
+		for (int run=0;run<2;++run)
+		{
+			ContinuousStructure csx;
+			ParameterSet* ps = csx.GetParameterSet();
+			CSPropMaterial* mat = new CSPropMaterial(ps);
+			CSPropMetal* metal = new CSPropMetal(ps);
+			csx.AddProperty(mat);
+			csx.AddProperty(metal);
+			std::vector<double> ref[3];
+			for (int n=0;n<40;++n)
+			{
+				double box[6] = {0.3*n, 0.3*n+2, -0.7*n, 1.5, (n%5)*1.0, (n%5)*1.0+0.5};
+				add_box(ps, (n%2) ? (CSProperties*)metal : (CSProperties*)mat, box);
+				for (int d=0;d<6;++d)
+					ref[d/2].push_back(box[d]);
+			}
+			CSRectGrid* grid = csx.GetGrid();
+			// unsorted lines already in the grid
+			double lines[4] = {5.55, -3, 100, 0.3};
+			for (int d=0;d<3;++d)
+				for (int i=0;i<4;++i)
+				{
+					grid->AddDiscLine(d, lines[i]);
+					ref[d].push_back(lines[i]);
+				}
+			csx.Update();
+			if (run==0)
+				CHECK(csx.InsertEdges2Grid(), "edges: insertion failed");
+			else
+				for (int d=0;d<3;++d)
+					CHECK(csx.InsertEdges2Grid(d), "edges: insertion failed in direction " << d);
+			CHECK(!csx.InsertEdges2Grid(3), "edges: insertion in an invalid direction");
+			for (int d=0;d<3;++d)
+			{
+				std::sort(ref[d].begin(), ref[d].end());
+				ref[d].erase(std::unique(ref[d].begin(), ref[d].end()), ref[d].end());
+				for (size_t n=0;n<grid->GetQtyLines(d);++n)
+					result[run][d].push_back(grid->GetLine(d,n));
+				CHECK(result[run][d]==ref[d], "edges: lines differ from the reference in direction " << d << ", run " << run);
+			}
+		}
+	}
+
+	// a primitive modified after the update has to be inserted with its current box
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMaterial* mat = new CSPropMaterial(ps);
+		csx.AddProperty(mat);
+		double box[6] = {0, 1, 0, 1, 0, 1};
+		CSPrimBox* prim = add_box(ps, mat, box);
+		csx.Update();
+		prim->SetCoord(1, 4.0);
+		csx.InsertEdges2Grid(0);
+		CHECK(csx.GetGrid()->GetQtyLines(0)==2 && csx.GetGrid()->GetLine(0,1)==4.0, "edges: modified primitive");
+	}
+
+	// nothing to mesh
+	{
+		ContinuousStructure csx;
+		CHECK(!csx.GenerateMesh(max_res), "empty structure: mesh generation succeeded");
+	}
+
+	std::cout << (fails ? "FAILED" : "all mesh generation tests passed") << std::endl;
+	return fails != 0;
+}
@@ -0,0 +1,315 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Tests for the interpolation of sampled modes.
+
+  Mode files with uniform and non-uniform axes are written to the working
+  directory and interpolated at points inside, on and outside of the grid. All
+  interpolations have to agree with a plain bilinear interpolation, whichever
+  way the interval of a point is found. The resampling onto a plane of grid
+  lines, also of a mode weighted excitation, has to agree with the
+  interpolation per point up to round-off. Mode files are loaded once and
+  shared by all users, a modified file has to be loaded again.
+
+  Build with -DCSXCAD_BUILD_TESTS=ON and run it through ctest.
+  Exits non-zero and prints "FAIL: ..." per failed check.
+*/
+
+#include "CSModeData.h"
+#include "ContinuousStructure.h"
+#include "CSPropExcitation.h"
+#include "CSFileCache.h"
+
+#include <hdf5.h>
+#include <hdf5_hl.h>
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <math.h>
+
+static int fails = 0;
+#define CHECK(cond, msg) do { if (!(cond)) { std::cout << "FAIL: " << msg << "\n"; ++fails; } } while (0)
+
+//! The sampled mode, Vx = x*y+2*x and Vy = sin(x)*y on the given axes
+static bool write_mode(const char* fn, const std::vector<double>& x, const std::vector<double>& y)
+{
+	hid_t fid = H5Fcreate(fn, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+	if (fid<0)
+		return false;
+	std::vector<double> vx, vy;
+	for (size_t i=0;i<x.size();++i)
+		for (size_t j=0;j<y.size();++j)
+		{
+			vx.push_back(x[i]*y[j]+2*x[i]);
+			vy.push_back(sin(x[i])*y[j]);
+		}
+	hsize_t nx = x.size(), ny = y.size();
+	hsize_t dims[2] = {nx, ny};
+	double version = 1.0;
+	bool ok = H5LTmake_dataset_double(fid, "x", 1, &nx, &x[0])>=0;
+	ok &= H5LTmake_dataset_double(fid, "y", 1, &ny, &y[0])>=0;
+	ok &= H5LTmake_dataset_double(fid, "Vx", 2, dims, &vx[0])>=0;
+	ok &= H5LTmake_dataset_double(fid, "Vy", 2, dims, &vy[0])>=0;
+	ok &= H5LTset_attribute_double(fid, "/", "Version", &version, 1)>=0;
+	H5Fclose(fid);
+	return ok;
+}
+
+//! plain bilinear interpolation with a search for the interval
+static void reference(const std::vector<double>& x, const std::vector<double>& y, double px, double py, double* v)
+{
+	px = std::max(x.front(), std::min(x.back(), px));
+	py = std::max(y.front(), std::min(y.back(), py));
+	size_t i = std::lower_bound(x.begin(),x.end(),px)-x.begin();
+	size_t j = std::lower_bound(y.begin(),y.end(),py)-y.begin();
+	i = std::min(i>0 ? i-1 : 0, x.size()-2);
+	j = std::min(j>0 ? j-1 : 0, y.size()-2);
+	double tx = (px-x[i])/(x[i+1]-x[i]);
+	double ty = (py-y[j])/(y[j+1]-y[j]);
+	double f[2][2][2];
+	for (int a=0;a<2;++a)
+		for (int b=0;b<2;++b)
+		{
+			f[0][a][b] = x[i+a]*y[j+b]+2*x[i+a];
+			f[1][a][b] = sin(x[i+a])*y[j+b];
+		}
+	for (int c=0;c<2;++c)
+		v[c] = (1-tx)*(1-ty)*f[c][0][0] + tx*(1-ty)*f[c][1][0] + (1-tx)*ty*f[c][0][1] + tx*ty*f[c][1][1];
+}
+
+static bool near(double a, double b)
+{
+	return fabs(a-b)<=1e-12*(1+fabs(a)+fabs(b));
+}
+
+static void compare(const char* name, const std::vector<double>& x, const std::vector<double>& y, bool uniformX, bool uniformY)
+{
+	const char* fn = "test_mode_data.h5";
+	CHECK(write_mode(fn, x, y), name << ": could not write " << fn);
+	CSModeData mode;
+	CHECK(mode.ReadFromHDF5(fn), name << ": could not read " << fn);
+	remove(fn);
+	if (!mode.IsLoaded())
+		return;
+	CHECK(mode.IsUniformX()==uniformX, name << ": uniform x-axis");
+	CHECK(mode.IsUniformY()==uniformY, name << ": uniform y-axis");
+
+	// points along grid lines in both directions, beyond the grid and exactly on all grid points
+	std::vector<double> px, py;
+	for (int l=0;l<7;++l)
+		for (int n=0;n<200;++n)
+		{
+			double s = x.front()-0.5 + (x.back()-x.front()+1)*n/199.0;
+			double t = y.front()-0.5 + (y.back()-y.front()+1)*l/6.0;
+			px.push_back(s); py.push_back(t);
+			px.push_back(x.front()+(x.back()-x.front())*l/6.0); py.push_back(y.back()+0.5-(y.back()-y.front()+1)*n/199.0);
+		}
+	for (size_t i=0;i<x.size();++i)
+		for (size_t j=0;j<y.size();++j)
+		{
+			px.push_back(x[i]); py.push_back(y[j]);
+		}
+
+	std::vector<double> vx(px.size()), vy(px.size());
+	mode.LinInterp2(px.size(), &px[0], &py[0], &vx[0], &vy[0]);
+	size_t mismatch = 0, batch_mismatch = 0;
+	for (size_t n=0;n<px.size();++n)
+	{
+		double ref[2];
+		reference(x, y, px[n], py[n], ref);
+		std::array<double,2> v = mode.LinInterp2(px[n], py[n]);
+		mismatch += !near(v[0],ref[0]) || !near(v[1],ref[1]);
+		batch_mismatch += (v[0]!=vx[n]) || (v[1]!=vy[n]);
+	}
+	CHECK(mismatch==0, name << ": " << mismatch << " interpolations differ from the reference");
+	CHECK(batch_mismatch==0, name << ": " << batch_mismatch << " interpolations along lines differ from the single interpolation");
+
+	// a plane of unsorted lines, partly outside of the grid
+	std::vector<double> lx, ly;
+	for (int n=0;n<37;++n)
+		lx.push_back(x.front()-0.3 + (x.back()-x.front()+0.6)*((n*7)%37)/36.0);
+	for (int n=0;n<23;++n)
+		ly.push_back(y.front()-0.3 + (y.back()-y.front()+0.6)*n/22.0);
+	mode.Resample(lx, ly, vx, vy);
+	CHECK(vx.size()==lx.size()*ly.size() && vy.size()==vx.size(), name << ": resampled size");
+	size_t resample_mismatch = 0;
+	for (size_t i=0;i<lx.size();++i)
+		for (size_t j=0;j<ly.size();++j)
+		{
+			std::array<double,2> v = mode.LinInterp2(lx[i], ly[j]);
+			resample_mismatch += !near(v[0],vx[i*ly.size()+j]) || !near(v[1],vy[i*ly.size()+j]);
+		}
+	CHECK(resample_mismatch==0, name << ": " << resample_mismatch << " resampled values differ from the interpolation");
+}
+
+//! The excitation on a plane has to agree with the excitation per point
+static void compare_plane(CSPropExcitation* exc, const char* name, int normDir, double normPos)
+{
+	std::vector<double> lines1, lines2, values;
+	for (int n=0;n<31;++n)
+		lines1.push_back(-2.5+0.17*n);
+	for (int n=0;n<19;++n)
+		lines2.push_back(0.5+0.3*n);
+	size_t mismatch = 0;
+	for (int ny=0;ny<3;++ny)
+	{
+		exc->GetWeightedExcitationPlane(ny, normDir, normPos, lines1, lines2, values);
+		CHECK(values.size()==lines1.size()*lines2.size(), name << ": plane size");
+		for (size_t i=0;i<lines1.size();++i)
+			for (size_t j=0;j<lines2.size();++j)
+			{
+				double coord[3];
+				coord[normDir] = normPos;
+				coord[(normDir+1)%3] = lines1[i];
+				coord[(normDir+2)%3] = lines2[j];
+				mismatch += !near(values[i*lines2.size()+j], exc->GetWeightedExcitation(ny, coord));
+			}
+	}
+	CHECK(mismatch==0, name << ": " << mismatch << " excitations on the plane differ from the single excitation");
+}
+
+int main()
+{
+	std::vector<double> ux, uy, nx, ny;
+	for (int n=0;n<41;++n)
+		ux.push_back(-2+0.1*n);
+	for (int n=0;n<13;++n)
+		uy.push_back(1+0.25*n);
+	for (int n=0;n<30;++n)
+		nx.push_back(-1+0.01*n*n);
+	for (int n=0;n<17;++n)
+		ny.push_back(exp(0.2*n));
+
+	compare("uniform", ux, uy, true, true);
+	compare("non-uniform", nx, ny, false, false);
+	compare("mixed", ux, ny, true, false);
+	compare("two points", std::vector<double>(ux.begin(),ux.begin()+2), std::vector<double>(nx.begin(),nx.begin()+2), true, true);
+
+	// a file is loaded once while it is in use, and again once modified
+	{
+		const char* fn = "test_mode_data_cache.h5";
+		CHECK(write_mode(fn, ux, uy), "could not write " << fn);
+		int loads = 0;
+		auto load = [&loads](const std::string&, std::vector<double>& data) {++loads; data.assign(3,1.0); return true;};
+		std::shared_ptr<const std::vector<double> > first = CSFileCache::Load<std::vector<double> >(fn, load);
+		std::shared_ptr<const std::vector<double> > second = CSFileCache::Load<std::vector<double> >(fn, load);
+		CHECK(first && (first==second) && (loads==1), "cached file loaded " << loads << " times");
+		first.reset(); second.reset();
+		first = CSFileCache::Load<std::vector<double> >(fn, load);
+		CHECK(loads==2, "released file not loaded again");
+		CHECK(!CSFileCache::Load<std::vector<double> >("test_mode_data_missing.h5", [](const std::string&, std::vector<double>&) {return false;}), "missing file loaded");
+
+		CSModeData a, b;
+		CHECK(a.ReadFromHDF5(fn) && b.ReadFromHDF5(fn), "could not read " << fn);
+		CHECK(write_mode(fn, nx, ny), "could not rewrite " << fn);
+		CSModeData c;
+		CHECK(c.ReadFromHDF5(fn), "could not read the modified " << fn);
+		remove(fn);
+		double ref_u[2], ref_n[2];
+		reference(ux, uy, -0.33, 2.1, ref_u);
+		reference(nx, ny, -0.33, 2.1, ref_n);
+		std::array<double,2> va = a.LinInterp2(-0.33, 2.1), vb = b.LinInterp2(-0.33, 2.1), vc = c.LinInterp2(-0.33, 2.1);
+		CHECK(near(va[0],ref_u[0]) && near(vb[1],ref_u[1]), "shared mode data");
+		CHECK(near(vc[0],ref_n[0]) && near(vc[1],ref_n[1]) && !c.IsUniformX(), "modified mode file not loaded again");
+	}
+
+	// a slow load blocks only the users of the same file
+	{
+		const char* fn = "test_mode_data_slow.h5";
+		CHECK(write_mode(fn, ux, uy), "could not write " << fn);
+		std::atomic<int> slow_loads(0);
+		std::atomic<bool> other_loaded(false), seen(false);
+		auto slow = [&](const std::string&, std::vector<double>& data)
+		{
+			++slow_loads;
+			// wait for the load of the other variant, at most a few seconds
+			for (int n=0;(n<500) && (other_loaded==false);++n)
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			seen = other_loaded.load();
+			data.assign(5,2.0);
+			return true;
+		};
+		std::shared_ptr<const std::vector<double> > first, second;
+		std::thread loader([&]() {first = CSFileCache::Load<std::vector<double> >(fn, slow, "slow");});
+		while (slow_loads==0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		std::thread waiter([&]() {second = CSFileCache::Load<std::vector<double> >(fn, slow, "slow");});
+		std::shared_ptr<const std::vector<double> > other = CSFileCache::Load<std::vector<double> >(fn, [](const std::string&, std::vector<double>& data) {data.assign(1,3.0); return true;}, "other");
+		other_loaded = true;
+		loader.join();
+		waiter.join();
+		remove(fn);
+		CHECK(other && (other->size()==1), "other variant not loaded");
+		CHECK(seen, "other variant waited for the slow load");
+		CHECK(first && (first==second) && (slow_loads==1), "slow variant loaded " << slow_loads << " times");
+	}
+
+#if !defined(_WIN32)
+	// a file rewritten with the same size within a second is noticed
+	{
+		const char* fn = "test_mode_data_key.txt";
+		std::string key, last;
+		int unchanged = 0;
+		for (int n=0;n<5;++n)
+		{
+			FILE* fp = fopen(fn, "w");
+			CHECK(fp!=NULL, "could not write " << fn);
+			fprintf(fp, "%d\n", n);
+			fclose(fp);
+			CHECK(CSFileCache::GetFileKey(fn, key), "no key of " << fn);
+			if (key==last)
+				++unchanged;
+			last = key;
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		}
+		remove(fn);
+		CHECK(unchanged==0, "file key unchanged by " << unchanged << " rewrites");
+	}
+#endif
+
+	// a mode weighted excitation, propagating in z, and a weighting function
+	{
+		const char* fn = "test_mode_data_exc.h5";
+		CHECK(write_mode(fn, nx, uy), "could not write " << fn);
+		ContinuousStructure csx;
+		CSPropExcitation* exc = new CSPropExcitation(csx.GetParameterSet());
+		csx.AddProperty(exc);
+		exc->SetExcitation(2.0,0);
+		exc->SetExcitation(-0.5,1);
+		exc->SetExcitation(1.0,2);
+		exc->SetPropagationDir(1.0,2);
+		exc->SetWeightFile(fn);
+		exc->SetWeightOrigin(0.2,0.1,3);
+		CHECK(exc->Update(), "excitation update");
+		compare_plane(exc, "mode plane", 2, 1.5);
+		compare_plane(exc, "mode, other plane", 0, 0.1);
+		remove(fn);
+
+		exc->SetWeightFunction("x*y-z", 0);
+		exc->SetWeightFunction("rho", 1);
+		compare_plane(exc, "weighting function", 1, -0.5);
+	}
+
+	std::cout << (fails ? "FAILED" : "all mode data tests passed") << std::endl;
+	return fails != 0;
+}
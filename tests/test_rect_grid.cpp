@@ -0,0 +1,324 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Tests for the rectilinear grid of CSXCAD.
+
+  Snapping values to grid lines has to return exactly what the plain scan over
+  all line pairs returns, including values outside the grid, on the lines and
+  exactly in the middle between two lines. The batch snapping has to agree with
+  the single snapping for ascending, descending and unordered values.
+
+  The mesh smoothing has to keep all fixed lines exactly, stay below the max.
+  resolution and keep a symmetric mesh symmetric.
+
+  The mesh analysis has to find the same figures as a plain scan over all
+  cells, for sorted and unsorted lines.
+
+  Build with -DCSXCAD_BUILD_TESTS=ON and run it through ctest.
+  Exits non-zero and prints "FAIL: ..." per failed check.
+*/
+
+#include "CSRectGrid.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+static int fails = 0;
+#define CHECK(cond, msg) do { if (!(cond)) { std::cout << "FAIL: " << msg << "\n"; ++fails; } } while (0)
+
+//! the nearest line by a scan over all line pairs
+static unsigned int reference(const std::vector<double>& lines, double value, bool &inside)
+{
+	inside = false;
+	if (value<lines.front())
+		return 0;
+	if (value>lines.back())
+		return lines.size()-1;
+	inside = true;
+	for (size_t n=0;n<lines.size()-1;++n)
+		if (value < 0.5*(lines[n]+lines[n+1]))
+			return n;
+	return lines.size()-1;
+}
+
+static void compare(const char* name, const std::vector<double>& lines)
+{
+	CSRectGrid grid;
+	for (size_t n=0;n<lines.size();++n)
+		grid.AddDiscLine(1, lines[n]);
+	grid.Sort(1);
+
+	// values on the lines, in the middle between them, in between and outside
+	std::vector<double> values;
+	for (size_t n=0;n<lines.size();++n)
+	{
+		values.push_back(lines[n]);
+		if (n+1<lines.size())
+		{
+			values.push_back(0.5*(lines[n]+lines[n+1]));
+			values.push_back(lines[n]+0.3*(lines[n+1]-lines[n]));
+			values.push_back(lines[n]+0.7*(lines[n+1]-lines[n]));
+		}
+	}
+	values.push_back(lines.front()-1);
+	values.push_back(lines.back()+1);
+
+	int mismatch = 0;
+	std::vector<unsigned int> ref(values.size());
+	std::vector<char> ref_in(values.size());
+	for (size_t n=0;n<values.size();++n)
+	{
+		bool in, in_ref;
+		ref[n] = reference(lines, values[n], in_ref);
+		ref_in[n] = in_ref;
+		unsigned int l = grid.Snap2LineNumber(1, values[n], in);
+		if ((l!=ref[n]) || (in!=in_ref))
+			++mismatch;
+	}
+	CHECK(mismatch==0, name << ": " << mismatch << " snapped values differ from the reference");
+
+	// batch snapping, in the order above, sorted ascending and descending
+	std::vector<size_t> order(values.size());
+	for (size_t n=0;n<order.size();++n)
+		order[n] = n;
+	for (int run=0;run<3;++run)
+	{
+		if (run==1)
+			std::sort(order.begin(), order.end(), [&values](size_t a, size_t b) {return values[a]<values[b];});
+		if (run==2)
+			std::reverse(order.begin(), order.end());
+		std::vector<double> vals;
+		for (size_t n=0;n<order.size();++n)
+			vals.push_back(values[order[n]]);
+		std::vector<unsigned int> res(vals.size());
+		bool* in = new bool[vals.size()];
+		CHECK(grid.Snap2LineNumbers(1, &vals[0], vals.size(), &res[0], in), name << ": batch snapping failed");
+		mismatch = 0;
+		for (size_t n=0;n<vals.size();++n)
+			if ((res[n]!=ref[order[n]]) || (in[n]!=(bool)ref_in[order[n]]))
+				++mismatch;
+		delete[] in;
+		CHECK(mismatch==0, name << ": " << mismatch << " batch snapped values differ from the reference, run " << run);
+	}
+}
+
+//! check the smoothed lines against the fixed lines
+static void check_smooth(const char* name, const std::vector<double>& fixed, const std::vector<double>& lines, double max_res)
+{
+	CHECK(lines.size()>=2, name << ": too few lines");
+	if (lines.size()<2)
+		return;
+	int too_large = 0, unsorted = 0, missing = 0;
+	for (size_t n=1;n<lines.size();++n)
+	{
+		if (lines[n]-lines[n-1]>max_res*(1+1e-10))
+			++too_large;
+		if (lines[n]<=lines[n-1])
+			++unsorted;
+	}
+	for (size_t n=0;n<fixed.size();++n)
+		if (!std::binary_search(lines.begin(), lines.end(), fixed[n]))
+			++missing;
+	CHECK(too_large==0, name << ": " << too_large << " cells larger than " << max_res);
+	CHECK(unsorted==0, name << ": " << unsorted << " lines not sorted or duplicate");
+	CHECK(missing==0, name << ": " << missing << " fixed lines missing");
+}
+
+static bool is_symmetric(const std::vector<double>& lines)
+{
+	double center = 0.5*(lines.front()+lines.back());
+	for (size_t n=0;n<lines.size()/2;++n)
+		if (fabs((center-lines[n])-(lines[lines.size()-n-1]-center))>1e-6)
+			return false;
+	return true;
+}
+
+int main()
+{
+	std::vector<double> uniform, graded, single;
+	for (int n=0;n<101;++n)
+		uniform.push_back(-5+0.1*n);
+	for (int n=0;n<2000;++n)
+		graded.push_back(0.5*n + 1e-3*n*n);
+	single.push_back(0.25);
+
+	compare("uniform", uniform);
+	compare("graded", graded);
+	compare("two lines", std::vector<double>(uniform.begin(),uniform.begin()+2));
+	compare("single line", single);
+
+	// a bounding box snapped in all directions at once
+	{
+		CSRectGrid grid;
+		for (int n=0;n<3;++n)
+			grid.AddDiscLines(n, uniform.size(), &uniform[0]);
+		double box[6] = {-4.96, 0.33, -6, 0.04, 2.05, 7};
+		unsigned int lines[6];
+		bool inside[6];
+		CHECK(grid.SnapBox2LineNumbers(box, lines, inside), "box snapping failed");
+		for (int n=0;n<6;++n)
+		{
+			bool in;
+			unsigned int l = grid.Snap2LineNumber(n/2, box[n], in);
+			CHECK((lines[n]==l) && (inside[n]==in), "box snapping differs from single snapping at " << n);
+		}
+		CHECK(lines[2]==0 && !inside[2] && lines[5]==uniform.size()-1 && !inside[5], "box outside of the grid");
+
+		grid.ClearLines(2);
+		CHECK(!grid.SnapBox2LineNumbers(box, lines) && lines[4]==(unsigned int)-1, "box snapping without z-lines");
+		CHECK(lines[0]==grid.Snap2LineNumber(0, box[0], inside[0]), "box snapping without z-lines, x-direction");
+	}
+
+	// mesh smoothing
+	{
+		std::vector<double> lines = CSRectGrid::SmoothMeshLines(std::vector<double>{0, 10}, 2);
+		check_smooth("smooth two lines", {0, 10}, lines, 2);
+		CHECK(lines.size()>2, "smooth two lines: no lines added");
+
+		std::vector<double> fixed = {0, 10, 12, 20};
+		lines = CSRectGrid::SmoothMeshLines(fixed, 10);
+		CHECK(lines==fixed, "smooth lines already fine enough");
+
+		fixed = {100, 0, 5, 5, 3};
+		check_smooth("smooth unsorted", {0, 3, 5, 100}, CSRectGrid::SmoothMeshLines(fixed, 3), 3);
+
+		fixed = {-50, -10, 0, 10, 50};
+		CHECK(CSRectGrid::CheckSymmetry(fixed)==1, "odd symmetric lines");
+		lines = CSRectGrid::SmoothMeshLines(fixed, 5);
+		check_smooth("smooth symmetric", fixed, lines, 5);
+		CHECK(is_symmetric(lines), "smooth symmetric: result not symmetric");
+
+		// a symmetric domain must keep its fixed lines exactly, not mirrored through the center
+		fixed = {-75, 0, 0.381, 0.762, 1.143, 1.524, 76.524};
+		CHECK(CSRectGrid::CheckSymmetry(fixed)==1, "symmetric domain");
+		lines = CSRectGrid::SmoothMeshLines(fixed, 4.99654097, 1.4);
+		check_smooth("smooth symmetric domain", fixed, lines, 4.99654097);
+		std::vector<double> full = CSRectGrid::SmoothMeshLines(fixed, 4.99654097, 1.4, false);
+		check_smooth("smooth without symmetry check", fixed, full, 4.99654097);
+		CHECK(full!=lines, "symmetry check not disabled");
+
+		std::vector<double> even = {-75, 0, 1.524, 76.524};
+		CHECK(CSRectGrid::CheckSymmetry(even)==2, "even symmetric lines");
+		lines = CSRectGrid::SmoothMeshLines(even, 4.99654097, 1.4);
+		check_smooth("smooth even symmetric", even, lines, 4.99654097);
+		CHECK(is_symmetric(lines), "smooth even symmetric: result not symmetric");
+
+		// no neighbors, the mesh has to be uniform
+		double ratios[4] = {1.1, 1.3, 1.5, 2.0};
+		for (int r=0;r<4;++r)
+		{
+			lines = CSRectGrid::SmoothMeshLines(std::vector<double>{0, 10}, 0.1, ratios[r]);
+			check_smooth("smooth uniform", {0, 10}, lines, 0.1);
+			bool uniform = true;
+			for (size_t n=1;n<lines.size();++n)
+				uniform &= fabs((lines[n]-lines[n-1])-(lines[1]-lines[0]))<1e-9*0.1;
+			CHECK(uniform && lines.size()==101, "smooth uniform: mesh not uniform for ratio " << ratios[r]);
+		}
+
+		// many fixed lines, graded in between
+		fixed.clear();
+		for (int n=0;n<5000;++n)
+			fixed.push_back(n*n*1e-2 + (n%7)*0.3);
+		std::sort(fixed.begin(), fixed.end());
+		lines = CSRectGrid::SmoothMeshLines(fixed, 1.0);
+		check_smooth("smooth many lines", fixed, lines, 1.0);
+
+		CHECK(CSRectGrid::SmoothMeshLines(std::vector<double>{0, 10}, 1, 1.0).size()==2, "smoothing with invalid ratio");
+		CHECK(CSRectGrid::SmoothRange(0, 10, 1, 1, 2, 0.9).empty(), "smooth range with invalid ratio");
+		CHECK(CSRectGrid::SmoothRange(0, 10, 1, 0, 2, 1.5).empty(), "smooth range with invalid stop resolution");
+		CHECK(CSRectGrid::SmoothRange(0, 10, -1, 1, 2, 1.5).empty(), "smooth range with invalid start resolution");
+		CHECK(CSRectGrid::SmoothRange(0, 10, 1, 1, 0, 1.5).empty(), "smooth range with invalid max. resolution");
+
+		CSRectGrid grid;
+		double l[2] = {0, 10};
+		for (int n=0;n<3;++n)
+			grid.AddDiscLines(n, 2, l);
+		CHECK(grid.SmoothMeshLines(0, 2) && grid.GetQtyLines(0)>2, "smooth grid lines");
+		CHECK(grid.GetQtyLines(1)==2 && grid.GetQtyLines(2)==2, "smoothing changed other directions");
+		CHECK(!grid.SmoothMeshLines(3, 2) && !grid.SmoothMeshLines(1, 0), "smoothing with invalid arguments");
+	}
+
+	// mesh analysis
+	{
+		CSRectGrid::MeshQuality q;
+		CHECK(!CSRectGrid::AnalyseMesh(single, q) && q.numLines==1, "analysis of a single line");
+
+		CHECK(CSRectGrid::AnalyseMesh(uniform, q, 4), "analysis of a uniform mesh failed");
+		CHECK(q.numLines==101 && q.homogeneous && q.symmetric==1 && fabs(q.max_ratio-1)<1e-9, "analysis of a uniform mesh");
+		CHECK(q.res_hist.size()==4 && q.res_bins.size()==5 && q.res_hist[0]+q.res_hist[1]+q.res_hist[2]+q.res_hist[3]==100, "uniform mesh histogram");
+
+		// a jump in the middle of the graded mesh, a large cell with two large ratios, analysed unsorted and with a duplicate
+		std::vector<double> lines = graded;
+		lines.resize(100);
+		for (size_t n=60;n<lines.size();++n)
+			lines[n] += 7;
+		double min_res = 1e10, max_res = 0, max_ratio = 1;
+		size_t min_idx = 0, max_idx = 0, ratio_idx = 0;
+		for (size_t n=0;n+1<lines.size();++n)
+		{
+			double dl = lines[n+1]-lines[n];
+			if (dl<min_res) {min_res = dl; min_idx = n;}
+			if (dl>max_res) {max_res = dl; max_idx = n;}
+			if (n==0)
+				continue;
+			double prev = lines[n]-lines[n-1];
+			double r = std::max(dl/prev, prev/dl);
+			if (r>max_ratio) {max_ratio = r; ratio_idx = n;}
+		}
+		std::vector<double> shuffled(lines.rbegin(), lines.rend());
+		shuffled.push_back(lines[10]);
+		for (int run=0;run<2;++run)
+		{
+			CHECK(CSRectGrid::AnalyseMesh(run ? shuffled : lines, q, 8), "analysis of a graded mesh failed");
+			CHECK(q.numLines==100 && q.min_res==min_res && q.min_res_idx==min_idx && q.max_res==max_res && q.max_res_idx==max_idx, "graded mesh min/max, run " << run);
+			CHECK(q.max_ratio==max_ratio && q.max_ratio_idx==ratio_idx && ratio_idx==59, "graded mesh ratio, run " << run);
+			CHECK(!q.homogeneous && q.symmetric==0, "graded mesh homogeneous or symmetric, run " << run);
+			unsigned int cells = 0, ratios = 0;
+			for (size_t n=0;n<q.res_hist.size();++n)
+				cells += q.res_hist[n];
+			for (size_t n=0;n<q.ratio_hist.size();++n)
+				ratios += q.ratio_hist[n];
+			CHECK(cells==99 && ratios==98 && q.res_hist.back()>=1 && q.ratio_hist.back()==2, "graded mesh histograms, run " << run);
+			CHECK(q.res_bins.front()==min_res && q.res_bins.back()==max_res && q.ratio_bins.front()==1, "graded mesh histogram bins, run " << run);
+		}
+
+		// the time step of a uniform cube mesh of 1mm cells
+		CSRectGrid grid;
+		grid.SetDeltaUnit(1e-3);
+		CHECK(grid.GetCFLTimestep()==0, "time step of an empty grid");
+		for (int n=0;n<3;++n)
+			for (int i=0;i<11;++i)
+				grid.AddDiscLine(n, i*1.0);
+		double dt = 1e-3/(299792458.0*sqrt(3.0));
+		CHECK(fabs(grid.GetCFLTimestep()-dt)<1e-9*dt, "time step of a uniform grid");
+		CHECK(grid.AnalyseMesh(2, q) && !grid.AnalyseMesh(3, q), "analysis of a grid direction");
+		grid.AddDiscLine(0, 10.25);
+		dt = 1e-3/(299792458.0*sqrt(2.0+16.0));
+		CHECK(fabs(grid.GetCFLTimestep()-dt)<1e-9*dt, "time step of a graded grid");
+		// a two-dimensional grid
+		grid.ClearLines(2);
+		grid.AddDiscLine(2, 0);
+		dt = 1e-3/(299792458.0*sqrt(1.0+16.0));
+		CHECK(fabs(grid.GetCFLTimestep()-dt)<1e-9*dt, "time step of a 2D grid");
+	}
+
+	std::cout << (fails ? "FAILED" : "all rect grid tests passed") << std::endl;
+	return fails != 0;
+}
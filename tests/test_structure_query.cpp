@@ -0,0 +1,801 @@
+/*
+*	Copyright (C) 2026 Thorsten Liebig (Thorsten.Liebig@gmx.de)
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU Lesser General Public License as published
+*	by the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU Lesser General Public License for more details.
+*
+*	You should have received a copy of the GNU Lesser General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+  Tests for the coordinate queries of ContinuousStructure.
+
+  Every accelerated query has to return exactly what the brute force search
+  over all properties and primitives returns, including the tie breaking
+  between equal priorities. The structures used here are therefore built from
+  overlapping primitives of equal and different priorities, with and without
+  transformations, and every query is compared against the brute force result.
+
+  The cached object area has to follow every change of the primitives.
+  Update() has to update every primitive depending on a changed parameter or
+  modified since the last update, and only those.
+
+  Build with -DCSXCAD_BUILD_TESTS=ON and run it through ctest.
+  Exits non-zero and prints "FAIL: ..." per failed check.
+*/
+
+#include "ContinuousStructure.h"
+#include "CSPropMaterial.h"
+#include "CSPropMetal.h"
+#include "CSPrimBox.h"
+#include "CSPrimSphere.h"
+#include "CSPrimCylinder.h"
+#include "CSPrimSphericalShell.h"
+#include "CSPrimCylindricalShell.h"
+#include "CSPrimMultiBox.h"
+#include "CSPrimPolygon.h"
+#include "CSPrimLinPoly.h"
+#include "CSPrimRotPoly.h"
+#include "CSPrimPolyhedron.h"
+#include "CSPrimUserDefined.h"
+#include "CSTransform.h"
+#include "CSRectGrid.h"
+#include "CSStructureSnapshot.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+static int fails = 0;
+#define CHECK(cond, msg) do { if (!(cond)) { std::cout << "FAIL: " << msg << "\n"; ++fails; } } while (0)
+
+//! simple deterministic pseudo random numbers in [0,1), independent of the platform
+static double rnd()
+{
+	static unsigned int state = 12345;
+	state = state*1103515245u + 12345u;
+	return (double)((state>>8)&0xFFFF)/65536.0;
+}
+
+//! Fill the structure with overlapping boxes, spheres and cylinders in [-10,10]^3
+static void build(ContinuousStructure& csx, int nProps, int nPrims, bool transform)
+{
+	ParameterSet* ps = csx.GetParameterSet();
+	for (int p=0;p<nProps;++p)
+	{
+		CSProperties* prop;
+		if (p%3==0)
+			prop = new CSPropMetal(ps);
+		else
+			prop = new CSPropMaterial(ps);
+		csx.AddProperty(prop);
+		for (int n=0;n<nPrims;++n)
+		{
+			CSPrimitives* prim;
+			double c[3] = {20*rnd()-10, 20*rnd()-10, 20*rnd()-10};
+			switch (n%3)
+			{
+			case 0:
+			{
+				CSPrimBox* box = new CSPrimBox(ps, prop);
+				for (int d=0;d<3;++d)
+				{
+					box->SetCoord(2*d, c[d]-3*rnd());
+					box->SetCoord(2*d+1, c[d]+3*rnd());
+				}
+				prim = box;
+				break;
+			}
+			case 1:
+			{
+				CSPrimSphere* sphere = new CSPrimSphere(ps, prop);
+				sphere->SetCenter(c[0], c[1], c[2]);
+				sphere->SetRadius(0.5+2*rnd());
+				prim = sphere;
+				break;
+			}
+			default:
+			{
+				CSPrimCylinder* cyl = new CSPrimCylinder(ps, prop);
+				for (int d=0;d<3;++d)
+				{
+					cyl->SetCoord(2*d, c[d]);
+					cyl->SetCoord(2*d+1, c[d]+4*rnd()-2);
+				}
+				cyl->SetRadius(0.5+rnd());
+				prim = cyl;
+				break;
+			}
+			}
+			// few distinct priorities, to have many ties
+			prim->SetPriority((int)(4*rnd()));
+			if (transform && (n%4==1))
+			{
+				double shift[3] = {2*rnd()-1, 2*rnd()-1, 2*rnd()-1};
+				prim->GetTransform()->RotateZ(rnd()*3.0);
+				prim->GetTransform()->Translate(shift);
+			}
+		}
+	}
+	csx.Update();
+}
+
+//! Compare the cached object area against the union of all accurate primitive bounding boxes
+static void compare_area(ContinuousStructure& csx, const char* name, CSProperties::PropertyType type=CSProperties::ANY)
+{
+	double ref[6] = {0,0,0,0,0,0};
+	bool found = false;
+	std::vector<CSPrimitives*> prims = csx.GetAllPrimitives(false, type);
+	for (size_t i=0;i<prims.size();++i)
+	{
+		double box[6];
+		if (prims.at(i)->GetBoundBox(box)==false)
+			continue;
+		for (int n=0;n<3;++n)
+		{
+			ref[2*n] = found ? std::min(ref[2*n],box[2*n]) : box[2*n];
+			ref[2*n+1] = found ? std::max(ref[2*n+1],box[2*n+1]) : box[2*n+1];
+		}
+		found = true;
+	}
+	double* area = csx.GetObjectArea(type);
+	bool equal = true;
+	for (int n=0;n<6;++n)
+		equal &= (area[n]==ref[n]);
+	CHECK(equal, name << ": object area differs from the union of the bounding boxes");
+}
+
+//! Compare the query with and without bounding volume hierarchy at many coordinates
+static void compare(ContinuousStructure& csx, const char* name, CSProperties::PropertyType type, bool cylindrical)
+{
+	const int num = 4000;
+	std::vector<double> coords(3*num);
+	for (int n=0;n<num;++n)
+	{
+		if (cylindrical)
+		{
+			coords[3*n]   = 12*rnd();
+			coords[3*n+1] = 6.3*rnd()-3.15;
+			coords[3*n+2] = 24*rnd()-12;
+		}
+		else
+			for (int d=0;d<3;++d)
+				coords[3*n+d] = 24*rnd()-12;
+	}
+
+	std::vector<CSProperties*> prop_ref(num);
+	std::vector<CSPrimitives*> prim_ref(num);
+	csx.SetUseBoundingVolumeHierarchy(false);
+	int found = 0;
+	for (int n=0;n<num;++n)
+	{
+		prop_ref[n] = csx.GetPropertyByCoordPriority(&coords[3*n], type, false, &prim_ref[n]);
+		if (prim_ref[n])
+			++found;
+	}
+
+	csx.SetUseBoundingVolumeHierarchy(true);
+	int mismatch = 0;
+	for (int n=0;n<num;++n)
+	{
+		CSPrimitives* prim = NULL;
+		CSProperties* prop = csx.GetPropertyByCoordPriority(&coords[3*n], type, false, &prim);
+		if ((prop!=prop_ref[n]) || (prim!=prim_ref[n]))
+			++mismatch;
+	}
+
+	// batched queries, interleaved and as separate arrays, in parallel
+	std::vector<double> xyz[3];
+	for (int d=0;d<3;++d)
+		for (int n=0;n<num;++n)
+			xyz[d].push_back(coords[3*n+d]);
+	const double* const soa[3] = {&xyz[0][0], &xyz[1][0], &xyz[2][0]};
+	for (int bvh=0;bvh<2;++bvh)
+	{
+		csx.SetUseBoundingVolumeHierarchy(bvh==1);
+		std::vector<CSProperties*> props(num);
+		std::vector<CSPrimitives*> prims(num);
+		csx.GetPropertiesByCoordsPriority(num, &coords[0], &props[0], &prims[0], type, false, 4);
+		for (int n=0;n<num;++n)
+			if ((props[n]!=prop_ref[n]) || (prims[n]!=prim_ref[n]))
+				++mismatch;
+		csx.GetPropertiesByCoordsPriority(num, soa, &props[0], NULL, type, false, 3);
+		for (int n=0;n<num;++n)
+			if (props[n]!=prop_ref[n])
+				++mismatch;
+	}
+	csx.SetUseBoundingVolumeHierarchy(false);
+
+	std::ostringstream msg;
+	msg << name << ": " << mismatch << " mismatches";
+	CHECK(mismatch==0, msg.str());
+	// make sure the test is not trivially passing
+	CHECK(found>num/20, std::string(name) + ": too few coordinates inside any primitive");
+}
+
+//! Check the line intervals of a primitive against IsInside at all positions of random lines in all directions
+static void compare_intervals(CSPrimitives* prim, const char* name, bool cylindrical)
+{
+	std::vector<double> pos;
+	for (int n=0;n<=60;++n)
+		pos.push_back(-12+0.4*n);
+	std::vector<double> rpos;
+	for (int n=0;n<=60;++n)
+		rpos.push_back(0.2*n);
+
+	int mismatch = 0;
+	int found = 0;
+	int unsorted = 0;
+	int bisect_mismatch = 0;
+	double max_dev = 0;
+	std::vector<double> intervals, fallback;
+	for (int l=0;l<300;++l)
+	{
+		int ny = l%3;
+		if (cylindrical && (ny==1))
+			continue;
+		double coord[3] = {24*rnd()-12, 24*rnd()-12, 24*rnd()-12};
+		if (cylindrical)
+		{
+			coord[0] = 12*rnd();
+			coord[1] = 6.2*rnd()-3.1;
+		}
+		// some lines exactly on the primitive edges
+		if (l%5==0)
+			coord[(ny+1)%3] = floor(coord[(ny+1)%3]);
+		const std::vector<double> &p = (cylindrical && ny==0) ? rpos : pos;
+		prim->GetLineIntervals(ny, coord, &p[0], p.size(), intervals);
+		for (size_t n=1;n<intervals.size();++n)
+			if (intervals[n]<intervals[n-1])
+				++unsorted;
+		for (size_t k=0;k<p.size();++k)
+		{
+			coord[ny] = p[k];
+			bool ref = prim->IsInside(coord);
+			bool in = false;
+			for (size_t n=0;n+1<intervals.size();n+=2)
+				in |= (p[k]>=intervals[n]) && (p[k]<=intervals[n+1]);
+			if (ref!=in)
+				++mismatch;
+			if (ref)
+				++found;
+		}
+		// the generic bisection finds the same interval ends up to a fraction of the spacing,
+		// except for the ends outside of the positions, intervals without any position and gaps without any position
+		prim->CSPrimitives::GetLineIntervals(ny, coord, &p[0], p.size(), fallback);
+		std::vector<double> inner;
+		for (size_t n=0;n+1<intervals.size();n+=2)
+			if (std::lower_bound(p.begin(),p.end(),intervals[n])!=std::upper_bound(p.begin(),p.end(),intervals[n+1]))
+			{
+				if ((inner.size()>0) && (std::upper_bound(p.begin(),p.end(),inner.back())==std::lower_bound(p.begin(),p.end(),intervals[n])))
+					inner.pop_back();
+				else
+					inner.push_back(std::max(intervals[n],p.front()));
+				inner.push_back(std::min(intervals[n+1],p.back()));
+			}
+		if (fallback.size()==inner.size())
+		{
+			for (size_t n=0;n<inner.size();++n)
+				max_dev = std::max(max_dev, fabs(fallback[n]-inner[n]));
+		}
+		else
+			++bisect_mismatch;
+	}
+	std::ostringstream msg;
+	msg << name << ": " << mismatch << " interval mismatches, " << unsorted << " unsorted, " << bisect_mismatch << " bisection mismatches, max deviation " << max_dev;
+	CHECK((mismatch==0) && (unsorted==0) && (bisect_mismatch==0) && (max_dev<1e-3), msg.str());
+	CHECK(found>0, std::string(name) + ": line never inside");
+}
+
+//! Compare the property index volume of the grid with the single coordinate query at every sample
+static void compare_volume(ContinuousStructure& csx, const char* name, bool cellCenter)
+{
+	CSRectGrid* grid = csx.GetGrid();
+	std::vector<double> pos[3];
+	for (int n=0;n<3;++n)
+		pos[n] = grid->GetSamplePositions(n, cellCenter);
+
+	std::vector<int> volume;
+	CHECK(csx.GetPropertyIndexVolume(volume, cellCenter, CSProperties::ANY, false, 3), std::string(name) + ": volume failed");
+	CHECK(volume.size()==pos[0].size()*pos[1].size()*pos[2].size(), std::string(name) + ": wrong volume size");
+	if (volume.size()!=pos[0].size()*pos[1].size()*pos[2].size())
+		return;
+
+	int mismatch = 0;
+	int found = 0;
+	size_t idx = 0;
+	double coord[3];
+	for (size_t i=0;i<pos[0].size();++i)
+		for (size_t j=0;j<pos[1].size();++j)
+			for (size_t k=0;k<pos[2].size();++k, ++idx)
+			{
+				coord[0] = pos[0][i];
+				coord[1] = pos[1][j];
+				coord[2] = pos[2][k];
+				int ref = csx.GetIndex(csx.GetPropertyByCoordPriority(coord));
+				if (ref!=volume[idx])
+					++mismatch;
+				if (ref>=0)
+					++found;
+			}
+	std::ostringstream msg;
+	msg << name << ": " << mismatch << " volume mismatches";
+	CHECK(mismatch==0, msg.str());
+	CHECK(found>(int)volume.size()/20, std::string(name) + ": too few samples inside any primitive");
+}
+
+//! A grid with some lines on the primitive boundaries, and some more in between
+static void build_grid(ContinuousStructure& csx, bool cylindrical)
+{
+	CSRectGrid* grid = csx.GetGrid();
+	grid->clear();
+	for (int n=0;n<=40;++n)
+	{
+		if (cylindrical)
+		{
+			grid->AddDiscLine(0, 0.3*n);
+			grid->AddDiscLine(1, -3.1+6.2*n/40);
+		}
+		else
+		{
+			grid->AddDiscLine(0, -12+0.6*n);
+			grid->AddDiscLine(1, -12+0.6*n);
+		}
+		grid->AddDiscLine(2, -12+0.6*n);
+	}
+	csx.InsertEdges2Grid(2);
+}
+
+// a box counting its updates
+class CountingBox : public CSPrimBox
+{
+public:
+	CountingBox(ParameterSet* paraSet, CSProperties* prop) : CSPrimBox(paraSet, prop), updates(0) {}
+	virtual bool Update(std::string *ErrStr=NULL) {++updates; return CSPrimBox::Update(ErrStr);}
+	int updates;
+};
+
+static void check_updates(CountingBox* boxes[4], const int expected[4], const char* name)
+{
+	for (int n=0;n<4;++n)
+	{
+		if (boxes[n]->updates!=expected[n])
+			std::cout << "box " << n << ": " << boxes[n]->updates << " updates, expected " << expected[n] << "\n";
+		CHECK(boxes[n]->updates==expected[n], name);
+		boxes[n]->updates=0;
+	}
+}
+
+int main()
+{
+	// ---- 1. cartesian mesh, plain primitives
+	{
+		ContinuousStructure csx;
+		build(csx, 6, 30, false);
+		compare(csx, "cartesian", CSProperties::ANY, false);
+		compare(csx, "cartesian, metal only", CSProperties::METAL, false);
+
+		// primitives without a bounding box, tested for every query in order with the hits of the hierarchy
+		for (int n=0;n<4;++n)
+		{
+			CSPrimUserDefined* prim = new CSPrimUserDefined(csx.GetParameterSet(), csx.GetProperty(n));
+			std::ostringstream func;
+			func << "(x-" << 4*n-6 << ")*(x-" << 4*n-6 << ")+y*y+z*z<" << 10+5*n;
+			prim->SetFunction(func.str().c_str());
+			prim->SetPriority(n);
+		}
+		csx.Update();
+		compare(csx, "cartesian, unbounded primitives", CSProperties::ANY, false);
+	}
+
+	// ---- 2. cartesian mesh, transformed primitives
+	{
+		ContinuousStructure csx;
+		build(csx, 6, 30, true);
+		compare(csx, "transformed", CSProperties::ANY, false);
+	}
+
+	// ---- 3. cylindrical mesh
+	{
+		ContinuousStructure csx;
+		build(csx, 5, 30, true);
+		csx.SetCoordInputType(CYLINDRICAL);
+		compare(csx, "cylindrical", CSProperties::ANY, true);
+	}
+
+	// ---- 4. property index volume, nodes and cell centers
+	{
+		ContinuousStructure csx;
+		build(csx, 6, 30, true);
+		build_grid(csx, false);
+		compare_volume(csx, "volume", false);
+		compare_volume(csx, "volume, cell centers", true);
+	}
+	{
+		ContinuousStructure csx;
+		build(csx, 5, 30, true);
+		csx.SetCoordInputType(CYLINDRICAL);
+		build_grid(csx, true);
+		compare_volume(csx, "cylindrical volume", false);
+	}
+
+	// ---- 5. analytic line intervals
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		CSPropMaterial* mat = new CSPropMaterial(ps);
+		csx.AddProperty(mat);
+
+		CSPrimSphere* sphere = new CSPrimSphere(ps, mat);
+		sphere->SetCenter(1.0, -2.0, 0.5);
+		sphere->SetRadius(7.3);
+		CSPrimSphericalShell* sshell = new CSPrimSphericalShell(ps, mat);
+		sshell->SetCenter(-1.0, 0.5, 2.0);
+		sshell->SetRadius(6.1);
+		sshell->SetShellWidth(2.2);
+		CSPrimCylinder* cyl = new CSPrimCylinder(ps, mat);
+		CSPrimCylindricalShell* cshell = new CSPrimCylindricalShell(ps, mat);
+		double axis[6] = {-6.0, 5.0, 2.0, -1.0, -7.0, 8.0};
+		for (int n=0;n<6;++n)
+		{
+			cyl->SetCoord(n, axis[n]);
+			cshell->SetCoord(n, axis[5-n]);
+		}
+		cyl->SetRadius(3.3);
+		cshell->SetRadius(4.0);
+		cshell->SetShellWidth(1.5);
+		CSPrimCylinder* zcyl = new CSPrimCylinder(ps, mat);
+		double zaxis[6] = {1.0, 1.0, -2.0, -2.0, -8.0, 6.0};
+		for (int n=0;n<6;++n)
+			zcyl->SetCoord(n, zaxis[n]);
+		zcyl->SetRadius(5.0);
+		CSPrimMultiBox* mbox = new CSPrimMultiBox(ps, mat);
+		double boxes[18] = {-8,-2, -6,4, -5,5,  -3,6, 0,8, -1,1,  6,2, -9,-3, 3,7};
+		for (int n=0;n<18;++n)
+			mbox->AddCoord(boxes[n]);
+		CSPrimPolygon* poly = new CSPrimPolygon(ps, mat);
+		CSPrimLinPoly* linpoly = new CSPrimLinPoly(ps, mat);
+		CSPrimRotPoly* rotpoly = new CSPrimRotPoly(ps, mat);
+		// a self-intersecting outline, to test the nonzero winding rule
+		double outline[] = {-8,-8, 8,-6, 0,9, -4,-2, 6,2, -9,4};
+		for (int n=0;n<12;++n)
+		{
+			poly->AddCoord(outline[n]);
+			linpoly->AddCoord(outline[n]);
+		}
+		double half[] = {-8,1, 6,1, 4,7, 0,4, -5,9};
+		for (int n=0;n<10;++n)
+			rotpoly->AddCoord(half[n]);
+		poly->SetNormDir(2);
+		poly->SetElevation(1.0);
+		linpoly->SetNormDir(1);
+		linpoly->SetElevation(-3.0);
+		linpoly->SetLength(7.0);
+		rotpoly->SetNormDir(1);
+		rotpoly->SetRotAxisDir(0);
+		rotpoly->SetAngle(0, 0.5);
+		rotpoly->SetAngle(1, 4.0);
+		// an octahedron with outward oriented faces
+		CSPrimPolyhedron* polyhedron = new CSPrimPolyhedron(ps, mat);
+		double vertex[6][3] = {{7.8,-0.2,0.6}, {-7.2,-0.2,0.6}, {0.3,7.3,0.6}, {0.3,-7.7,0.6}, {0.3,-0.2,8.1}, {0.3,-0.2,-6.9}};
+		int faces[8][3] = {{0,2,4}, {2,1,4}, {1,3,4}, {3,0,4}, {2,0,5}, {1,2,5}, {3,1,5}, {0,3,5}};
+		for (int n=0;n<6;++n)
+			polyhedron->AddVertex(vertex[n]);
+		for (int n=0;n<8;++n)
+			polyhedron->AddFace(3, faces[n]);
+		csx.Update();
+
+		compare_intervals(sphere, "sphere intervals", false);
+		compare_intervals(sshell, "spherical shell intervals", false);
+		compare_intervals(cyl, "cylinder intervals", false);
+		compare_intervals(cshell, "cylindrical shell intervals", false);
+		compare_intervals(zcyl, "z-cylinder intervals", false);
+		compare_intervals(mbox, "multi box intervals", false);
+		compare_intervals(linpoly, "extruded polygon intervals", false);
+		compare_intervals(rotpoly, "rotated polygon intervals", false);
+		compare_intervals(polyhedron, "polyhedron intervals", false);
+
+		// the polygon plane is met only at lines in the plane
+		std::vector<double> pos;
+		for (int n=0;n<=60;++n)
+			pos.push_back(-12+0.4*n);
+		std::vector<double> intervals;
+		int mismatch = 0;
+		for (int l=0;l<200;++l)
+		{
+			double coord[3] = {24*rnd()-12, 24*rnd()-12, 1.0};
+			int ny = l%2;
+			poly->GetLineIntervals(ny, coord, &pos[0], pos.size(), intervals);
+			for (size_t k=0;k<pos.size();++k)
+			{
+				coord[ny] = pos[k];
+				bool in = false;
+				for (size_t n=0;n+1<intervals.size();n+=2)
+					in |= (pos[k]>=intervals[n]) && (pos[k]<=intervals[n+1]);
+				if (in!=poly->IsInside(coord))
+					++mismatch;
+			}
+		}
+		CHECK(mismatch==0, "polygon intervals in plane");
+
+		// transformed primitives and a cylindrical mesh
+		double shift[3] = {0.7, -1.1, 0.3};
+		sphere->GetTransform()->RotateZ(0.4);
+		sphere->GetTransform()->Translate(shift);
+		cyl->GetTransform()->RotateZ(-1.2);
+		cyl->GetTransform()->Translate(shift);
+		polyhedron->GetTransform()->RotateX(0.3);
+		polyhedron->GetTransform()->Translate(shift);
+		// an empty transformation does not prevent the analytic intervals
+		mbox->GetTransform();
+		linpoly->GetTransform();
+		rotpoly->GetTransform();
+		csx.Update();
+		compare_intervals(sphere, "transformed sphere intervals", false);
+		compare_intervals(cyl, "transformed cylinder intervals", false);
+		compare_intervals(polyhedron, "transformed polyhedron intervals", false);
+		compare_intervals(mbox, "multi box intervals, empty transformation", false);
+		compare_intervals(linpoly, "extruded polygon intervals, empty transformation", false);
+		compare_intervals(rotpoly, "rotated polygon intervals, empty transformation", false);
+		csx.SetCoordInputType(CYLINDRICAL);
+		compare_intervals(sshell, "cylindrical mesh, spherical shell intervals", true);
+		compare_intervals(cshell, "cylindrical mesh, cylindrical shell intervals", true);
+		compare_intervals(zcyl, "cylindrical mesh, z-cylinder intervals", true);
+		compare_intervals(mbox, "cylindrical mesh, multi box intervals", true);
+	}
+
+	// ---- 6. compiled snapshot, queried from several threads
+	{
+		ContinuousStructure csx;
+		build(csx, 6, 30, true);
+		CSPropMaterial* mat = csx.GetProperty(1)->ToMaterial();
+		mat->SetIsotropy(false);
+		mat->SetEpsilon(3.5);
+		mat->SetKappa(0.25, 2);
+		CSStructureSnapshot* snap = csx.Compile();
+		CHECK(snap->GetQtyProperties()==csx.GetQtyProperties(), "snapshot: wrong number of properties");
+		CHECK(snap->GetMaterialValues(0)==NULL, "snapshot: metal with material values");
+		const CSStructureSnapshot::MaterialValues* values = snap->GetMaterialValues(1);
+		CHECK(values && (values->epsilon[0]==3.5) && (values->kappa[2]==0.25), "snapshot: wrong material values");
+
+		const int num = 5000;
+		std::vector<double> coords(3*num);
+		for (int n=0;n<3*num;++n)
+			coords[n] = 24*rnd()-12;
+		std::vector<int> indices(num);
+		snap->GetPropertyIndicesByCoordsPriority(num, &coords[0], &indices[0], CSProperties::ANY, true, 4);
+
+		int mismatch = 0;
+		unsigned long found = 0;
+		for (int n=0;n<num;++n)
+		{
+			CSPrimitives* prim = NULL;
+			int ref = csx.GetIndex(csx.GetPropertyByCoordPriority(&coords[3*n], CSProperties::ANY, false, &prim));
+			if ((ref!=indices[n]) || (snap->GetPropertyIndexByCoordPriority(&coords[3*n])!=ref))
+				++mismatch;
+			if (ref>=0)
+				++found;
+		}
+		std::ostringstream msg;
+		msg << "snapshot: " << mismatch << " mismatches";
+		CHECK(mismatch==0, msg.str());
+
+		// all hits were counted, and only the counted primitives are marked as used
+		std::vector<CSPrimitives*> prims = csx.GetAllPrimitives();
+		unsigned long counted = 0;
+		for (size_t n=0;n<prims.size();++n)
+		{
+			prims[n]->SetPrimitiveUsed(false);
+			counted += snap->GetPrimitiveUsage(prims[n]);
+		}
+		CHECK(counted==found, "snapshot: wrong usage count");
+		snap->ApplyPrimitiveUsage();
+		int wrong_used = 0;
+		for (size_t n=0;n<prims.size();++n)
+			if (prims[n]->GetPrimitiveUsed() != (snap->GetPrimitiveUsage(prims[n])>0))
+				++wrong_used;
+		CHECK(wrong_used==0, "snapshot: wrong primitives marked as used");
+		snap->ResetPrimitiveUsage();
+		CHECK(snap->GetPrimitiveUsage(prims[0])==0, "snapshot: usage not reset");
+		delete snap;
+	}
+
+	// ---- 7. changes through the structure drop the hierarchy
+	{
+		ContinuousStructure csx;
+		csx.SetUseBoundingVolumeHierarchy(true);
+		CSPropMaterial* mat = new CSPropMaterial(csx.GetParameterSet());
+		csx.AddProperty(mat);
+		CSPrimBox* box = new CSPrimBox(csx.GetParameterSet(), mat);
+		for (int d=0;d<3;++d)
+		{
+			box->SetCoord(2*d, 0.0);
+			box->SetCoord(2*d+1, 1.0);
+		}
+		csx.Update();
+		double inside[3] = {0.5, 0.5, 0.5};
+		double outside[3] = {2.5, 0.5, 0.5};
+		CHECK(csx.GetPropertyByCoordPriority(inside)==mat, "box not found");
+		CHECK(csx.GetPropertyByCoordPriority(outside)==NULL, "box found outside");
+
+		box->SetCoord(1, 3.0);
+		csx.Update();
+		CHECK(csx.GetPropertyByCoordPriority(outside)==mat, "modified box not found after Update()");
+
+		CSPropMetal* metal = new CSPropMetal(csx.GetParameterSet());
+		csx.AddProperty(metal);
+		CSPrimBox* box2 = new CSPrimBox(csx.GetParameterSet(), metal);
+		for (int d=0;d<3;++d)
+		{
+			box2->SetCoord(2*d, 0.0);
+			box2->SetCoord(2*d+1, 1.0);
+		}
+		box2->SetPriority(10);
+		csx.Update();
+		CHECK(csx.GetPropertyByCoordPriority(inside)==metal, "higher priority box not found");
+
+		csx.DeletePrimitive(box2);
+		CHECK(csx.GetPropertyByCoordPriority(inside)==mat, "deleted box still found");
+	}
+
+	// ---- 8. cached object area
+	{
+		ContinuousStructure csx;
+		build(csx, 6, 12, false);
+		compare_area(csx, "area");
+		compare_area(csx, "metal area", CSProperties::METAL);
+		compare_area(csx, "material area", CSProperties::MATERIAL);
+		compare_area(csx, "no area", CSProperties::EXCITATION);
+
+		ParameterSet* ps = csx.GetParameterSet();
+		CSProperties* metal = csx.GetPropertyByType(CSProperties::METAL).at(0);
+		CSPrimBox* box = new CSPrimBox(ps, metal);
+		for (int d=0;d<3;++d)
+		{
+			box->SetCoord(2*d, 20.0);
+			box->SetCoord(2*d+1, 21.0);
+		}
+		compare_area(csx, "added box");
+		compare_area(csx, "added box, metal", CSProperties::METAL);
+
+		box->SetCoord(1, 35.0);
+		compare_area(csx, "modified box");
+		csx.Update();
+		compare_area(csx, "modified box after Update()");
+
+		// moved to another property, then removed
+		CSProperties* mat = csx.GetPropertyByType(CSProperties::MATERIAL).at(0);
+		box->SetProperty(mat);
+		compare_area(csx, "moved box, metal", CSProperties::METAL);
+		compare_area(csx, "moved box, material", CSProperties::MATERIAL);
+		csx.DeletePrimitive(box);
+		compare_area(csx, "deleted box");
+		compare_area(csx, "deleted box, material", CSProperties::MATERIAL);
+
+		// an updated primitive only extends the area of its new property
+		CSPrimitives* prim = metal->GetPrimitive(0);
+		prim->SetProperty(mat);
+		compare_area(csx, "moved primitive, metal", CSProperties::METAL);
+		compare_area(csx, "moved primitive, material", CSProperties::MATERIAL);
+
+		csx.RemoveProperty(mat);
+		compare_area(csx, "removed property");
+		csx.AddProperty(mat);
+		compare_area(csx, "added property");
+		csx.DeleteProperty(metal);
+		compare_area(csx, "deleted property");
+	}
+
+	// ---- 9. incremental update
+	{
+		ContinuousStructure csx;
+		ParameterSet* ps = csx.GetParameterSet();
+		ps->LinkParameter(new Parameter("a", 1.0));
+		ps->LinkParameter(new Parameter("b", 2.0));
+		CSPropMetal* metal = new CSPropMetal(ps);
+		csx.AddProperty(metal);
+
+		// depending on a, on b, on both and on none
+		const char* stop[4] = {"a", "2*b", "a+b", "3"};
+		CountingBox* boxes[4];
+		for (int n=0;n<4;++n)
+		{
+			boxes[n] = new CountingBox(ps, metal);
+			for (int d=0;d<3;++d)
+			{
+				boxes[n]->SetCoord(2*d, 0.0);
+				boxes[n]->SetCoord(2*d+1, stop[n]);
+			}
+		}
+		CSPrimSphere* sphere = new CSPrimSphere(ps, metal);
+		sphere->SetRadius("b");
+		double box[6];
+
+		const int all[4] = {1,1,1,1};
+		const int none[4] = {0,0,0,0};
+		CHECK(csx.Update().empty(), "initial update failed");
+		check_updates(boxes, all, "initial update");
+		CHECK(csx.Update().empty(), "repeated update failed");
+		check_updates(boxes, none, "repeated update");
+
+		ps->GetParameter(0)->SetValue(4.0);
+		csx.Update();
+		const int a_changed[4] = {1,0,1,0};
+		check_updates(boxes, a_changed, "a changed");
+		boxes[0]->GetBoundBox(box);
+		CHECK(box[1]==4.0, "box depending on a not updated");
+		boxes[2]->GetBoundBox(box);
+		CHECK(box[1]==6.0, "box depending on a and b not updated");
+
+		ps->GetParameter(1)->SetValue(5.0);
+		csx.Update();
+		const int b_changed[4] = {0,1,1,0};
+		check_updates(boxes, b_changed, "b changed");
+		sphere->GetBoundBox(box);
+		CHECK(box[1]==5.0, "sphere depending on b not updated");
+		CHECK(csx.GetObjectArea()[1]==10.0, "object area not updated");
+
+		// modified primitives are updated, whatever they depend on
+		boxes[3]->SetCoord(1, 7.0);
+		boxes[0]->SetCoord(1, "b");
+		csx.Update();
+		const int modified[4] = {1,0,0,1};
+		check_updates(boxes, modified, "modified boxes");
+		boxes[1]->GetTransform()->Translate("1,0,0");
+		boxes[2]->GetCoordPS(0)->SetValue(-1.0);
+		csx.Update();
+		const int transformed[4] = {0,1,1,0};
+		check_updates(boxes, transformed, "transformed box and box modified through its ParameterScalar");
+		boxes[2]->GetBoundBox(box);
+		CHECK(box[0]==-1.0, "box modified through its ParameterScalar not updated");
+		// reading through the ParameterScalar does not modify a primitive
+		CHECK((boxes[3]->GetCoordPS(1)->GetValue()==7.0) && (boxes[3]->GetStartCoord()->GetValue(0)==0.0), "box read through its ParameterScalar");
+		csx.Update();
+		check_updates(boxes, none, "box read through its ParameterScalar");
+		ps->GetParameter(1)->SetValue(6.0);
+		csx.Update();
+		const int b_changed_again[4] = {1,1,1,0};
+		check_updates(boxes, b_changed_again, "b changed, new dependency");
+		boxes[0]->GetBoundBox(box);
+		CHECK(box[1]==6.0, "new dependency not updated");
+
+		// new parameter, renamed parameter and a full update
+		ps->LinkParameter(new Parameter("c", 3.0));
+		csx.Update();
+		check_updates(boxes, all, "added parameter");
+		ps->GetParameter(1)->SetName("d");
+		const char* renamed[3] = {"d", "2*d", "a+d"};
+		for (int n=0;n<3;++n)
+			for (int d=0;d<3;++d)
+				boxes[n]->SetCoord(2*d+1, renamed[n]);
+		sphere->SetRadius("d");
+		CHECK(csx.Update().empty(), "update with renamed parameter failed");
+		check_updates(boxes, all, "renamed parameter");
+		csx.Update(true);
+		check_updates(boxes, all, "full update");
+
+		// a failed update is reported until fixed
+		boxes[1]->SetCoord(1, "2*f");
+		CHECK(csx.Update().empty()==false, "error not reported");
+		CHECK(csx.Update().empty()==false, "error not reported again");
+		boxes[1]->SetCoord(1, "2*c");
+		CHECK(csx.Update().empty(), "fixed error still reported");
+		ps->GetParameter(2)->SetValue(1.0);
+		csx.Update();
+		boxes[1]->GetBoundBox(box);
+		CHECK(box[1]==2.0, "box depending on c not updated");
+	}
+
+	std::cout << (fails ? "FAILED" : "all structure query tests passed") << std::endl;
+	return fails != 0;
+}